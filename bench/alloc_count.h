@@ -0,0 +1,71 @@
+/*
+ * Contagem das alocações do processo: substitui o operator new/delete global.
+ * Incluir em UM arquivo só de cada executável (as substituições não podem ser
+ * inline nem aparecer duas vezes). Conta as alocações feitas por new, inclusive
+ * as dos contêineres da STL, de todas as threads; malloc() direto (drivers do
+ * GL, bibliotecas em C) não passa por aqui.
+ */
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+
+static std::atomic<uint64_t> alocacoes(0);
+static std::atomic<uint64_t> bytes_alocados(0);
+
+// Total desde o início do processo; a diferença entre duas leituras dá as
+// alocações de um trecho
+inline uint64_t allocationCount() {
+    return alocacoes.load(std::memory_order_relaxed);
+}
+
+inline uint64_t allocatedBytes() {
+    return bytes_alocados.load(std::memory_order_relaxed);
+}
+
+static void* countedAlloc(std::size_t n) {
+    alocacoes.fetch_add(1, std::memory_order_relaxed);
+    bytes_alocados.fetch_add(n, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+
+void* operator new(std::size_t n) {
+    void* p = countedAlloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t n) {
+    void* p = countedAlloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+    return countedAlloc(n);
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+    return countedAlloc(n);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+#endif
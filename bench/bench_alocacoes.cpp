@@ -0,0 +1,96 @@
+/*
+ * Alocações por tick em regime: conta cada new do processo (alloc_count.h)
+ * enquanto uma partida de semente fixa roda, com o jogador andando e plantando
+ * bombas. Depois do aquecimento (vetores já no tamanho máximo da partida),
+ * nenhum tick pode alocar: se algum alocar, o programa falha e diz o primeiro
+ * tick. Também mede o recomeço da partida (initMap() de novo no mesmo mapa),
+ * que deve reaproveitar a memória da partida anterior.
+ *
+ * Trava os caminhos quentes sem alocação; as alocações por quadro do desenho
+ * ficam no bench_render.
+ */
+#include "alloc_count.h"
+#include "../game.h"
+#include "bench_util.h"
+
+static const int TICKS_AQUECIMENTO = 300;
+static const int TICKS = 3000;
+
+struct Caso {
+    int lado, inimigos;
+};
+
+// Ações do jogador: anda ao acaso e planta uma bomba de vez em quando
+static int nextAction(uint64_t& estado) {
+    estado = estado * 6364136223846793005ULL + 1442695040888963407ULL;
+    int r = (int)(estado >> 33) % 16;
+    return r == 0 ? ACAO_BOMBA : 1 + r % 4;
+}
+
+static void playTick(uint64_t& estado) {
+    if (jogadores[0].vivo) applyAction(0, nextAction(estado));
+    stepGame();
+}
+
+int main() {
+    const Caso casos[] = { { 31, 20 }, { 63, 200 }, { 127, 1000 } };
+    bool falhou = false;
+
+    for (size_t k = 0; k < sizeof(casos) / sizeof(casos[0]); k++) {
+        const Caso& caso = casos[k];
+        setMapSize(caso.lado, caso.lado);
+        num_inimigos = caso.inimigos;
+        jogadores.assign(1, Jogador());
+        tick_atual = 0;
+        if (!initMap(42)) return 1;
+
+        uint64_t estado = 42;
+        for (int t = 0; t < TICKS_AQUECIMENTO; t++) playTick(estado);
+
+        uint64_t antes = allocationCount(), bytes_antes = allocatedBytes();
+        int ticks_com_alocacao = 0, primeiro = -1;
+        double inicio = nowNs();
+        for (int t = 0; t < TICKS; t++) {
+            uint64_t a = allocationCount();
+            playTick(estado);
+            if (allocationCount() != a) {
+                if (primeiro < 0) primeiro = tick_atual;
+                ticks_com_alocacao++;
+            }
+        }
+        double total = nowNs() - inicio;
+        uint64_t alocacoes_tick = allocationCount() - antes, bytes_tick = allocatedBytes() - bytes_antes;
+
+        // Recomeço no mesmo mapa, como a tecla de reiniciar
+        jogadores.assign(1, Jogador());
+        tick_atual = 0;
+        antes = allocationCount();
+        double inicio_reinicio = nowNs();
+        initMap(43);
+        double reinicio = nowNs() - inicio_reinicio;
+        uint64_t alocacoes_reinicio = allocationCount() - antes;
+
+        char nome[64], extra[192];
+        snprintf(nome, sizeof(nome), "ticks_%dx%d_%d_inimigos", caso.lado, caso.lado, caso.inimigos);
+        snprintf(extra, sizeof(extra),
+                 "\"alocacoes\":%llu,\"bytes\":%llu,\"ticks_com_alocacao\":%d,\"primeiro_tick_com_alocacao\":%d",
+                 (unsigned long long)alocacoes_tick, (unsigned long long)bytes_tick, ticks_com_alocacao, primeiro);
+        reportResultExtra("alocacoes", nome, TICKS, total, extra);
+        snprintf(nome, sizeof(nome), "reinicio_%dx%d_%d_inimigos", caso.lado, caso.lado, caso.inimigos);
+        snprintf(extra, sizeof(extra), "\"alocacoes\":%llu", (unsigned long long)alocacoes_reinicio);
+        reportResultExtra("alocacoes", nome, 1, reinicio, extra);
+
+        if (alocacoes_tick > 0) {
+            fprintf(stderr, "%dx%d com %d inimigos: %llu alocacoes em %d ticks (a primeira no tick %d)\n",
+                    caso.lado, caso.lado, caso.inimigos, (unsigned long long)alocacoes_tick, ticks_com_alocacao,
+                    primeiro);
+            falhou = true;
+        }
+        if (alocacoes_reinicio > 0) {
+            fprintf(stderr, "%dx%d com %d inimigos: o recomeco alocou %llu vezes\n", caso.lado, caso.lado,
+                    caso.inimigos, (unsigned long long)alocacoes_reinicio);
+            falhou = true;
+        }
+    }
+    return falhou ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Benchmark da carga dos recursos do jogo (assets/): o modelo OBJ com o
+ * tinyobjloader e as texturas com o stb_image, como em main.cpp. Cada recurso é
+ * medido lido do arquivo (cache de arquivos do sistema já quente, depois da
+ * primeira leitura) e a partir dos bytes já na memória, o que separa a leitura
+ * do parse/decodificação.
+ *
+ *   bench_assets [--assets DIR]   (padrão: assets, no diretório atual)
+ */
+#define STB_IMAGE_IMPLEMENTATION
+#include "../stb_image.h"
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../tiny_obj_loader.h"
+#include "bench_util.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+static const int REPETICOES_OBJ = 50;
+static const int REPETICOES_TEXTURA = 20;
+
+static bool readFile(const string& caminho, string& bytes) {
+    ifstream f(caminho.c_str(), ios::binary);
+    if (!f) return false;
+    ostringstream s;
+    s << f.rdbuf();
+    bytes = s.str();
+    return true;
+}
+
+static int runModel(const string& dir) {
+    string caminho = dir + "/bomberman.obj", bytes;
+    if (!readFile(caminho, bytes)) {
+        fprintf(stderr, "Nao foi possivel ler %s\n", caminho.c_str());
+        return 1;
+    }
+
+    size_t vertices = 0;
+    double arquivo = 0, memoria = 0;
+    for (int r = 0; r < REPETICOES_OBJ; r++) {
+        tinyobj::attrib_t attrib;
+        vector<tinyobj::shape_t> shapes;
+        vector<tinyobj::material_t> materials;
+        string warn, err;
+        double inicio = nowNs();
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, caminho.c_str(), (dir + "/").c_str())) {
+            fprintf(stderr, "Erro ao carregar %s: %s\n", caminho.c_str(), err.c_str());
+            return 1;
+        }
+        arquivo += nowNs() - inicio;
+        vertices = attrib.vertices.size() / 3;
+
+        attrib = tinyobj::attrib_t();
+        shapes.clear();
+        materials.clear();
+        istringstream entrada(bytes);
+        tinyobj::MaterialFileReader materiais(dir + "/");
+        inicio = nowNs();
+        tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &entrada, &materiais);
+        memoria += nowNs() - inicio;
+    }
+
+    char extra[96];
+    snprintf(extra, sizeof(extra), "\"vertices\":%zu,\"bytes\":%zu", vertices, bytes.size());
+    reportResultExtra("assets", "obj_bomberman_arquivo", REPETICOES_OBJ, arquivo, extra);
+    reportResultExtra("assets", "obj_bomberman_memoria", REPETICOES_OBJ, memoria, extra);
+    return 0;
+}
+
+static int runTexture(const string& dir, const char* nome) {
+    string caminho = dir + "/" + nome + ".jpg", bytes;
+    if (!readFile(caminho, bytes)) {
+        fprintf(stderr, "Nao foi possivel ler %s\n", caminho.c_str());
+        return 1;
+    }
+
+    int largura = 0, altura = 0, canais = 0;
+    double arquivo = 0, memoria = 0;
+    for (int r = 0; r < REPETICOES_TEXTURA; r++) {
+        double inicio = nowNs();
+        unsigned char* dados = stbi_load(caminho.c_str(), &largura, &altura, &canais, 0);
+        arquivo += nowNs() - inicio;
+        if (!dados) {
+            fprintf(stderr, "Erro ao decodificar %s\n", caminho.c_str());
+            return 1;
+        }
+        stbi_image_free(dados);
+
+        inicio = nowNs();
+        dados = stbi_load_from_memory((const stbi_uc*)bytes.data(), (int)bytes.size(), &largura, &altura, &canais, 0);
+        memoria += nowNs() - inicio;
+        stbi_image_free(dados);
+    }
+
+    char caso[64], extra[96];
+    snprintf(extra, sizeof(extra), "\"largura\":%d,\"altura\":%d,\"bytes\":%zu", largura, altura, bytes.size());
+    snprintf(caso, sizeof(caso), "textura_%s_arquivo", nome);
+    reportResultExtra("assets", caso, REPETICOES_TEXTURA, arquivo, extra);
+    snprintf(caso, sizeof(caso), "textura_%s_memoria", nome);
+    reportResultExtra("assets", caso, REPETICOES_TEXTURA, memoria, extra);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    string dir = "assets";
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--assets") == 0 && i + 1 < argc) dir = argv[++i];
+
+    const char* texturas[] = { "grass", "tiles", "brick" };
+    if (runModel(dir)) return 1;
+    for (size_t t = 0; t < sizeof(texturas) / sizeof(texturas[0]); t++)
+        if (runTexture(dir, texturas[t])) return 1;
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Benchmark da API C (bomberman.h), em C e ligado à biblioteca compartilhada:
+ * mil partidas criadas, simuladas com ações ao acaso e recomeçadas quando
+ * acabam, como faria uma ferramenta de treino. Confere também que uma foto
+ * põe outra partida no mesmo estado e que a mesma semente dá a mesma partida.
+ */
+#include "../bomberman.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PARTIDAS 1000
+#define TICKS 200
+
+static double nowNs(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t nextRandom(uint64_t* estado) {
+    uint64_t h = (*estado += 0x9E3779B97F4A7C15ULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+int main(void) {
+    if (bomberman_abi_version() != BOMBERMAN_ABI_VERSAO) {
+        fprintf(stderr, "Biblioteca com ABI %d, cabeçalho com %d\n", bomberman_abi_version(), BOMBERMAN_ABI_VERSAO);
+        return 1;
+    }
+
+    BombermanConfig cfg;
+    cfg.largura = cfg.altura = 15;
+    cfg.inimigos = 5;
+    cfg.jogadores = 1;
+
+    BombermanJogo* jogos[PARTIDAS];
+    double inicio = nowNs();
+    for (int i = 0; i < PARTIDAS; i++) {
+        cfg.semente = 1000 + i;
+        jogos[i] = bomberman_create(&cfg);
+        if (!jogos[i]) {
+            fprintf(stderr, "bomberman_create falhou\n");
+            return 1;
+        }
+    }
+    double criacao = nowNs() - inicio;
+
+    /* Mesma semente, mesma partida */
+    cfg.semente = 1000;
+    BombermanJogo* gemea = bomberman_create(&cfg);
+    if (bomberman_checksum(gemea) != bomberman_checksum(jogos[0])) {
+        fprintf(stderr, "Mesma semente deu partidas diferentes\n");
+        return 1;
+    }
+    bomberman_destroy(gemea);
+
+    /* A foto do jogo 0 clonada numa partida de outra semente (outras paredes):
+       depois do restore as duas têm as mesmas células e seguem iguais */
+    cfg.semente = 999;
+    BombermanJogo* copia = bomberman_create(&cfg);
+    BombermanFoto* foto = bomberman_snapshot(jogos[0], NULL);
+    uint64_t gerador = 7;
+    long passos = 0, recomecos = 0;
+    inicio = nowNs();
+    for (int t = 0; t < TICKS; t++) {
+        for (int i = 0; i < PARTIDAS; i++) {
+            uint8_t acao = (uint8_t)(nextRandom(&gerador) % 6);
+            if (bomberman_step(jogos[i], &acao) != BOMBERMAN_JOGANDO) {
+                bomberman_reset(jogos[i], nextRandom(&gerador));
+                recomecos++;
+            }
+            passos++;
+        }
+    }
+    double simulacao = nowNs() - inicio;
+
+    bomberman_restore(jogos[0], foto);
+    bomberman_restore(copia, foto);
+    size_t n_celulas = (size_t)cfg.largura * cfg.altura;
+    uint8_t* celulas_original = (uint8_t*)malloc(n_celulas);
+    uint8_t* celulas_copia = (uint8_t*)malloc(n_celulas);
+    if (bomberman_cells(jogos[0], celulas_original, n_celulas) != n_celulas ||
+        bomberman_cells(copia, celulas_copia, n_celulas) != n_celulas ||
+        memcmp(celulas_original, celulas_copia, n_celulas) != 0 ||
+        bomberman_checksum(copia) != bomberman_checksum(jogos[0])) {
+        fprintf(stderr, "Foto restaurada em outra partida não deu o mesmo estado\n");
+        return 1;
+    }
+    free(celulas_original);
+    free(celulas_copia);
+    uint8_t acao = BOMBERMAN_DIREITA;
+    bomberman_step(jogos[0], &acao);
+    bomberman_step(copia, &acao);
+    if (bomberman_checksum(copia) != bomberman_checksum(jogos[0])) {
+        fprintf(stderr, "Partida restaurada da foto divergiu\n");
+        return 1;
+    }
+
+    /* Consultas e planos */
+    int largura, altura;
+    bomberman_size(jogos[1], &largura, &altura);
+    size_t tam = bomberman_planes(jogos[1], 0, NULL, 0);
+    uint8_t* planos = (uint8_t*)malloc(tam);
+    uint8_t* celulas = (uint8_t*)malloc((size_t)largura * altura);
+    if (bomberman_planes(jogos[1], 0, planos, tam) != tam ||
+        bomberman_cells(jogos[1], celulas, (size_t)largura * altura) != (size_t)largura * altura ||
+        celulas[0] != BOMBERMAN_PAREDE || planos[0] != 1) {
+        fprintf(stderr, "Consultas inconsistentes\n");
+        return 1;
+    }
+    free(planos);
+    free(celulas);
+
+    bomberman_snapshot_destroy(foto);
+    bomberman_destroy(copia);
+    for (int i = 0; i < PARTIDAS; i++) bomberman_destroy(jogos[i]);
+
+    printf("{\"bench\":\"capi\",\"caso\":\"criar_%d_partidas_15x15\",\"iteracoes\":%d,\"ns_por_iteracao\":%.1f}\n",
+           PARTIDAS, PARTIDAS, criacao / PARTIDAS);
+    printf("{\"bench\":\"capi\",\"caso\":\"passos_%d_partidas_15x15\",\"iteracoes\":%ld,\"ns_por_iteracao\":%.1f,"
+           "\"passos_por_s\":%.0f,\"recomecos\":%ld}\n",
+           PARTIDAS, passos, simulacao / passos, passos / (simulacao / 1e9), recomecos);
+    return 0;
+}
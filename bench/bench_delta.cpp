@@ -0,0 +1,132 @@
+/*
+ * Benchmark dos estados por delta: bytes por tick e tempo de codificação do
+ * mapa 13x13 até arenas de 4096x4096. Um cliente simulado decodifica cada
+ * estado (perdendo 10% deles) contra a base que confirmou dois ticks antes, e
+ * o estado reconstruído é conferido com o do servidor.
+ */
+#include "../delta.h"
+#include "bench_util.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+static const int TICKS = 200;    // 60 nas arenas de 1024 para cima (cada tick custa O(área))
+static const int ATRASO_ACK = 2; // ticks até a confirmação do cliente chegar ao servidor
+
+static void resetMatch(int lado, int quantidade, int n_jogadores) {
+    srand(42);
+    semente_partida = 42;
+    tick_atual = 0;
+    player_won = false;
+    setMapSize(lado, lado);
+    num_inimigos = quantidade;
+    jogadores.assign(n_jogadores, Jogador());
+    initMap();
+}
+
+// O quadro decodificado bate com o estado da partida?
+static bool sameState(const QuadroDelta& q, const Mapa& mapa) {
+    if (mapa.celulas != gameMap.celulas || q.tick != tick_atual || q.jogadores.size() != jogadores.size() ||
+        q.bombas.size() != bombas.size())
+        return false;
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        const Jogador &a = q.jogadores[j], &b = jogadores[j];
+        if (a.x != b.x || a.z != b.z || a.ativo != b.ativo || a.vivo != b.vivo) return false;
+    }
+    for (size_t i = 0; i < bombas.size(); i++) {
+        const Bomba &a = q.bombas[i], &b = bombas[i];
+        if (a.x != b.x || a.z != b.z || a.timer != b.timer || a.frame_explosao != b.frame_explosao ||
+            a.explodiu != b.explodiu || a.dono != b.dono)
+            return false;
+    }
+    size_t vivos = 0;
+    for (size_t id = 0; id < q.inimigos.size(); id++) vivos += q.inimigos[id] >= 0;
+    if (vivos != inimigos.size()) return false;
+    for (size_t i = 0; i < inimigos.size(); i++) {
+        uint32_t id = inimigos.id[i];
+        if (id >= q.inimigos.size() || q.inimigos[id] != (inimigos.x[i] | (inimigos.z[i] << 16))) return false;
+    }
+    return true;
+}
+
+static int runSize(int lado, int quantidade, int n_jogadores) {
+    resetMatch(lado, quantidade, n_jogadores);
+
+    static HistoricoDelta historico;
+    static HistoricoCliente cliente;
+    historico = HistoricoDelta();
+    cliente = HistoricoCliente();
+    Mapa mapa_cliente;
+    mapa_cliente.resize(lado, lado);
+
+    vector<uint8_t> bytes;
+    vector<uint32_t> confirmado(TICKS + 1, 0); // último estado decodificado pelo cliente em cada tick
+    uint64_t gerador = 42;
+    double ns_codificar = 0, ns_decodificar = 0, bytes_delta = 0;
+    size_t maior_delta = 0, bytes_completo = 0;
+    long deltas = 0, decodificados = 0;
+    uint32_t ultimo_decodificado = 0;
+
+    const uint32_t ticks = lado >= 1024 ? 60 : TICKS;
+    for (uint32_t seq = 1; seq <= ticks; seq++) {
+        // Jogadores andam (e de vez em quando plantam bombas) a cada tick
+        for (size_t j = 0; j < jogadores.size(); j++)
+            applyAction((int)j, splitmix64(gerador) % 16 == 0 ? (int)ACAO_BOMBA : 1 + (int)(splitmix64(gerador) % 4));
+        stepGame();
+        historico.record(seq);
+
+        uint32_t base = seq > (uint32_t)ATRASO_ACK ? confirmado[seq - ATRASO_ACK] : 0;
+        double inicio = nowNs();
+        uint32_t usada = historico.encode(base, bytes);
+        double fim = nowNs();
+        if (usada != 0) {
+            ns_codificar += fim - inicio;
+            bytes_delta += (double)bytes.size();
+            if (bytes.size() > maior_delta) maior_delta = bytes.size();
+            deltas++;
+        } else if (bytes_completo == 0) {
+            bytes_completo = bytes.size();
+        }
+
+        // O cliente perde 10% dos estados (nunca o primeiro, que é completo)
+        confirmado[seq] = ultimo_decodificado;
+        if (seq > 1 && splitmix64(gerador) % 10 == 0) continue;
+        const QuadroDelta* q = 0;
+        inicio = nowNs();
+        bool ok = decodeDelta(&bytes[0], bytes.size(), cliente, mapa_cliente, q);
+        ns_decodificar += nowNs() - inicio;
+        if (!ok || !sameState(*q, mapa_cliente)) {
+            fprintf(stderr, "Estado %u decodificado errado (%dx%d, base %u)\n", seq, lado, lado, usada);
+            return 1;
+        }
+        ultimo_decodificado = seq;
+        confirmado[seq] = seq;
+        decodificados++;
+    }
+
+    // Estado completo do fim da partida (o que um cliente novo receberia)
+    double inicio = nowNs();
+    historico.encode(0, bytes);
+    double ns_completo = nowNs() - inicio;
+    if (bytes.size() > bytes_completo) bytes_completo = bytes.size();
+
+    char caso[64], extra[320];
+    snprintf(caso, sizeof(caso), "%dx%d_%d_inimigos_%d_jogadores", lado, lado, quantidade, n_jogadores);
+    snprintf(extra, sizeof(extra),
+             "\"bytes_por_tick\":%.1f,\"maior_delta\":%zu,\"bytes_completo\":%zu,\"ns_completo\":%.0f,"
+             "\"ns_decodificar\":%.1f,\"inimigos_vivos_no_fim\":%zu",
+             deltas ? bytes_delta / deltas : 0.0, maior_delta, bytes_completo, ns_completo,
+             decodificados ? ns_decodificar / decodificados : 0.0, inimigos.size());
+    reportResultExtra("delta", caso, deltas, ns_codificar, extra);
+    return 0;
+}
+
+int main() {
+    const int lados[] = { 13, 64, 256, 1024, 4096 };
+    const int quantidades[] = { 3, 40, 600, 10000, 50000 };
+    const int n_jogadores[] = { 4, 16, 64, 256, 256 };
+    for (size_t i = 0; i < sizeof(lados) / sizeof(lados[0]); i++)
+        if (runSize(lados[i], quantidades[i], n_jogadores[i]) != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Benchmark das explosões em cadeia: uma fila de L bombas encostadas, armada
+ * depois de uma bomba que explode antes e alcança a primeira. Mede a propagação
+ * da detonação antecipada pela fila inteira (o plantBomb() que fecha a cadeia)
+ * e o tick em que as L + 1 bombas explodem juntas, x comprimento da cadeia.
+ */
+#include "../game.h"
+#include "../stats.h"
+#include "bench_util.h"
+#include <algorithm>
+
+int main() {
+    const int comprimentos[] = { 1, 8, 64, 512, 4000 };
+    densidade_blocos = 0;
+    densidade_paredes = 0;
+    num_inimigos = 0;
+    jogadores.assign(1, Jogador());
+
+    for (size_t k = 0; k < sizeof(comprimentos) / sizeof(comprimentos[0]); k++) {
+        const int L = comprimentos[k];
+        const int repeticoes = std::max(20, 100000 / L);
+        // A cadeia fica na linha z = 1 (sem pilares), de x = 6 a x = 5 + L
+        setMapSize(L + 10, MAP_SIZE_MIN);
+
+        double propagacao = 0, explosao = 0;
+        for (int r = 0; r < repeticoes; r++) {
+            tick_atual = 0;
+            initMap(42);
+            plantBomb(5, 1, DONO_INIMIGO); // o gatilho explode 2 ticks antes da fila
+            stepGame();
+            stepGame();
+            for (int x = 5 + L; x > 6; x--) plantBomb(x, 1, DONO_INIMIGO);
+
+            double inicio = nowNs();
+            plantBomb(6, 1, DONO_INIMIGO); // alcançada pelo gatilho: antecipa a fila toda
+            propagacao += nowNs() - inicio;
+
+            int limite = tick_atual + 10;
+            ContadoresTick antes = contadores_tick;
+            while (bombas.empty() || !bombas[0].explodiu) {
+                inicio = nowNs();
+                stepGame();
+                double t = nowNs() - inicio;
+                if (!bombas.empty() && bombas[0].explodiu) explosao += t;
+                if (tick_atual > limite) break;
+            }
+            uint32_t encadeadas = contadores_tick.bombas_encadeadas - antes.bombas_encadeadas;
+            if ((int)bombas.size() != L + 1 || !bombas.back().explodiu || encadeadas != (uint32_t)L) {
+                fprintf(stderr, "Cadeia de %d bombas: %zu bombas, %u encadeadas\n", L, bombas.size(), encadeadas);
+                return 1;
+            }
+        }
+
+        char caso[64];
+        snprintf(caso, sizeof(caso), "propagar_cadeia_%d", L);
+        reportResult("explosoes", caso, repeticoes, propagacao);
+        snprintf(caso, sizeof(caso), "explodir_cadeia_%d", L);
+        reportResult("explosoes", caso, repeticoes, explosao);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Benchmark do host de partidas: N partidas de bots num processo, a 20 ticks/s,
+ * com 1 thread e com uma por núcleo. Mede o custo médio de um tick de partida,
+ * quantas partidas cabem num núcleo nesse ritmo, os ticks que perderam o prazo
+ * e o pior atraso (e o p99 dos piores atrasos de cada partida).
+ *
+ *   bench_host [--segundos S] [--mapa LADO] [--hz HZ]
+ */
+#include "../host.h"
+#include "../game.h"
+#include "../net.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+using namespace std;
+
+static double segundos = 3;
+static int lado = 31, hz = 20;
+
+static int runCase(int partidas, int threads) {
+    ConfigHost cfg;
+    cfg.partidas = partidas;
+    cfg.threads = threads;
+    cfg.hz = hz;
+    cfg.jogadores = 4;
+
+    atomic<bool> parar(false);
+    thread relogio([&parar] {
+        sleepSeconds(segundos);
+        parar = true;
+    });
+    RelatorioHost r;
+    bool ok = runHost(cfg, parar, r);
+    relogio.join();
+    if (!ok || r.ticks() == 0) {
+        fprintf(stderr, "Host nao rodou (%d partidas, %d threads)\n", partidas, threads);
+        return 1;
+    }
+
+    vector<double> atrasos;
+    double tick_max = 0;
+    for (size_t i = 0; i < r.partidas.size(); i++) {
+        atrasos.push_back(r.partidas[i].atraso_max);
+        tick_max = max(tick_max, r.partidas[i].tempo_tick_max);
+    }
+    sort(atrasos.begin(), atrasos.end());
+    double p99 = atrasos[min(atrasos.size() - 1, atrasos.size() * 99 / 100)];
+
+    char caso[96], extra[512];
+    snprintf(caso, sizeof(caso), "%dx%d_%d_partidas_%d_threads", lado, lado, partidas, r.threads);
+    snprintf(extra, sizeof(extra),
+             "\"hz\":%d,\"rodadas\":%llu,\"partidas_por_nucleo\":%.0f,\"atrasados\":%llu,\"fracao_atrasados\":%.4f,"
+             "\"atraso_max_ms\":%.3f,\"atraso_p99_ms\":%.3f,\"ns_tick_max\":%.0f,\"rodada_max_ms\":%.3f,"
+             "\"roubos\":%llu,\"ocupacao\":%.2f",
+             hz, (unsigned long long)r.rodadas, r.matchesPerCore(hz), (unsigned long long)r.atrasados(),
+             (double)r.atrasados() / (double)r.ticks(), atrasos.back() * 1e3, p99 * 1e3, tick_max * 1e9,
+             r.rodada_max * 1e3, (unsigned long long)r.roubos, r.trabalho / (r.duracao * r.threads));
+    reportResultExtra("host", caso, (long)r.ticks(), r.trabalho * 1e9, extra);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--segundos") == 0 && i + 1 < argc) segundos = max(0.5, atof(argv[++i]));
+        else if (strcmp(argv[i], "--mapa") == 0 && i + 1 < argc) lado = max(7, atoi(argv[++i]) | 1);
+        else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc) hz = max(1, min(1000, atoi(argv[++i])));
+    }
+    srand(42);
+    num_inimigos = 10;
+    setMapSize(lado, lado);
+
+    int nucleos = max(1, (int)thread::hardware_concurrency());
+    const int partidas[] = { 16, 64, 256, 1024 };
+    for (size_t k = 0; k < sizeof(partidas) / sizeof(partidas[0]); k++) {
+        if (runCase(partidas[k], 1) != 0) return 1;
+        if (nucleos > 1 && runCase(partidas[k], nucleos) != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Benchmark da simulação com muitos inimigos: ticks por segundo x quantidade de inimigos
+ * e x número de threads (campos de distância e decisão), com a aceleração sobre 1 thread
+ */
+#include "../game.h"
+#include "../parallel.h"
+#include "bench_util.h"
+#include <cstdlib>
+
+static const int LADO = 512;
+static const int TICKS = 200;
+
+static void resetMatch(int quantidade) {
+    srand(42);
+    semente_partida = 42;
+    setMapSize(LADO, LADO);
+    num_inimigos = quantidade;
+    jogadores.assign(1, Jogador());
+    player_won = false;
+    tick_atual = 0;
+    initMap();
+}
+
+int main() {
+    const int quantidades[] = { 10, 100, 1000, 10000, 50000 };
+
+    for (size_t q = 0; q < sizeof(quantidades) / sizeof(quantidades[0]); q++) {
+        resetMatch(quantidades[q]);
+
+        double inicio = nowNs();
+        for (int t = 0; t < TICKS; t++)
+            stepGame();
+        double total = nowNs() - inicio;
+
+        char caso[64], extra[128];
+        snprintf(caso, sizeof(caso), "%d_inimigos_%dx%d", quantidades[q], LADO, LADO);
+        snprintf(extra, sizeof(extra), "\"ticks_por_s\":%.1f,\"inimigos_vivos_no_fim\":%zu",
+                 TICKS / (total / 1e9), inimigos.size());
+        reportResultExtra("inimigos", caso, TICKS, total, extra);
+    }
+
+    // Posicionamento: custo de spawnEnemies() num mapa já gerado, sem células repetidas
+    for (size_t q = 0; q < sizeof(quantidades) / sizeof(quantidades[0]); q++) {
+        resetMatch(0);
+        double inicio = nowNs();
+        int criados = spawnEnemies(quantidades[q]);
+        double total = nowNs() - inicio;
+
+        size_t ocupadas = 0;
+        for (size_t c = 0; c < ocupacao.size(); c++)
+            if (ocupacao[c] >= 0) ocupadas++;
+        if (criados != quantidades[q] || ocupadas != inimigos.size()) {
+            fprintf(stderr, "spawnEnemies(%d) criou %d inimigos em %zu células\n", quantidades[q], criados, ocupadas);
+            return 1;
+        }
+
+        char caso[64];
+        snprintf(caso, sizeof(caso), "spawn_%d_inimigos_%dx%d", quantidades[q], LADO, LADO);
+        reportResult("inimigos", caso, 1, total);
+    }
+
+    // Mais inimigos do que cabem: para na capacidade em vez de travar
+    srand(42);
+    setMapSize(MAP_SIZE, MAP_SIZE);
+    num_inimigos = 1000;
+    if (initMap() || inimigos.size() == 0 || inimigos.size() >= 1000) {
+        fprintf(stderr, "initMap() deveria avisar que 1000 inimigos não cabem em %dx%d\n", MAP_SIZE, MAP_SIZE);
+        return 1;
+    }
+
+    // Mesma partida com 1, 2, 4 e 8 threads: o estado final tem que ser idêntico
+    const int threads[] = { 1, 2, 4, 8 };
+    uint64_t referencia = 0;
+    double tempo_1_thread = 0;
+    for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); k++) {
+        setWorkerCount(threads[k]);
+        resetMatch(50000);
+
+        double inicio = nowNs();
+        for (int t = 0; t < TICKS; t++)
+            stepGame();
+        double total = nowNs() - inicio;
+
+        uint64_t soma = stateChecksum();
+        if (k == 0) {
+            referencia = soma;
+            tempo_1_thread = total;
+        }
+
+        char caso[64], extra[160];
+        snprintf(caso, sizeof(caso), "50000_inimigos_%d_threads", threads[k]);
+        snprintf(extra, sizeof(extra), "\"ticks_por_s\":%.1f,\"aceleracao\":%.2f,\"checksum\":\"%016llx\"",
+                 TICKS / (total / 1e9), tempo_1_thread / total, (unsigned long long)soma);
+        reportResultExtra("inimigos", caso, TICKS, total, extra);
+
+        if (soma != referencia) {
+            fprintf(stderr, "Estado com %d threads difere do estado com 1 thread\n", threads[k]);
+            return 1;
+        }
+    }
+    setWorkerCount(1);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Benchmark do lote de ambientes (env.h): passos de ambiente por segundo x
+ * tamanho do lote e x threads, com ações aleatórias, com a janela e com os
+ * planos do tabuleiro como observação. O resultado (recompensas, fins de
+ * episódio e observações) tem que ser o mesmo com qualquer número de threads.
+ * Mede também o custo de writePlanes() sozinho por tamanho de mapa.
+ */
+#include "../env.h"
+#include "../parallel.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+static const int PASSOS = 200;
+
+static uint64_t hashBytes(uint64_t h, const void* dados, size_t n) {
+    const uint8_t* p = (const uint8_t*)dados;
+    for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+static uint64_t runCase(int n, int threads, int observacao) {
+    setWorkerCount(threads);
+    ConfigLote cfg;
+    cfg.ambientes = n;
+    cfg.largura = cfg.altura = 15;
+    cfg.max_passos = 150;
+    cfg.observacao = observacao;
+    cfg.semente = 42;
+
+    LoteAmbientes lote;
+    vector<uint8_t> acoes(n), terminou(n);
+    vector<float> recompensas(n);
+    size_t por_ambiente = observacao == OBSERVACAO_PLANOS ? (size_t)NUM_PLANOS * cfg.largura * cfg.altura : TAM_OBSERVACAO;
+    vector<uint8_t> observacoes((size_t)n * por_ambiente);
+    lote.start(cfg, &observacoes[0]);
+
+    uint64_t gerador = 7, h = 0xCBF29CE484222325ULL;
+    double inicio = nowNs();
+    for (int p = 0; p < PASSOS; p++) {
+        for (int i = 0; i < n; i++) acoes[i] = (uint8_t)(splitmix64(gerador) % NUM_ACOES);
+        lote.step(&acoes[0], &recompensas[0], &terminou[0], &observacoes[0]);
+        h = hashBytes(h, &recompensas[0], recompensas.size() * sizeof(float));
+        h = hashBytes(h, &terminou[0], terminou.size());
+    }
+    double total = nowNs() - inicio;
+    h = hashBytes(h, &observacoes[0], observacoes.size());
+
+    EstatisticasLote est = lote.stats();
+    char caso[64], extra[256];
+    snprintf(caso, sizeof(caso), "%d_ambientes_%d_threads_%s", n, threads,
+             observacao == OBSERVACAO_PLANOS ? "planos" : "janela");
+    snprintf(extra, sizeof(extra),
+             "\"passos_por_s\":%.0f,\"episodios\":%llu,\"vitorias\":%llu,\"mortes\":%llu,\"checksum\":\"%016llx\"",
+             (double)est.passos / (total / 1e9), (unsigned long long)est.episodios,
+             (unsigned long long)est.vitorias, (unsigned long long)est.mortes, (unsigned long long)h);
+    reportResultExtra("lote", caso, (long)est.passos, total, extra);
+    return h;
+}
+
+// writePlanes() sozinho, numa partida em andamento (com bombas e explosões)
+static int runPlanes(int lado, int n_inimigos) {
+    setWorkerCount(1);
+    setMapSize(lado, lado);
+    num_inimigos = n_inimigos;
+    jogadores.assign(1, Jogador());
+    initMap(42);
+    for (int t = 0; t < 40; t++) stepGame();
+
+    vector<uint8_t> planos(planesSize());
+    const int repeticoes = max(20, 2000000 / (lado * lado));
+    double inicio = nowNs();
+    for (int r = 0; r < repeticoes; r++) writePlanes(0, &planos[0]);
+    double total = nowNs() - inicio;
+
+    // Conferência com as funções das regras
+    size_t area = (size_t)lado * lado;
+    for (int z = 0; z < lado; z++) {
+        for (int x = 0; x < lado; x++) {
+            size_t o = (size_t)z * lado + x;
+            int t = ticksToExplosion(x, z);
+            if (planos[PLANO_PAREDE * area + o] != (gameMap.at(x, z) == CELULA_PAREDE) ||
+                planos[PLANO_BLOCO * area + o] != (gameMap.at(x, z) == CELULA_BLOCO) ||
+                planos[PLANO_INIMIGO * area + o] != (enemyAt(x, z) >= 0) ||
+                (planos[PLANO_PERIGO * area + o] != 0) != (t >= 0)) {
+                fprintf(stderr, "Planos errados em (%d, %d) no mapa %dx%d\n", x, z, lado, lado);
+                return 1;
+            }
+        }
+    }
+
+    char caso[64], extra[128];
+    snprintf(caso, sizeof(caso), "planos_%dx%d", lado, lado);
+    snprintf(extra, sizeof(extra), "\"bytes\":%zu,\"ns_por_celula\":%.2f", planos.size(),
+             total / repeticoes / (double)area);
+    reportResultExtra("lote", caso, repeticoes, total, extra);
+    return 0;
+}
+
+int main() {
+    if (runPlanes(15, 5) || runPlanes(63, 100) || runPlanes(255, 2000) || runPlanes(1023, 20000)) return 1;
+
+    num_inimigos = 5;
+    const int tamanhos[] = { 1, 64, 1024, 4096 };
+    const int threads[] = { 1, 4 };
+    const int observacoes[] = { OBSERVACAO_JANELA, OBSERVACAO_PLANOS };
+    for (size_t o = 0; o < sizeof(observacoes) / sizeof(observacoes[0]); o++) {
+        for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]); t++) {
+            uint64_t referencia = 0;
+            for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); k++) {
+                uint64_t h = runCase(tamanhos[t], threads[k], observacoes[o]);
+                if (k == 0) referencia = h;
+                if (h != referencia) {
+                    fprintf(stderr, "Lote de %d com %d threads difere do lote com 1 thread\n", tamanhos[t],
+                            threads[k]);
+                    return 1;
+                }
+            }
+        }
+    }
+    setWorkerCount(1);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Benchmark do gerador de mapas: tempo de geração x tamanho, conferindo que o
+ * mapa é conexo e que a mesma semente gera o mesmo mapa
+ */
+#include "../mapgen.h"
+#include "bench_util.h"
+#include <vector>
+
+// Conta as células não-parede alcançáveis a partir de (1, 1), passando por blocos
+static size_t reachableCells(const Mapa& mapa) {
+    std::vector<uint8_t> visto(mapa.cellCount(), 0);
+    std::vector<int> pilha;
+    pilha.push_back(1 | (1 << 16));
+    visto[mapa.index(1, 1)] = 1;
+    size_t alcancadas = 0;
+    while (!pilha.empty()) {
+        int c = pilha.back();
+        pilha.pop_back();
+        alcancadas++;
+        int x = c & 0xFFFF, z = c >> 16;
+        const int dx[4] = { 1, -1, 0, 0 }, dz[4] = { 0, 0, 1, -1 };
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], nz = z + dz[d];
+            size_t n = mapa.index(nx, nz);
+            if (!visto[n] && mapa.celulas[n] != CELULA_PAREDE) {
+                visto[n] = 1;
+                pilha.push_back(nx | (nz << 16));
+            }
+        }
+    }
+    return alcancadas;
+}
+
+static size_t openCells(const Mapa& mapa) {
+    size_t n = 0;
+    for (int z = 0; z < mapa.altura; z++)
+        for (int x = 0; x < mapa.largura; x++)
+            if (mapa.at(x, z) != CELULA_PAREDE) n++;
+    return n;
+}
+
+int main() {
+    const int lados[] = { 13, 256, 1024, 4096 };
+    const int paredes[] = { 0, 20 };
+
+    for (size_t l = 0; l < sizeof(lados) / sizeof(lados[0]); l++) {
+        for (size_t w = 0; w < sizeof(paredes) / sizeof(paredes[0]); w++) {
+            ParametrosMapa p;
+            p.largura = p.altura = lados[l];
+            p.densidade_blocos = 25;
+            p.densidade_paredes = paredes[w];
+            p.semente = 42;
+
+            Mapa mapa;
+            mapa.resize(p.largura, p.altura); // fora da medição
+            int iter = lados[l] >= 1024 ? 5 : 200;
+            double inicio = nowNs();
+            for (int i = 0; i < iter; i++) {
+                p.semente = 42 + i;
+                generateMap(mapa, p, 1, 1);
+            }
+            double total = nowNs() - inicio;
+
+            char caso[64];
+            snprintf(caso, sizeof(caso), "%dx%d_paredes_%d", lados[l], lados[l], paredes[w]);
+            reportResult("mapa", caso, iter, total);
+
+            // Conexo, com o bolsão do jogador livre e reprodutível
+            if (reachableCells(mapa) != openCells(mapa)) {
+                fprintf(stderr, "Mapa %s desconexo\n", caso);
+                return 1;
+            }
+            if (mapa.at(1, 1) != CELULA_VAZIA || mapa.at(2, 1) != CELULA_VAZIA || mapa.at(1, 2) != CELULA_VAZIA) {
+                fprintf(stderr, "Mapa %s sem bolsão livre para o jogador\n", caso);
+                return 1;
+            }
+            Mapa copia;
+            generateMap(copia, p, 1, 1);
+            if (copia.celulas != mapa.celulas) {
+                fprintf(stderr, "Mapa %s mudou com a mesma semente\n", caso);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
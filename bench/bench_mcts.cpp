@@ -0,0 +1,118 @@
+/*
+ * Benchmark do bot MCTS (mcts.h): simulações e ticks das regras por segundo
+ * numa busca, por tamanho de mapa, controlando o jogador e um inimigo; e a
+ * qualidade do jogo do bot (vitórias, inimigos mortos, ticks vivo) com cada vez
+ * mais simulações por jogada, contra um jogador que aperta teclas ao acaso.
+ * A qualidade é medida num 15x15 lotado de inimigos: num mapa fácil o bot
+ * ganha todas as partidas já com poucas simulações e os orçamentos empatam.
+ *
+ *   bench_mcts [--partidas N]
+ */
+#include "../mcts.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+static int partidas = 8;
+static const int LADO_QUALIDADE = 15;
+static const int INIMIGOS_QUALIDADE = 15;
+// Só para não travar o benchmark: as partidas acabam bem antes (vitória ou
+// morte) e as que chegam aqui aparecem em "no_limite"
+static const int MAX_JOGADAS = 5000;
+
+static void newMatch(int lado, int n_inimigos, uint64_t semente) {
+    setMapSize(lado, lado);
+    num_inimigos = n_inimigos;
+    jogadores.assign(1, Jogador());
+    tick_atual = 0;
+    initMap(semente);
+}
+
+static int runThroughput(int lado, int n_inimigos, bool inimigo) {
+    newMatch(lado, n_inimigos, 42);
+    for (int t = 0; t < 10; t++) stepGame(); // algumas bombas no mapa
+    if (!anyPlayerAlive() || inimigos.size() == 0) {
+        fprintf(stderr, "Partida de teste acabou cedo (%dx%d)\n", lado, lado);
+        return 1;
+    }
+
+    ConfigMcts cfg;
+    cfg.orcamento = 0;
+    cfg.max_simulacoes = 2000;
+    uint64_t antes = stateChecksum();
+    BuscaMcts busca;
+    ResultadoMcts r;
+    AgenteMcts agente = inimigo ? AgenteMcts::enemy(inimigos.id[0]) : AgenteMcts::player(0);
+    busca.search(agente, cfg, &r);
+    if (stateChecksum() != antes) {
+        fprintf(stderr, "A busca mudou a partida (%dx%d)\n", lado, lado);
+        return 1;
+    }
+
+    char caso[64], extra[256];
+    snprintf(caso, sizeof(caso), "busca_%s_%dx%d_%d_inimigos", inimigo ? "inimigo" : "jogador", lado, lado,
+             n_inimigos);
+    snprintf(extra, sizeof(extra), "\"simulacoes_por_s\":%.0f,\"ticks_por_s\":%.0f,\"nos\":%d,\"acao\":%d",
+             r.simulacoes / r.tempo, r.ticks / r.tempo, r.nos, r.acao);
+    reportResultExtra("mcts", caso, r.simulacoes, r.tempo * 1e9, extra);
+    return 0;
+}
+
+// Joga 'partidas' partidas com o bot (simulacoes > 0) ou ao acaso (0)
+static void runQuality(int simulacoes) {
+    BuscaMcts busca;
+    ConfigMcts cfg;
+    cfg.orcamento = 0;
+    cfg.max_simulacoes = simulacoes;
+    cfg.profundidade = 10;
+    uint64_t gerador = 99;
+    int vitorias = 0, no_limite = 0;
+    long mortos = 0, vivo = 0, simuladas = 0;
+    double tempo = 0;
+
+    for (int p = 0; p < partidas; p++) {
+        newMatch(LADO_QUALIDADE, INIMIGOS_QUALIDADE, 1000 + p);
+        int jogadas = 0;
+        for (; jogadas < MAX_JOGADAS && jogadores[0].vivo && !player_won; jogadas++) {
+            int acao;
+            if (simulacoes > 0) {
+                ResultadoMcts r;
+                acao = busca.search(AgenteMcts::player(0), cfg, &r);
+                tempo += r.tempo;
+                simuladas += r.simulacoes;
+            } else {
+                uint64_t x = splitmix64(gerador);
+                acao = x % 10 == 0 ? ACAO_BOMBA : (int)((x >> 8) % ACAO_BOMBA);
+            }
+            applyAction(0, acao);
+            stepGame();
+        }
+        if (player_won) vitorias++;
+        if (jogadas == MAX_JOGADAS) no_limite++;
+        mortos += INIMIGOS_QUALIDADE - (long)inimigos.size();
+        vivo += jogadas;
+    }
+
+    char caso[64], extra[256];
+    snprintf(caso, sizeof(caso), simulacoes > 0 ? "jogo_%d_simulacoes" : "jogo_ao_acaso", simulacoes);
+    snprintf(extra, sizeof(extra),
+             "\"partidas\":%d,\"vitorias\":%d,\"inimigos_mortos_por_partida\":%.2f,\"ticks_vivo_por_partida\":%.1f,"
+             "\"no_limite\":%d",
+             partidas, vitorias, (double)mortos / partidas, (double)vivo / partidas, no_limite);
+    reportResultExtra("mcts", caso, simulacoes > 0 ? simuladas : vivo, tempo * 1e9, extra);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--partidas") == 0 && i + 1 < argc) partidas = max(1, atoi(argv[++i]));
+
+    if (runThroughput(15, 5, false) || runThroughput(31, 20, false) || runThroughput(63, 80, false) ||
+        runThroughput(31, 20, true))
+        return 1;
+
+    const int simulacoes[] = { 0, 2, 4, 8, 16, 64 };
+    for (size_t k = 0; k < sizeof(simulacoes) / sizeof(simulacoes[0]); k++) runQuality(simulacoes[k]);
+    return 0;
+}
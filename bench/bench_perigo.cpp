@@ -0,0 +1,89 @@
+/*
+ * Benchmark do mapa de perigo: manutenção incremental x recálculo completo a cada tick
+ */
+#include "../game.h"
+#include "bench_util.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static int bombas_por_tick = 2;
+
+// Planta algumas bombas em células livres escolhidas ao acaso
+static void plantRandomBombs() {
+    for (int k = 0; k < bombas_por_tick; k++) {
+        int x = rand() % (gameMap.largura - 2) + 1;
+        int z = rand() % (gameMap.altura - 2) + 1;
+        if (gameMap.at(x, z) == CELULA_VAZIA && !hasBomb(x, z))
+            plantBomb(x, z, DONO_INIMIGO);
+    }
+}
+
+static void resetMatch(int lado) {
+    srand(42);
+    bombas.clear();
+    tick_atual = 0;
+    setMapSize(lado, lado);
+    initMap();
+}
+
+static int runSize(int lado) {
+    int area = lado * lado;
+    int ticks = 200000 * (MAP_SIZE * MAP_SIZE) / area;
+    if (ticks < 200) ticks = 200;
+    bombas_por_tick = area / 512 > 2 ? area / 512 : 2;
+
+    char caso[64];
+
+    // Incremental: o custo de manter o mapa já está dentro de plantBomb()/updateBombs()
+    resetMatch(lado);
+    double inicio = nowNs();
+    for (int t = 0; t < ticks; t++) {
+        plantRandomBombs();
+        tick_atual++;
+        updateBombs();
+    }
+    snprintf(caso, sizeof(caso), "incremental_%dx%d", lado, lado);
+    reportResult("perigo", caso, ticks, nowNs() - inicio);
+
+    // Mesmo jogo, recalculando o mapa inteiro depois de cada tick
+    resetMatch(lado);
+    double recalculo = 0;
+    inicio = nowNs();
+    for (int t = 0; t < ticks; t++) {
+        plantRandomBombs();
+        tick_atual++;
+        updateBombs();
+        double r = nowNs();
+        rebuildDangerMap();
+        recalculo += nowNs() - r;
+    }
+    snprintf(caso, sizeof(caso), "incremental_mais_recalculo_%dx%d", lado, lado);
+    reportResult("perigo", caso, ticks, nowNs() - inicio);
+    snprintf(caso, sizeof(caso), "so_recalculo_%dx%d", lado, lado);
+    reportResult("perigo", caso, ticks, recalculo);
+
+    // Confere que as duas formas produzem o mesmo mapa
+    resetMatch(lado);
+    std::vector<int> copia;
+    for (int t = 0; t < ticks / 10; t++) {
+        plantRandomBombs();
+        tick_atual++;
+        updateBombs();
+        copia = perigo;
+        rebuildDangerMap();
+        if (copia != perigo) {
+            fprintf(stderr, "Mapa de perigo incremental divergiu no tick %d (%dx%d)\n", tick_atual, lado, lado);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main() {
+    const int lados[] = { 13, 64, 256 };
+    for (size_t i = 0; i < sizeof(lados) / sizeof(lados[0]); i++) {
+        if (runSize(lados[i]) != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,275 @@
+/*
+ * Portão de regressão de desempenho: roda os benchmarks várias vezes, calcula
+ * média e intervalo de confiança (95%, t de Student) de cada caso e compara com
+ * a base guardada no repositório (bench/base.json). Um caso piorou quando ficou
+ * mais lento que a base além do limiar E o teste t de Welch (unilateral, 95%)
+ * diz que a diferença não é ruído; aí o programa sai com 1. Tudo local, sem
+ * rede: a base só vale na máquina em que foi gravada.
+ *
+ *   bench_regressao [--base ARQ] [--dir DIR] [--repeticoes N] [--limiar PCT] [--gravar] BENCH...
+ *
+ * As rodadas são intercaladas (todos os benchmarks na rodada 1, depois na 2...)
+ * para uma mudança lenta na máquina (temperatura, outro processo) não cair
+ * toda num benchmark só. Com --gravar, a base é reescrita com as medidas.
+ * Saída: 0 sem regressão, 1 com regressão, 2 em erro.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+using namespace std;
+
+struct Amostras {
+    vector<double> ns;  // ns_por_iteracao de cada rodada
+    string checksum;    // da última rodada, se o caso tiver
+};
+
+struct Resumo {
+    int n;
+    double media, desvio; // desvio padrão amostral
+    string checksum;
+};
+
+// Quantis da t de Student por graus de liberdade (1 a 30; depois, a normal)
+static const double T_UNILATERAL_95[31] = { 0, 6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833,
+                                            1.812, 1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729,
+                                            1.725, 1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699,
+                                            1.697 };
+static const double T_BILATERAL_95[31] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+                                           2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+                                           2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+                                           2.042 };
+
+// Graus de liberdade fracionários (Welch) arredondam para baixo: o quantil
+// fica maior, o teste mais conservador
+static double tQuantile(const double* tabela, double normal, double gl) {
+    if (gl < 1) return tabela[1];
+    if (gl > 30) return normal;
+    return tabela[(int)gl];
+}
+
+// Campo de uma linha JSON plana dos benchmarks (bench_util.h)
+static bool stringField(const string& linha, const char* nome, string& valor) {
+    string chave = string("\"") + nome + "\":\"";
+    size_t p = linha.find(chave);
+    if (p == string::npos) return false;
+    p += chave.size();
+    size_t fim = linha.find('"', p);
+    if (fim == string::npos) return false;
+    valor = linha.substr(p, fim - p);
+    return true;
+}
+
+static bool numberField(const string& linha, const char* nome, double& valor) {
+    string chave = string("\"") + nome + "\":";
+    size_t p = linha.find(chave);
+    if (p == string::npos) return false;
+    char* fim = 0;
+    valor = strtod(linha.c_str() + p + chave.size(), &fim);
+    return fim != linha.c_str() + p + chave.size();
+}
+
+// Roda um benchmark no diretório dele (onde ficam os assets) e junta as linhas
+static bool runBench(const string& dir, const string& bench, map<string, Amostras>& casos) {
+    string comando = "cd '" + dir + "' && './" + bench + "'";
+    FILE* saida = popen(comando.c_str(), "r");
+    if (!saida) return false;
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), saida)) {
+        string linha(buffer), nome, caso;
+        double ns;
+        if (!stringField(linha, "bench", nome) || !stringField(linha, "caso", caso) ||
+            !numberField(linha, "ns_por_iteracao", ns))
+            continue;
+        Amostras& a = casos[nome + "/" + caso];
+        a.ns.push_back(ns);
+        stringField(linha, "checksum", a.checksum);
+    }
+    return pclose(saida) == 0;
+}
+
+static Resumo summarize(const Amostras& a) {
+    Resumo r;
+    r.n = (int)a.ns.size();
+    r.media = 0;
+    for (size_t i = 0; i < a.ns.size(); i++) r.media += a.ns[i];
+    r.media /= r.n;
+    double soma = 0;
+    for (size_t i = 0; i < a.ns.size(); i++) soma += (a.ns[i] - r.media) * (a.ns[i] - r.media);
+    r.desvio = r.n > 1 ? sqrt(soma / (r.n - 1)) : 0;
+    r.checksum = a.checksum;
+    return r;
+}
+
+// Meia largura do intervalo de confiança de 95% da média
+static double halfInterval(const Resumo& r) {
+    if (r.n < 2) return 0;
+    return tQuantile(T_BILATERAL_95, 1.960, r.n - 1) * r.desvio / sqrt((double)r.n);
+}
+
+// Teste t de Welch unilateral: 'atual' é mais lento que 'base' com 95% de confiança
+static bool significantlySlower(const Resumo& base, const Resumo& atual) {
+    double vb = base.desvio * base.desvio / base.n, va = atual.desvio * atual.desvio / atual.n;
+    if (vb + va == 0) return atual.media > base.media;
+    double t = (atual.media - base.media) / sqrt(vb + va);
+    double gl = (vb + va) * (vb + va) /
+                ((base.n > 1 ? vb * vb / (base.n - 1) : 0) + (atual.n > 1 ? va * va / (atual.n - 1) : 0));
+    return t > tQuantile(T_UNILATERAL_95, 1.645, gl);
+}
+
+static string commandOutput(const char* comando) {
+    string resultado;
+    FILE* f = popen(comando, "r");
+    if (!f) return resultado;
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), f)) resultado += buffer;
+    pclose(f);
+    while (!resultado.empty() && (resultado[resultado.size() - 1] == '\n' || resultado[resultado.size() - 1] == '\r'))
+        resultado.erase(resultado.size() - 1);
+    return resultado;
+}
+
+static string hostName() {
+    char nome[256] = "";
+    gethostname(nome, sizeof(nome) - 1);
+    return nome;
+}
+
+// Base: uma linha de informação (commit, máquina) e uma por caso
+static bool readBase(const char* caminho, map<string, Resumo>& base, string& maquina) {
+    FILE* f = fopen(caminho, "r");
+    if (!f) return false;
+    char buffer[4096];
+    while (fgets(buffer, sizeof(buffer), f)) {
+        string linha(buffer), nome, caso;
+        double n, media, desvio;
+        if (!stringField(linha, "bench", nome) || !stringField(linha, "caso", caso)) continue;
+        if (nome == "base") {
+            stringField(linha, "maquina", maquina);
+            continue;
+        }
+        if (!numberField(linha, "amostras", n) || !numberField(linha, "media_ns", media) ||
+            !numberField(linha, "desvio_ns", desvio))
+            continue;
+        Resumo& r = base[nome + "/" + caso];
+        r.n = (int)n;
+        r.media = media;
+        r.desvio = desvio;
+        stringField(linha, "checksum", r.checksum);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeBase(const char* caminho, const map<string, Amostras>& casos, int repeticoes) {
+    FILE* f = fopen(caminho, "w");
+    if (!f) return false;
+    char data[32];
+    time_t agora = time(0);
+    strftime(data, sizeof(data), "%Y-%m-%dT%H:%M:%S", localtime(&agora));
+    string commit = commandOutput("git rev-parse --short HEAD 2>/dev/null");
+    fprintf(f, "{\"bench\":\"base\",\"caso\":\"info\",\"commit\":\"%s\",\"maquina\":\"%s\",\"repeticoes\":%d,\"data\":\"%s\"}\n",
+            commit.empty() ? "desconhecido" : commit.c_str(), hostName().c_str(), repeticoes, data);
+    for (map<string, Amostras>::const_iterator it = casos.begin(); it != casos.end(); ++it) {
+        Resumo r = summarize(it->second);
+        size_t barra = it->first.find('/');
+        fprintf(f, "{\"bench\":\"%s\",\"caso\":\"%s\",\"amostras\":%d,\"media_ns\":%.1f,\"desvio_ns\":%.1f",
+                it->first.substr(0, barra).c_str(), it->first.substr(barra + 1).c_str(), r.n, r.media, r.desvio);
+        if (!r.checksum.empty()) fprintf(f, ",\"checksum\":\"%s\"", r.checksum.c_str());
+        fprintf(f, "}\n");
+    }
+    return fclose(f) == 0;
+}
+
+int main(int argc, char** argv) {
+    const char* caminho_base = "bench/base.json";
+    string dir = ".";
+    int repeticoes = 5;
+    double limiar = 5.0;
+    bool gravar = false;
+    vector<string> benches;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--base") == 0 && i + 1 < argc) caminho_base = argv[++i];
+        else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) dir = argv[++i];
+        else if (strcmp(argv[i], "--repeticoes") == 0 && i + 1 < argc) repeticoes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--limiar") == 0 && i + 1 < argc) limiar = atof(argv[++i]);
+        else if (strcmp(argv[i], "--gravar") == 0) gravar = true;
+        else benches.push_back(argv[i]);
+    }
+    if (benches.empty() || repeticoes < 2) {
+        fprintf(stderr, "uso: bench_regressao [--base ARQ] [--dir DIR] [--repeticoes N>=2] [--limiar PCT] [--gravar] BENCH...\n");
+        return 2;
+    }
+
+    map<string, Resumo> base;
+    string maquina_base;
+    if (!gravar) {
+        if (!readBase(caminho_base, base, maquina_base)) {
+            fprintf(stderr, "Sem base em %s (grave uma com --gravar)\n", caminho_base);
+            return 2;
+        }
+        if (!maquina_base.empty() && maquina_base != hostName())
+            fprintf(stderr, "Aviso: a base foi gravada em '%s', nao nesta maquina (%s)\n", maquina_base.c_str(),
+                    hostName().c_str());
+    }
+
+    map<string, Amostras> casos;
+    for (int r = 0; r < repeticoes; r++) {
+        for (size_t b = 0; b < benches.size(); b++) {
+            fprintf(stderr, "[%d/%d] %s\n", r + 1, repeticoes, benches[b].c_str());
+            if (!runBench(dir, benches[b], casos)) {
+                fprintf(stderr, "%s falhou\n", benches[b].c_str());
+                return 2;
+            }
+        }
+    }
+
+    if (gravar) {
+        if (!writeBase(caminho_base, casos, repeticoes)) {
+            fprintf(stderr, "Nao foi possivel escrever %s\n", caminho_base);
+            return 2;
+        }
+        printf("Base com %zu casos gravada em %s\n", casos.size(), caminho_base);
+        return 0;
+    }
+
+    int pioraram = 0, melhoraram = 0;
+    printf("%-48s %22s %22s %8s\n", "caso", "base (ns, IC 95%)", "atual (ns, IC 95%)", "mudanca");
+    for (map<string, Amostras>::const_iterator it = casos.begin(); it != casos.end(); ++it) {
+        Resumo atual = summarize(it->second);
+        map<string, Resumo>::const_iterator b = base.find(it->first);
+        if (b == base.end()) {
+            printf("%-48s %22s %13.1f +- %-6.1f %8s\n", it->first.c_str(), "-", atual.media, halfInterval(atual), "novo");
+            continue;
+        }
+        double mudanca = (atual.media - b->second.media) / b->second.media * 100;
+        const char* veredito = "";
+        if (mudanca > limiar && significantlySlower(b->second, atual)) {
+            veredito = "  PIOROU";
+            pioraram++;
+        } else if (-mudanca > limiar && significantlySlower(atual, b->second)) {
+            veredito = "  melhorou";
+            melhoraram++;
+        }
+        printf("%-48s %13.1f +- %-6.1f %13.1f +- %-6.1f %+7.1f%%%s\n", it->first.c_str(), b->second.media,
+               halfInterval(b->second), atual.media, halfInterval(atual), mudanca, veredito);
+        if (!b->second.checksum.empty() && b->second.checksum != atual.checksum)
+            printf("%-48s checksum mudou (%s -> %s): as regras simulam outra partida\n", "", b->second.checksum.c_str(),
+                   atual.checksum.c_str());
+    }
+    // Só avisa dos casos sumidos dos benchmarks que rodaram agora
+    set<string> medidos;
+    for (map<string, Amostras>::const_iterator it = casos.begin(); it != casos.end(); ++it)
+        medidos.insert(it->first.substr(0, it->first.find('/')));
+    for (map<string, Resumo>::const_iterator it = base.begin(); it != base.end(); ++it)
+        if (!casos.count(it->first) && medidos.count(it->first.substr(0, it->first.find('/')))) printf("%-48s sumiu (esta na base, nao foi medido)\n", it->first.c_str());
+
+    printf("%d pioraram e %d melhoraram alem de %.1f%% (teste t de Welch, 95%%)\n", pioraram, melhoraram, limiar);
+    return pioraram > 0 ? 1 : 0;
+}
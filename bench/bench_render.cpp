@@ -0,0 +1,393 @@
+/*
+ * Benchmark do desenho sem janela: a cena do jogo (render.h) desenhada num
+ * framebuffer (FBO) de um contexto EGL sem tela, na resolução pedida. Cada
+ * cena é uma partida de semente fixa com a câmera dando uma volta completa em
+ * torno do mapa e as regras andando um tick a cada PASSOS_POR_TICK quadros,
+ * então dois commits desenham exatamente os mesmos quadros. A volta é desenhada
+ * uma vez para aquecer (pedaços do mapa montados, estados do GL já compilados
+ * pelo driver) e, com a partida restaurada ao início, de novo para medir.
+ *
+ * Mede o quadro inteiro com glFinish() (CPU + GPU), com p50/p99, o tempo de
+ * CPU e de GPU de cada fase do TemposQuadro, a média por quadro das chamadas
+ * ao GL (ContadoresGL) e as alocações (alloc_count.h): na volta medida nenhum
+ * quadro pode alocar, senão o programa falha. Com --dump alguns quadros são
+ * gravados em PPM; com --comparar eles são comparados aos de outro diretório
+ * (com tolerância, drivers diferentes não dão os mesmos bits) e o programa
+ * falha se algum ficar diferente demais.
+ *
+ * Cada cena é medida pelo GL fixo e, se o contexto tiver GL 3.3, pelos
+ * shaders (casos com "_shaders"); --caminho escolhe um só. Com --core o
+ * contexto é 3.3 só com o perfil core (casos com "_core"), que não tem o GL
+ * fixo: confere que o caminho com shaders não depende dele. Qualquer erro do
+ * GL no fim de uma cena também faz o programa falhar.
+ *
+ *   bench_render [--resolucao LARGURAxALTURA] [--quadros N] [--assets DIR]
+ *                [--dump DIR] [--comparar DIR] [--caminho fixo|shaders] [--core]
+ */
+#include "alloc_count.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "../render.h"
+#include <GL/glext.h>
+#include "bench_util.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace std;
+
+static const int PASSOS_POR_TICK = 10;
+static const int DUMPS_POR_CENA = 4;
+
+// Comparação com os quadros de referência: diferença máxima por canal e
+// fração de pixels que pode passar dela (bordas de triângulo e filtragem)
+static const int TOLERANCIA_CANAL = 8;
+static const double TOLERANCIA_PIXELS = 0.002;
+
+struct Cena {
+    const char* nome;
+    int lado, inimigos;
+};
+
+static const Cena CENAS[] = {
+    { "31x31_20_inimigos", 31, 20 },
+    { "127x127_200_inimigos", 127, 200 },
+};
+
+// Funções do FBO (GL 3.0 / ARB_framebuffer_object), ausentes do gl.h do GL 1.x
+static PFNGLGENFRAMEBUFFERSPROC gen_framebuffers = 0;
+static PFNGLBINDFRAMEBUFFERPROC bind_framebuffer = 0;
+static PFNGLGENRENDERBUFFERSPROC gen_renderbuffers = 0;
+static PFNGLBINDRENDERBUFFERPROC bind_renderbuffer = 0;
+static PFNGLRENDERBUFFERSTORAGEPROC renderbuffer_storage = 0;
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC framebuffer_renderbuffer = 0;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC check_framebuffer_status = 0;
+
+static void* eglProcAddress(const char* nome) {
+    return (void*)eglGetProcAddress(nome);
+}
+
+// Contexto GL sem janela, de compatibilidade ou (core) 3.3 só com o perfil
+// core: sem tela (Mesa) ou, se o driver não tiver, um pbuffer de 1x1 só para
+// torná-lo atual
+static bool openContext(bool core) {
+    EGLDisplay tela = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    if (platform_display) tela = platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+#endif
+    EGLint maior, menor;
+    if (tela == EGL_NO_DISPLAY || !eglInitialize(tela, &maior, &menor)) {
+        tela = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (tela == EGL_NO_DISPLAY || !eglInitialize(tela, &maior, &menor)) {
+            fprintf(stderr, "EGL indisponivel\n");
+            return false;
+        }
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "EGL sem OpenGL de desktop\n");
+        return false;
+    }
+
+    const EGLint atributos[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint n = 0;
+    if (!eglChooseConfig(tela, atributos, &config, 1, &n) || n < 1) {
+        fprintf(stderr, "Nenhuma configuracao EGL com OpenGL\n");
+        return false;
+    }
+    const EGLint versao_core[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext contexto = eglCreateContext(tela, config, EGL_NO_CONTEXT, core ? versao_core : 0);
+    if (contexto == EGL_NO_CONTEXT) {
+        fprintf(stderr, "Falha ao criar o contexto GL%s\n", core ? " 3.3 core" : "");
+        return false;
+    }
+    if (!eglMakeCurrent(tela, EGL_NO_SURFACE, EGL_NO_SURFACE, contexto)) {
+        const EGLint pbuffer[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        EGLSurface superficie = eglCreatePbufferSurface(tela, config, pbuffer);
+        if (superficie == EGL_NO_SURFACE || !eglMakeCurrent(tela, superficie, superficie, contexto)) {
+            fprintf(stderr, "Falha ao ativar o contexto GL\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Cor RGBA8 e profundidade de 24 bits, no lugar da janela
+static bool openFramebuffer(int largura, int altura) {
+    gen_framebuffers = (PFNGLGENFRAMEBUFFERSPROC)eglProcAddress("glGenFramebuffers");
+    bind_framebuffer = (PFNGLBINDFRAMEBUFFERPROC)eglProcAddress("glBindFramebuffer");
+    gen_renderbuffers = (PFNGLGENRENDERBUFFERSPROC)eglProcAddress("glGenRenderbuffers");
+    bind_renderbuffer = (PFNGLBINDRENDERBUFFERPROC)eglProcAddress("glBindRenderbuffer");
+    renderbuffer_storage = (PFNGLRENDERBUFFERSTORAGEPROC)eglProcAddress("glRenderbufferStorage");
+    framebuffer_renderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)eglProcAddress("glFramebufferRenderbuffer");
+    check_framebuffer_status = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)eglProcAddress("glCheckFramebufferStatus");
+    if (!gen_framebuffers || !bind_framebuffer || !gen_renderbuffers || !bind_renderbuffer ||
+        !renderbuffer_storage || !framebuffer_renderbuffer || !check_framebuffer_status) {
+        fprintf(stderr, "GL sem framebuffer objects\n");
+        return false;
+    }
+
+    GLuint fbo, buffers[2];
+    gen_framebuffers(1, &fbo);
+    bind_framebuffer(GL_FRAMEBUFFER, fbo);
+    gen_renderbuffers(2, buffers);
+    bind_renderbuffer(GL_RENDERBUFFER, buffers[0]);
+    renderbuffer_storage(GL_RENDERBUFFER, GL_RGBA8, largura, altura);
+    framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, buffers[0]);
+    bind_renderbuffer(GL_RENDERBUFFER, buffers[1]);
+    renderbuffer_storage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, largura, altura);
+    framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, buffers[1]);
+    if (check_framebuffer_status(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Framebuffer de %dx%d incompleto\n", largura, altura);
+        return false;
+    }
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    return true;
+}
+
+// Quadro atual em RGB, linha de cima primeiro (o GL lê de baixo para cima)
+static void readFrame(int largura, int altura, vector<unsigned char>& rgb) {
+    vector<unsigned char> linhas((size_t)largura * altura * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, largura, altura, GL_RGB, GL_UNSIGNED_BYTE, &linhas[0]);
+    rgb.resize(linhas.size());
+    size_t tamanho_linha = (size_t)largura * 3;
+    for (int y = 0; y < altura; y++)
+        memcpy(&rgb[(size_t)y * tamanho_linha], &linhas[(size_t)(altura - 1 - y) * tamanho_linha], tamanho_linha);
+}
+
+static bool writePpm(const string& caminho, int largura, int altura, const vector<unsigned char>& rgb) {
+    FILE* f = fopen(caminho.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", largura, altura);
+    bool ok = fwrite(&rgb[0], 1, rgb.size(), f) == rgb.size();
+    return fclose(f) == 0 && ok;
+}
+
+static bool readPpm(const string& caminho, int& largura, int& altura, vector<unsigned char>& rgb) {
+    FILE* f = fopen(caminho.c_str(), "rb");
+    if (!f) return false;
+    int maximo = 0;
+    bool ok = fscanf(f, "P6 %d %d %d", &largura, &altura, &maximo) == 3 && maximo == 255 && fgetc(f) != EOF;
+    if (ok) {
+        rgb.resize((size_t)largura * altura * 3);
+        ok = fread(&rgb[0], 1, rgb.size(), f) == rgb.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+// Fração dos pixels com algum canal além de TOLERANCIA_CANAL
+static double differentPixels(const vector<unsigned char>& a, const vector<unsigned char>& b) {
+    size_t diferentes = 0, pixels = a.size() / 3;
+    for (size_t p = 0; p < pixels; p++) {
+        for (int c = 0; c < 3; c++) {
+            if (abs((int)a[p * 3 + c] - (int)b[p * 3 + c]) > TOLERANCIA_CANAL) {
+                diferentes++;
+                break;
+            }
+        }
+    }
+    return pixels ? (double)diferentes / pixels : 0;
+}
+
+static double percentile(vector<double> valores, double p) {
+    sort(valores.begin(), valores.end());
+    size_t i = min(valores.size() - 1, (size_t)(p * (valores.size() - 1) + 0.5));
+    return valores[i];
+}
+
+// Quadro q da volta: câmera, regras (a cada PASSOS_POR_TICK quadros) e
+// desenho, com o relógio das animações em quadros de 60 por segundo
+static void stepFrame(TemposQuadro& tempos, int q, int quadros) {
+    cam_angle_y = 45.0f + 360.0f * q / quadros;
+    if (q > 0 && q % PASSOS_POR_TICK == 0) stepGame();
+    setSceneTime(q / 60.0);
+    renderScene(tempos);
+}
+
+int main(int argc, char** argv) {
+    int largura = 800, altura = 600, quadros = 240;
+    const char* assets = "assets";
+    const char* dump = 0;
+    const char* comparar = 0;
+    const char* caminho = 0;
+    bool core = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--resolucao") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &largura, &altura) != 2 || largura < 1 || altura < 1) {
+                fprintf(stderr, "Resolucao invalida: %s (use LARGURAxALTURA)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) {
+            quadros = max(DUMPS_POR_CENA, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--assets") == 0 && i + 1 < argc) {
+            assets = argv[++i];
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dump = argv[++i];
+        } else if (strcmp(argv[i], "--comparar") == 0 && i + 1 < argc) {
+            comparar = argv[++i];
+        } else if (strcmp(argv[i], "--caminho") == 0 && i + 1 < argc) {
+            caminho = argv[++i];
+            if (strcmp(caminho, "fixo") != 0 && strcmp(caminho, "shaders") != 0) {
+                fprintf(stderr, "Caminho invalido: %s (use fixo ou shaders)\n", caminho);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--core") == 0) {
+            core = true;
+        }
+    }
+
+    if (!openContext(core) || !openFramebuffer(largura, altura)) return 1;
+    initRenderer(assets, eglProcAddress);
+    setViewport(largura, altura);
+    TemposQuadro tempos;
+    tempos.init(eglProcAddress);
+
+    // Caminhos medidos: 0 = fixo, 1 = shaders
+    bool medir[2] = { !core && (!caminho || strcmp(caminho, "fixo") == 0),
+                      !caminho || strcmp(caminho, "shaders") == 0 };
+    if (medir[1] && !setShaders(true)) {
+        if (caminho) {
+            fprintf(stderr, "Contexto sem os shaders do GL 3.3\n");
+            return 1;
+        }
+        medir[1] = false;
+    }
+    if (!medir[0] && !medir[1]) {
+        fprintf(stderr, "O contexto core so tem o caminho com shaders\n");
+        return 1;
+    }
+
+    bool falhou = false;
+    GameState inicio_cena;
+    for (size_t c = 0; c < sizeof(CENAS) / sizeof(CENAS[0]) * 2; c++) {
+        const Cena& cena = CENAS[c / 2];
+        bool shaders = c % 2 == 1;
+        if (!medir[shaders]) continue;
+        setShaders(shaders);
+        const char* sufixo = !shaders ? "" : core ? "_core" : "_shaders";
+
+        // Os dois caminhos desenham a mesma partida: o segundo volta ao início
+        // guardado pelo primeiro (um initMap() novo herdaria parte do estado
+        // da partida anterior, como a cadência dos inimigos)
+        if (!shaders || !medir[0]) {
+            setMapSize(cena.lado, cena.lado);
+            num_inimigos = cena.inimigos;
+            jogadores.assign(1, Jogador());
+            tick_atual = 0;
+            if (!initMap(42)) {
+                fprintf(stderr, "%d inimigos nao couberam em %dx%d\n", cena.inimigos, cena.lado, cena.lado);
+                return 1;
+            }
+            fitCamera();
+            cam_angle_x = 30.0f;
+            snapshot(inicio_cena);
+        } else {
+            restore(inicio_cena);
+        }
+
+        // Aquecimento: a mesma volta da medida, a partir da mesma partida
+        for (int q = 0; q < quadros; q++) stepFrame(tempos, q, quadros);
+        glFinish();
+        restore(inicio_cena);
+
+        tempos.setEnabled(true);
+        vector<double> ms_quadro;
+        double total = 0, maior_diferenca = 0;
+        ContadoresGL soma_gl = ContadoresGL();
+        uint64_t alocacoes_quadros = 0;
+        int primeiro_com_alocacao = -1;
+        for (int q = 0; q < quadros; q++) {
+            uint64_t alocacoes_antes = allocationCount();
+            double inicio = nowNs();
+            stepFrame(tempos, q, quadros);
+            glFinish();
+            double t = nowNs() - inicio;
+            if (allocationCount() != alocacoes_antes) {
+                alocacoes_quadros += allocationCount() - alocacoes_antes;
+                if (primeiro_com_alocacao < 0) primeiro_com_alocacao = q;
+            }
+            total += t;
+            ms_quadro.push_back(t / 1e6);
+            const ContadoresGL& gl = glCounters(NUM_FASES);
+            soma_gl.desenhos += gl.desenhos;
+            soma_gl.vertices += gl.vertices;
+            soma_gl.texturas += gl.texturas;
+            soma_gl.estados += gl.estados;
+            soma_gl.matrizes += gl.matrizes;
+
+            if ((dump || comparar) && q % (quadros / DUMPS_POR_CENA) == 0) {
+                char nome[96];
+                snprintf(nome, sizeof(nome), "/%s%s_%04d.ppm", cena.nome, sufixo, q);
+                vector<unsigned char> rgb;
+                readFrame(largura, altura, rgb);
+                if (dump && !writePpm(dump + string(nome), largura, altura, rgb)) {
+                    fprintf(stderr, "Nao foi possivel gravar %s%s\n", dump, nome);
+                    return 1;
+                }
+                if (comparar) {
+                    int l = 0, a = 0;
+                    vector<unsigned char> referencia;
+                    double diferenca = 1;
+                    if (!readPpm(comparar + string(nome), l, a, referencia))
+                        fprintf(stderr, "Nao foi possivel ler %s%s\n", comparar, nome);
+                    else if (l != largura || a != altura)
+                        fprintf(stderr, "%s%s tem %dx%d\n", comparar, nome, l, a);
+                    else
+                        diferenca = differentPixels(rgb, referencia);
+                    maior_diferenca = max(maior_diferenca, diferenca);
+                    if (diferenca > TOLERANCIA_PIXELS) {
+                        fprintf(stderr, "Quadro %s: %.3f%% dos pixels diferentes\n", nome + 1, diferenca * 100);
+                        falhou = true;
+                    }
+                }
+            }
+        }
+        tempos.setEnabled(false);
+        GLenum erro = glGetError();
+        if (erro != GL_NO_ERROR) {
+            fprintf(stderr, "%s%s: erro do GL 0x%04x\n", cena.nome, sufixo, erro);
+            falhou = true;
+        }
+
+        char caso[128], extra[1024];
+        int n = snprintf(extra, sizeof(extra),
+                         "\"largura\":%d,\"altura\":%d,\"quadros_por_s\":%.1f,\"p50_ms\":%.3f,\"p99_ms\":%.3f",
+                         largura, altura, quadros / (total / 1e9), percentile(ms_quadro, 0.5),
+                         percentile(ms_quadro, 0.99));
+        n += snprintf(extra + n, sizeof(extra) - n, ",\"caminho\":\"%s\",\"alocacoes\":%llu",
+                      shaders ? "shaders" : "fixo", (unsigned long long)alocacoes_quadros);
+        n += snprintf(extra + n, sizeof(extra) - n,
+                      ",\"desenhos_gl\":%.1f,\"vertices_gl\":%.1f,\"texturas_gl\":%.1f,\"estados_gl\":%.1f,"
+                      "\"matrizes_gl\":%.1f",
+                      (double)soma_gl.desenhos / quadros, (double)soma_gl.vertices / quadros,
+                      (double)soma_gl.texturas / quadros, (double)soma_gl.estados / quadros,
+                      (double)soma_gl.matrizes / quadros);
+        for (int f = 0; f < NUM_FASES; f++)
+            n += snprintf(extra + n, sizeof(extra) - n, ",\"cpu_%s_ms\":%.3f,\"gpu_%s_ms\":%.3f",
+                          NOMES_FASES[f], tempos.cpuMs(f), NOMES_FASES[f], tempos.gpuMs(f));
+        if (comparar) snprintf(extra + n, sizeof(extra) - n, ",\"pixels_diferentes\":%.5f", maior_diferenca);
+        snprintf(caso, sizeof(caso), "%s%s_%dx%d", cena.nome, sufixo, largura, altura);
+        reportResultExtra("render", caso, quadros, total, extra);
+        if (alocacoes_quadros > 0) {
+            fprintf(stderr, "%s%s: %llu alocacoes nos quadros (a primeira no quadro %d)\n", cena.nome, sufixo,
+                    (unsigned long long)alocacoes_quadros, primeiro_com_alocacao);
+            falhou = true;
+        }
+    }
+    return falhou ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Benchmark do rollback: pares no mesmo processo, ligados pelo transporte
+ * simulado com atraso, variação e perda, cada um com bots apertando teclas.
+ * Mede quantos quadros são re-simulados por quadro e o pior tempo de um quadro
+ * (frente ao orçamento de 1/HZ segundos). No fim, todos os pares e uma
+ * simulação de referência com as entradas reais têm de chegar ao mesmo estado,
+ * e nenhuma soma trocada entre os pares durante a partida pode ter divergido.
+ *
+ * Uso: bench_rollback [--quadros N]
+ */
+#include "../rollback.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+static const int HZ = QUADROS_ROLLBACK;
+static const int PASSO = PASSO_ROLLBACK;
+static int quadros = 1800; // 60 s de partida
+
+struct Rede {
+    const char* nome;
+    ConfigTransporte cfg;
+};
+
+static Rede makeNetwork(const char* nome, double latencia, double jitter, double perda) {
+    Rede r;
+    r.nome = nome;
+    r.cfg.latencia = latencia;
+    r.cfg.jitter = jitter;
+    r.cfg.perda = perda;
+    return r;
+}
+
+// Um bot aperta uma seta a cada ~6 quadros (5 teclas por segundo) e de vez em
+// quando a barra de espaço
+static uint8_t botInput(uint64_t& gerador) {
+    uint64_t r = splitmix64(gerador);
+    uint8_t e = r % 6 == 0 ? (uint8_t)(ACAO_CIMA + (r >> 8) % 4) : 0;
+    if ((r >> 16) % 40 == 0) e |= ENTRADA_BOMBA;
+    return e;
+}
+
+static int runCase(int lado, int n_inimigos, int n_pares, const Rede& rede) {
+    srand(42);
+    semente_partida = 42;
+    setMapSize(lado, lado);
+    num_inimigos = n_inimigos;
+    jogadores.assign(n_pares, Jogador());
+    initMap();
+
+    // Cada par tem o próprio mundo; o estado global do jogo é trocado entre eles
+    GameState inicial;
+    snapshot(inicial);
+    vector<GameState> mundos(n_pares, inicial);
+    vector<SessaoRollback> sessoes(n_pares);
+    vector<uint64_t> geradores(n_pares);
+    vector<uint8_t> reais((size_t)quadros * n_pares); // o que cada bot apertou, para a referência
+    for (int p = 0; p < n_pares; p++) {
+        sessoes[p].start(n_pares, p, PASSO);
+        geradores[p] = 1000 + p;
+    }
+    TransporteSimulado transporte(rede.cfg, 7);
+
+    uint8_t buf[1500];
+    double ns_total = 0, ns_max = 0;
+    long medidos = 0;
+    for (long t = 0;; t++) {
+        double agora = (double)t / HZ;
+        bool terminou = true;
+        for (int p = 0; p < n_pares; p++) {
+            SessaoRollback& s = sessoes[p];
+            restore(mundos[p]);
+
+            int n;
+            while ((n = transporte.recv(p, buf, sizeof(buf), agora)) >= 0) s.readInputs(buf, (size_t)n);
+
+            double inicio = nowNs();
+            s.synchronize();
+            if (s.currentFrame() < quadros && s.canAdvance()) {
+                uint8_t e = botInput(geradores[p]);
+                reais[(size_t)s.currentFrame() * n_pares + p] = e;
+                s.advance(e);
+            }
+            double tempo = nowNs() - inicio;
+            ns_total += tempo;
+            ns_max = max(ns_max, tempo);
+            medidos++;
+
+            for (int q = 0; q < n_pares; q++) {
+                if (q == p) continue;
+                size_t tam = s.writeInputs(buf, sizeof(buf), q);
+                transporte.send(p, q, buf, tam, agora);
+            }
+            snapshot(mundos[p]);
+            if (s.currentFrame() < quadros || s.confirmedFrame() < quadros - 1) terminou = false;
+        }
+        if (terminou) break;
+        if (t > (long)quadros * 20) {
+            fprintf(stderr, "Pares nao convergiram (%d pares, rede %s)\n", n_pares, rede.nome);
+            return 1;
+        }
+    }
+
+    // Com tudo confirmado, um último synchronize() deixa cada par no estado exato
+    vector<uint64_t> somas(n_pares);
+    for (int p = 0; p < n_pares; p++) {
+        restore(mundos[p]);
+        sessoes[p].synchronize();
+        somas[p] = stateChecksum();
+    }
+    restore(inicial);
+    for (int q = 0; q < quadros; q++) stepFrame(&reais[(size_t)q * n_pares], q, PASSO);
+    uint64_t referencia = stateChecksum();
+    for (int p = 0; p < n_pares; p++) {
+        if (somas[p] != referencia) {
+            fprintf(stderr, "Par %d divergiu da referencia (%d pares, rede %s)\n", p, n_pares, rede.nome);
+            return 1;
+        }
+    }
+
+    EstatisticasRollback total;
+    for (int p = 0; p < n_pares; p++) {
+        const EstatisticasRollback& e = sessoes[p].est;
+        total.quadros += e.quadros;
+        total.rollbacks += e.rollbacks;
+        total.quadros_resimulados += e.quadros_resimulados;
+        total.max_resimulados = max(total.max_resimulados, e.max_resimulados);
+        total.esperas += e.esperas;
+        total.fotos += e.fotos;
+        total.tempo_rollback_max = max(total.tempo_rollback_max, e.tempo_rollback_max);
+        total.verificacoes += e.verificacoes;
+        total.dessincronias += e.dessincronias;
+    }
+    if (total.dessincronias > 0 || total.verificacoes == 0) {
+        fprintf(stderr, "Somas entre pares: %llu comparadas, %llu divergentes (%d pares, rede %s)\n",
+                (unsigned long long)total.verificacoes, (unsigned long long)total.dessincronias, n_pares, rede.nome);
+        return 1;
+    }
+
+    char caso[96], extra[512];
+    snprintf(caso, sizeof(caso), "%dx%d_%d_pares_%s", lado, lado, n_pares, rede.nome);
+    snprintf(extra, sizeof(extra),
+             "\"latencia_ms\":%.0f,\"jitter_ms\":%.0f,\"perda\":%.2f,\"resimulados_por_quadro\":%.2f,"
+             "\"max_resimulados\":%d,\"rollbacks_por_quadro\":%.3f,\"fotos_por_quadro\":%.2f,\"esperas\":%llu,"
+             "\"ns_rollback_max\":%.0f,\"ns_quadro_max\":%.0f,\"orcamento_ns\":%.0f,\"somas_comparadas\":%llu",
+             rede.cfg.latencia * 1e3, rede.cfg.jitter * 1e3, rede.cfg.perda,
+             (double)total.quadros_resimulados / (double)total.quadros, total.max_resimulados,
+             (double)total.rollbacks / (double)total.quadros, (double)total.fotos / (double)total.quadros,
+             (unsigned long long)total.esperas, total.tempo_rollback_max * 1e9, ns_max, 1e9 / HZ,
+             (unsigned long long)total.verificacoes);
+    reportResultExtra("rollback", caso, medidos, ns_total, extra);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) quadros = max(1, atoi(argv[++i]));
+
+    const Rede redes[] = {
+        makeNetwork("lan", 0.002, 0.001, 0.0),
+        makeNetwork("regional", 0.030, 0.010, 0.01),
+        makeNetwork("ruim", 0.080, 0.040, 0.05),
+        makeNetwork("pessima", 0.150, 0.080, 0.10),
+    };
+    const int n_pares[] = { 2, 4 };
+    for (size_t r = 0; r < sizeof(redes) / sizeof(redes[0]); r++)
+        for (size_t k = 0; k < sizeof(n_pares) / sizeof(n_pares[0]); k++)
+            if (runCase(31, 10, n_pares[k], redes[r]) != 0) return 1;
+
+    // Arena grande: o custo de cada quadro re-simulado cresce com a área
+    if (runCase(257, 400, 4, redes[2]) != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Teste de carga do servidor em localhost: N bots mandam ações aleatórias no
+ * ritmo do tick e medem estados recebidos, perdas e a latência das entradas
+ * (do envio até o estado que confirma a entrada). Os bots não decodificam os
+ * estados: confirmam cada um assim que todos os fragmentos chegam, o que
+ * basta para o servidor passar a mandar deltas.
+ *
+ *   bench_servidor [--bots N] [--tick HZ] [--segundos S] [--mapa LADO] [--servidor IP:PORTA]
+ *
+ * Sem --servidor, o servidor roda numa thread deste mesmo processo.
+ */
+#include "../server.h"
+#include "../protocol.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+using namespace std;
+
+static const int JANELA = 256; // envios guardados por bot para medir a latência
+
+struct Bot {
+    SocketUdp sock;
+    int jogador;
+    uint32_t token;
+    uint32_t seq_entrada;
+    uint32_t seq_estado;
+    uint32_t confirmada; // última entrada já confirmada por um estado
+    uint32_t seq_montagem;
+    int faltam;          // fragmentos que faltam do estado seq_montagem
+    double envio[JANELA];
+    uint64_t recebidos, perdidos;
+};
+
+int main(int argc, char** argv) {
+    // Arena grande o bastante para centenas de jogadores e alguns inimigos
+    int num_bots = 200, hz = 20, lado = 129;
+    double segundos = 5.0;
+    const char* endereco = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc) num_bots = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--tick") == 0 && i + 1 < argc) hz = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--segundos") == 0 && i + 1 < argc) segundos = atof(argv[++i]);
+        else if (strcmp(argv[i], "--mapa") == 0 && i + 1 < argc) lado = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) endereco = argv[++i];
+    }
+
+    srand(42);
+    semente_partida = 42;
+    netInit();
+
+    atomic<bool> parar(false);
+    ConfigServidor cfg;
+    EstatisticasServidor est;
+    thread servidor;
+    EnderecoUdp destino;
+    if (endereco) {
+        if (!parseAddress(endereco, destino)) {
+            fprintf(stderr, "Endereco invalido: %s\n", endereco);
+            return 1;
+        }
+    } else {
+        cfg.porta = 0;
+        cfg.hz = hz;
+        cfg.max_clientes = num_bots;
+        setMapSize(lado, lado);
+        num_inimigos = 50;
+        servidor = thread([&]() { runServer(cfg, parar, &est); });
+        while (est.porta == 0) sleepSeconds(0.001);
+        char local[32];
+        snprintf(local, sizeof(local), "127.0.0.1:%d", (int)est.porta);
+        parseAddress(local, destino);
+    }
+
+    vector<Bot> bots(num_bots);
+    for (int b = 0; b < num_bots; b++) {
+        Bot& bot = bots[b];
+        memset(&bot, 0, sizeof(bot));
+        bot.jogador = -1;
+        bot.sock = udpOpen(0);
+        if (bot.sock == SOCKET_INVALIDO) {
+            fprintf(stderr, "Sem sockets para %d bots\n", num_bots);
+            return 1;
+        }
+        udpSetBuffers(bot.sock, 256 << 10);
+    }
+
+    uint8_t ola[16];
+    Escritor e_ola(ola, sizeof(ola));
+    writeHeader(e_ola, MSG_OLA);
+
+    vector<uint8_t> buf(TAMANHO_MAX_DATAGRAMA);
+    vector<double> latencias;
+    uint64_t gerador = 42, bytes_recebidos = 0;
+    const double periodo = 1.0 / hz;
+    double inicio = nowSeconds(), fim = inicio + segundos, proximo_envio = inicio;
+    double medicao = -1; // começa quando todos os bots entraram
+    int conectados = 0;
+
+    while (nowSeconds() < fim) {
+        double agora = nowSeconds();
+
+        // Uma ação aleatória por bot a cada tick (ou OLA até ser aceito)
+        if (agora >= proximo_envio) {
+            proximo_envio += periodo;
+            for (int b = 0; b < num_bots; b++) {
+                Bot& bot = bots[b];
+                if (bot.jogador < 0) {
+                    udpSend(bot.sock, destino, ola, e_ola.tam);
+                    continue;
+                }
+                uint8_t msg[32];
+                Escritor e(msg, sizeof(msg));
+                writeHeader(e, MSG_ENTRADA);
+                e.u16((uint16_t)bot.jogador);
+                e.u32(bot.token);
+                e.u32(++bot.seq_entrada);
+                e.u8((uint8_t)(splitmix64(gerador) % 32 == 0 ? (unsigned)ACAO_BOMBA : 1 + splitmix64(gerador) % 4));
+                e.u32(bot.seq_estado);
+                bot.envio[bot.seq_entrada % JANELA] = agora;
+                udpSend(bot.sock, destino, msg, e.tam);
+            }
+        }
+
+        for (int b = 0; b < num_bots; b++) {
+            Bot& bot = bots[b];
+            EnderecoUdp de;
+            int n;
+            while ((n = udpRecv(bot.sock, de, &buf[0], buf.size())) >= 0) {
+                Leitor l(&buf[0], (size_t)n);
+                uint8_t tipo;
+                if (!readHeader(l, tipo)) continue;
+                if (tipo == MSG_BEMVINDO && bot.jogador < 0) {
+                    bot.jogador = l.u16();
+                    bot.token = l.u32();
+                    if (++conectados == num_bots) medicao = nowSeconds();
+                } else if (tipo == MSG_ESTADO && bot.jogador >= 0) {
+                    FragmentoEstado f;
+                    if (!readFragment(l, f)) continue;
+                    bytes_recebidos += medicao >= 0 ? n : 0;
+                    if (f.seq != bot.seq_montagem) {
+                        bot.seq_montagem = f.seq;
+                        bot.faltam = f.partes;
+                    }
+                    if (--bot.faltam > 0) continue;
+                    uint32_t seq = f.seq, ultima = f.ultima_entrada;
+                    double t = nowSeconds();
+                    if (medicao < 0 || t < medicao) {
+                        bot.seq_estado = seq;
+                        continue;
+                    }
+                    bot.recebidos++;
+                    if (bot.seq_estado != 0 && seq > bot.seq_estado + 1) bot.perdidos += seq - bot.seq_estado - 1;
+                    if (seq > bot.seq_estado) bot.seq_estado = seq;
+                    if (ultima > bot.confirmada && bot.seq_entrada - ultima < JANELA) {
+                        latencias.push_back(t - bot.envio[ultima % JANELA]);
+                        bot.confirmada = ultima;
+                    }
+                }
+            }
+        }
+        sleepSeconds(0.0005);
+    }
+
+    parar = true;
+    if (servidor.joinable()) servidor.join();
+
+    uint64_t recebidos = 0, perdidos = 0;
+    for (int b = 0; b < num_bots; b++) {
+        recebidos += bots[b].recebidos;
+        perdidos += bots[b].perdidos;
+        udpClose(bots[b].sock);
+    }
+    if (medicao < 0) {
+        fprintf(stderr, "So %d de %d bots conseguiram entrar\n", conectados, num_bots);
+        return 1;
+    }
+
+    sort(latencias.begin(), latencias.end());
+    double p50 = latencias.empty() ? 0 : latencias[latencias.size() / 2];
+    double p99 = latencias.empty() ? 0 : latencias[latencias.size() * 99 / 100];
+    double duracao = fim - medicao;
+
+    char caso[64], extra[512];
+    snprintf(caso, sizeof(caso), "%d_bots_%dhz_%dx%d", num_bots, hz, gameMap.largura, gameMap.altura);
+    snprintf(extra, sizeof(extra),
+             "\"estados_por_s_por_bot\":%.1f,\"perda\":%.4f,\"latencia_p50_ms\":%.2f,\"latencia_p99_ms\":%.2f,"
+             "\"kb_por_s\":%.1f,\"bytes_por_estado\":%.0f,\"tick_medio_ms\":%.3f,\"tick_max_ms\":%.3f",
+             recebidos / duracao / num_bots, recebidos + perdidos ? (double)perdidos / (recebidos + perdidos) : 0.0,
+             p50 * 1e3, p99 * 1e3, bytes_recebidos / duracao / 1e3, recebidos ? (double)bytes_recebidos / recebidos : 0.0,
+             est.ticks ? est.tempo_tick_total / est.ticks * 1e3 : 0.0, est.tempo_tick_max * 1e3);
+    reportResultExtra("servidor", caso, (long)recebidos, duracao * 1e9, extra);
+    return 0;
+}
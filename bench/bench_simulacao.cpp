@@ -0,0 +1,45 @@
+/*
+ * Benchmark da simulação inteira (stepGame()) sem janela: ticks por segundo x
+ * tamanho do mapa x quantidade de inimigos, com semente fixa. O checksum do
+ * estado no fim de cada caso só muda se as regras mudarem, então dá para
+ * comparar commits sabendo se a partida simulada foi a mesma.
+ */
+#include "../game.h"
+#include "bench_util.h"
+#include <algorithm>
+
+static const int TICKS = 500;
+
+int main() {
+    const int lados[] = { 13, 31, 63, 127, 255 };
+    const int inimigos_por_caso[] = { 5, 50, 500, 5000 };
+
+    for (size_t l = 0; l < sizeof(lados) / sizeof(lados[0]); l++) {
+        for (size_t q = 0; q < sizeof(inimigos_por_caso) / sizeof(inimigos_por_caso[0]); q++) {
+            int lado = lados[l], quantidade = inimigos_por_caso[q];
+            // No máximo um inimigo a cada 8 células (boa parte do mapa é parede e bloco)
+            if (quantidade > lado * lado / 8) continue;
+
+            setMapSize(lado, lado);
+            num_inimigos = quantidade;
+            jogadores.assign(1, Jogador());
+            tick_atual = 0;
+            if (!initMap(42)) {
+                fprintf(stderr, "%d inimigos não couberam em %dx%d\n", quantidade, lado, lado);
+                return 1;
+            }
+
+            double inicio = nowNs();
+            for (int t = 0; t < TICKS; t++) stepGame();
+            double total = nowNs() - inicio;
+
+            char caso[64], extra[160];
+            snprintf(caso, sizeof(caso), "%dx%d_%d_inimigos", lado, lado, quantidade);
+            snprintf(extra, sizeof(extra),
+                     "\"ticks_por_s\":%.1f,\"inimigos_vivos_no_fim\":%zu,\"checksum\":\"%016llx\"",
+                     TICKS / (total / 1e9), inimigos.size(), (unsigned long long)stateChecksum());
+            reportResultExtra("simulacao", caso, TICKS, total, extra);
+        }
+    }
+    return 0;
+}
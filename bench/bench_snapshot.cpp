@@ -0,0 +1,90 @@
+/*
+ * Benchmark de snapshot()/restore(): custo de salvar e voltar um estado, conferindo
+ * que a partida restaurada continua exatamente igual à original
+ */
+#include "../game.h"
+#include "bench_util.h"
+#include <cstdlib>
+#include <vector>
+
+static void resetMatch(int lado, int quantidade) {
+    srand(42);
+    semente_partida = 42;
+    tick_atual = 0;
+    jogadores.assign(1, Jogador());
+    player_won = false;
+    setMapSize(lado, lado);
+    num_inimigos = quantidade;
+    initMap();
+}
+
+// Confere as grades derivadas refeitas por restore() contra o recálculo completo
+static bool derivedGridsMatch() {
+    std::vector<int> copia = perigo;
+    rebuildDangerMap();
+    if (copia != perigo) return false;
+    for (size_t i = 0; i < inimigos.size(); i++)
+        if (enemyAt(inimigos.x[i], inimigos.z[i]) != (int)i) return false;
+    return true;
+}
+
+static int runSize(int lado, int quantidade) {
+    const int AQUECIMENTO = 40, ADIANTE = 20, ITER = 2000;
+    char caso[64];
+
+    resetMatch(lado, quantidade);
+    for (int t = 0; t < AQUECIMENTO; t++) stepGame();
+
+    GameState estado;
+    snapshot(estado);
+    uint64_t na_foto = stateChecksum();
+
+    // Referência: onde a partida chega ADIANTE ticks depois da foto
+    for (int t = 0; t < ADIANTE; t++) stepGame();
+    uint64_t depois = stateChecksum();
+
+    restore(estado);
+    if (stateChecksum() != na_foto || !derivedGridsMatch()) {
+        fprintf(stderr, "restore() não voltou ao estado da foto (%dx%d)\n", lado, lado);
+        return 1;
+    }
+    for (int t = 0; t < ADIANTE; t++) stepGame();
+    if (stateChecksum() != depois) {
+        fprintf(stderr, "Partida restaurada divergiu da original (%dx%d)\n", lado, lado);
+        return 1;
+    }
+
+    // Fotos seguidas no mesmo estado (só os blocos alterados são copiados)
+    double inicio = nowNs();
+    for (int i = 0; i < ITER; i++) snapshot(estado);
+    snprintf(caso, sizeof(caso), "snapshot_%dx%d_%d_inimigos", lado, lado, quantidade);
+    reportResult("snapshot", caso, ITER, nowNs() - inicio);
+
+    // Voltar depois de um tick, como um bot de busca ou o rollback fariam
+    double total = 0;
+    for (int i = 0; i < ITER; i++) {
+        stepGame();
+        double r = nowNs();
+        restore(estado);
+        total += nowNs() - r;
+    }
+    snprintf(caso, sizeof(caso), "restore_1_tick_%dx%d_%d_inimigos", lado, lado, quantidade);
+    reportResult("snapshot", caso, ITER, total);
+
+    // Primeira foto num estado vazio: cópia inteira do mapa
+    inicio = nowNs();
+    for (int i = 0; i < 10; i++) {
+        GameState novo;
+        snapshot(novo);
+    }
+    snprintf(caso, sizeof(caso), "primeira_foto_%dx%d", lado, lado);
+    reportResult("snapshot", caso, 10, nowNs() - inicio);
+    return 0;
+}
+
+int main() {
+    if (runSize(13, NUM_ENEMIES) != 0) return 1;
+    if (runSize(256, 200) != 0) return 1;
+    if (runSize(4096, 2000) != 0) return 1;
+    return 0;
+}
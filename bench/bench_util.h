@@ -0,0 +1,31 @@
+/*
+ * Utilitarios comuns dos benchmarks: relogio e saida em JSON (uma linha por resultado)
+ */
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <cstdio>
+
+// Relógio monotônico em nanossegundos
+inline double nowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Uma linha JSON por medição, para comparar execuções na mesma máquina
+inline void reportResult(const char* bench, const char* caso, long iteracoes, double ns_total) {
+    printf("{\"bench\":\"%s\",\"caso\":\"%s\",\"iteracoes\":%ld,\"ns_por_iteracao\":%.1f}\n",
+           bench, caso, iteracoes, ns_total / (double)iteracoes);
+    fflush(stdout);
+}
+
+// Igual a reportResult(), com campos extras já formatados (ex.: "\"inimigos\":100")
+inline void reportResultExtra(const char* bench, const char* caso, long iteracoes, double ns_total,
+                              const char* extra) {
+    printf("{\"bench\":\"%s\",\"caso\":\"%s\",\"iteracoes\":%ld,\"ns_por_iteracao\":%.1f,%s}\n",
+           bench, caso, iteracoes, ns_total / (double)iteracoes, extra);
+    fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,31 @@
+# Roda a suíte de benchmarks e junta as linhas JSON num arquivo só (alvo
+# "bench" do CMake). A primeira linha identifica o commit e a máquina, para
+# comparar resultados de commits diferentes na mesma máquina.
+#
+#   cmake -DBENCHES="bench_a;bench_b" -DDIR=<build> -DSAIDA=<arquivo> -DFONTES=<repo> -P run_benches.cmake
+
+execute_process(COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${FONTES}
+    OUTPUT_VARIABLE commit
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET)
+if(NOT commit)
+    set(commit "desconhecido")
+endif()
+cmake_host_system_information(RESULT maquina QUERY HOSTNAME)
+cmake_host_system_information(RESULT nucleos QUERY NUMBER_OF_LOGICAL_CORES)
+string(TIMESTAMP data "%Y-%m-%dT%H:%M:%S")
+
+file(WRITE ${SAIDA} "{\"bench\":\"suite\",\"caso\":\"info\",\"commit\":\"${commit}\",\"maquina\":\"${maquina}\",\"nucleos\":${nucleos},\"data\":\"${data}\"}\n")
+foreach(bench ${BENCHES})
+    message(STATUS "${bench}")
+    execute_process(COMMAND ${DIR}/${bench}
+        WORKING_DIRECTORY ${DIR}
+        OUTPUT_VARIABLE saida
+        RESULT_VARIABLE resultado)
+    if(NOT resultado EQUAL 0)
+        message(FATAL_ERROR "${bench} falhou (${resultado})")
+    endif()
+    file(APPEND ${SAIDA} "${saida}")
+endforeach()
+message(STATUS "Resultados em ${SAIDA}")
@@ -0,0 +1,116 @@
+/*
+ * API C das regras do jogo (biblioteca bomberman / bomberman_core)
+ *
+ * Para ferramentas de fora (C, Python via ctypes, ...) criarem e simularem
+ * partidas sem janela nem processo separado. Só tipos C e ponteiros opacos
+ * atravessam a fronteira, então a ABI não muda quando as estruturas internas
+ * mudam; BOMBERMAN_ABI_VERSAO só sobe quando uma função mudar de assinatura
+ * ou de significado.
+ *
+ * Cada partida pode ser usada por uma thread de cada vez; partidas diferentes
+ * podem rodar ao mesmo tempo em threads diferentes. As densidades do gerador
+ * de mapas são as padrão do jogo.
+ */
+#ifndef BOMBERMAN_H
+#define BOMBERMAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(BOMBERMAN_EXPORTA)
+#    define BOMBERMAN_API __declspec(dllexport)
+#  elif defined(BOMBERMAN_DLL)
+#    define BOMBERMAN_API __declspec(dllimport)
+#  else
+#    define BOMBERMAN_API
+#  endif
+#else
+#  define BOMBERMAN_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOMBERMAN_ABI_VERSAO 1
+
+typedef struct BombermanJogo BombermanJogo;
+typedef struct BombermanFoto BombermanFoto;
+
+typedef struct BombermanConfig {
+    int largura, altura; /* em células; fora de [7, 4096] é ajustado */
+    int inimigos;
+    int jogadores;       /* 1 a 64; o 0 nasce em (1, 1) */
+    uint64_t semente;    /* a partida só depende dela */
+} BombermanConfig;
+
+/* Ações (as mesmas do jogo) */
+enum {
+    BOMBERMAN_NENHUMA = 0,
+    BOMBERMAN_CIMA,      /* z - 1 */
+    BOMBERMAN_BAIXO,     /* z + 1 */
+    BOMBERMAN_ESQUERDA,  /* x - 1 */
+    BOMBERMAN_DIREITA,   /* x + 1 */
+    BOMBERMAN_BOMBA
+};
+
+enum { BOMBERMAN_ERRO = -1, BOMBERMAN_JOGANDO = 0, BOMBERMAN_VITORIA, BOMBERMAN_DERROTA };
+enum { BOMBERMAN_VAZIA = 0, BOMBERMAN_PAREDE, BOMBERMAN_BLOCO };
+
+typedef struct BombermanBomba {
+    int x, z;
+    int ticks;      /* até explodir (com as cadeias); 0 se já explodiu */
+    int explosao;   /* ticks que a explosão ainda dura; 0 se armada */
+    int dono;       /* jogador que plantou, -1 = inimigo */
+} BombermanBomba;
+
+BOMBERMAN_API int bomberman_abi_version(void);
+
+/* NULL se a configuração for inválida ou faltar memória */
+BOMBERMAN_API BombermanJogo* bomberman_create(const BombermanConfig* cfg);
+BOMBERMAN_API void bomberman_destroy(BombermanJogo* jogo);
+/* Partida nova com outra semente; 0 se nem todos os inimigos couberam ou se
+   faltar memória (aí a partida só volta a valer depois de um reset que dê certo) */
+BOMBERMAN_API int bomberman_reset(BombermanJogo* jogo, uint64_t semente);
+
+/* Uma ação por jogador (NULL = nenhuma) e um tick das regras; retorna o estado
+   (BOMBERMAN_JOGANDO, _VITORIA ou _DERROTA). Partida terminada não avança.
+   BOMBERMAN_ERRO se faltar memória no meio do tick (a partida fica inválida
+   até um bomberman_reset() ou bomberman_restore()). */
+BOMBERMAN_API int bomberman_step(BombermanJogo* jogo, const uint8_t* acoes);
+BOMBERMAN_API int bomberman_status(const BombermanJogo* jogo);
+BOMBERMAN_API int bomberman_tick(const BombermanJogo* jogo);
+
+/* Consultas */
+BOMBERMAN_API void bomberman_size(const BombermanJogo* jogo, int* largura, int* altura);
+BOMBERMAN_API int bomberman_cell(const BombermanJogo* jogo, int x, int z); /* -1 fora do mapa */
+/* Tipos de todas as células, linha a linha (z crescente); retorna largura * altura */
+BOMBERMAN_API size_t bomberman_cells(const BombermanJogo* jogo, uint8_t* saida, size_t capacidade);
+BOMBERMAN_API int bomberman_player_count(const BombermanJogo* jogo);
+/* 1 vivo, 0 morto, -1 índice inválido */
+BOMBERMAN_API int bomberman_player(const BombermanJogo* jogo, int j, int* x, int* z);
+/* Posições (x, z) intercaladas em xz; retorna o número de inimigos vivos */
+BOMBERMAN_API int bomberman_enemies(const BombermanJogo* jogo, int* xz, int capacidade);
+/* Retorna o número de bombas armadas ou explodindo */
+BOMBERMAN_API int bomberman_bombs(const BombermanJogo* jogo, BombermanBomba* saida, int capacidade);
+/* Planos de observação do jogador j (ver env.h); retorna o tamanho deles, e
+   só escreve se couberem */
+BOMBERMAN_API size_t bomberman_planes(BombermanJogo* jogo, int j, uint8_t* saida, size_t capacidade);
+BOMBERMAN_API uint64_t bomberman_checksum(BombermanJogo* jogo);
+
+/* Fotos para voltar no tempo: bomberman_snapshot() cria uma foto (foto NULL)
+   ou reaproveita a dada, e bomberman_restore() põe o estado da foto na
+   partida. Restaurar em outra partida a transforma numa cópia da original
+   (clonar para uma busca, por exemplo). Se faltar memória, bomberman_snapshot()
+   retorna NULL (a foto dada fica vazia) e bomberman_restore() retorna 0, como
+   para uma foto NULL ou vazia. Nenhuma função deixa escapar exceções do C++. */
+BOMBERMAN_API BombermanFoto* bomberman_snapshot(BombermanJogo* jogo, BombermanFoto* foto);
+BOMBERMAN_API int bomberman_restore(BombermanJogo* jogo, BombermanFoto* foto);
+BOMBERMAN_API void bomberman_snapshot_destroy(BombermanFoto* foto);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * API C das regras do jogo (ver bomberman.h)
+ *
+ * Cada BombermanJogo guarda a partida num EstadoPartida. As funções que rodam
+ * regras trocam a partida com a da thread que chamou (swapMatch(), O(1)),
+ * trabalham e trocam de volta; as consultas leem o EstadoPartida direto.
+ *
+ * Nenhuma exceção atravessa a API C: as funções que alocam (mapa, entidades,
+ * fotos) pegam std::bad_alloc e qualquer outra e retornam NULL, 0 ou -1.
+ */
+#include "bomberman.h"
+#include "env.h"
+#include "game.h"
+#include <algorithm>
+#include <new>
+using namespace std;
+
+struct BombermanJogo {
+    EstadoPartida estado;
+    int inimigos;
+};
+
+struct BombermanFoto {
+    GameState estado;
+};
+
+namespace {
+
+// A partida do jogo na thread atual enquanto o objeto existir
+struct NaThread {
+    BombermanJogo* jogo;
+    explicit NaThread(BombermanJogo* j) : jogo(j) { swapMatch(jogo->estado); }
+    ~NaThread() { swapMatch(jogo->estado); }
+};
+
+int statusOf(const EstadoPartida& e) {
+    if (e.player_won) return BOMBERMAN_VITORIA;
+    for (size_t j = 0; j < e.jogadores.size(); j++)
+        if (e.jogadores[j].ativo && e.jogadores[j].vivo) return BOMBERMAN_JOGANDO;
+    return BOMBERMAN_DERROTA;
+}
+
+}
+
+extern "C" {
+
+int bomberman_abi_version(void) {
+    return BOMBERMAN_ABI_VERSAO;
+}
+
+BombermanJogo* bomberman_create(const BombermanConfig* cfg) {
+    if (!cfg || cfg->jogadores < 1 || cfg->jogadores > 64 || cfg->inimigos < 0) return 0;
+    BombermanJogo* jogo = new (nothrow) BombermanJogo();
+    if (!jogo) return 0;
+    jogo->inimigos = cfg->inimigos;
+    try {
+        NaThread na_thread(jogo);
+        setMapSize(cfg->largura, cfg->altura);
+        jogadores.assign(cfg->jogadores, Jogador());
+        tick_atual = 0;
+        initMap(cfg->semente, jogo->inimigos);
+    } catch (...) {
+        delete jogo;
+        return 0;
+    }
+    return jogo;
+}
+
+void bomberman_destroy(BombermanJogo* jogo) {
+    delete jogo;
+}
+
+int bomberman_reset(BombermanJogo* jogo, uint64_t semente) {
+    try {
+        NaThread na_thread(jogo);
+        for (size_t j = 0; j < jogadores.size(); j++) jogadores[j].ativo = true;
+        tick_atual = 0;
+        return initMap(semente, jogo->inimigos) ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+int bomberman_step(BombermanJogo* jogo, const uint8_t* acoes) {
+    if (statusOf(jogo->estado) != BOMBERMAN_JOGANDO) return statusOf(jogo->estado);
+    try {
+        NaThread na_thread(jogo);
+        if (acoes) {
+            for (size_t j = 0; j < jogadores.size(); j++)
+                if (acoes[j] > ACAO_NENHUMA && acoes[j] < NUM_ACOES) applyAction((int)j, acoes[j]);
+        }
+        stepGame();
+    } catch (...) {
+        return BOMBERMAN_ERRO;
+    }
+    return statusOf(jogo->estado);
+}
+
+int bomberman_status(const BombermanJogo* jogo) {
+    return statusOf(jogo->estado);
+}
+
+int bomberman_tick(const BombermanJogo* jogo) {
+    return jogo->estado.tick_atual;
+}
+
+void bomberman_size(const BombermanJogo* jogo, int* largura, int* altura) {
+    if (largura) *largura = jogo->estado.mapa.largura;
+    if (altura) *altura = jogo->estado.mapa.altura;
+}
+
+int bomberman_cell(const BombermanJogo* jogo, int x, int z) {
+    const Mapa& mapa = jogo->estado.mapa;
+    if (x < 0 || z < 0 || x >= mapa.largura || z >= mapa.altura) return -1;
+    return mapa.at(x, z);
+}
+
+size_t bomberman_cells(const BombermanJogo* jogo, uint8_t* saida, size_t capacidade) {
+    const Mapa& mapa = jogo->estado.mapa;
+    size_t area = (size_t)mapa.largura * mapa.altura;
+    if (!saida || capacidade < area) return area;
+    // Cada linha de um bloco de 16x16 é contígua no Mapa
+    for (int z = 0; z < mapa.altura; z++) {
+        for (int x0 = 0; x0 < mapa.largura; x0 += MAPA_TILE) {
+            const uint8_t* linha = &mapa.celulas[mapa.index(x0, z)];
+            copy(linha, linha + min(MAPA_TILE, mapa.largura - x0), saida + (size_t)z * mapa.largura + x0);
+        }
+    }
+    return area;
+}
+
+int bomberman_player_count(const BombermanJogo* jogo) {
+    return (int)jogo->estado.jogadores.size();
+}
+
+int bomberman_player(const BombermanJogo* jogo, int j, int* x, int* z) {
+    const vector<Jogador>& jogadores = jogo->estado.jogadores;
+    if (j < 0 || j >= (int)jogadores.size()) return -1;
+    if (x) *x = jogadores[j].x;
+    if (z) *z = jogadores[j].z;
+    return jogadores[j].ativo && jogadores[j].vivo ? 1 : 0;
+}
+
+int bomberman_enemies(const BombermanJogo* jogo, int* xz, int capacidade) {
+    const Inimigos& inimigos = jogo->estado.inimigos;
+    int n = (int)inimigos.size();
+    for (int i = 0; i < n && i < capacidade && xz; i++) {
+        xz[2 * i] = inimigos.x[i];
+        xz[2 * i + 1] = inimigos.z[i];
+    }
+    return n;
+}
+
+int bomberman_bombs(const BombermanJogo* jogo, BombermanBomba* saida, int capacidade) {
+    const EstadoPartida& e = jogo->estado;
+    int n = (int)e.bombas.size();
+    for (int b = 0; b < n && b < capacidade && saida; b++) {
+        const Bomba& bomba = e.bombas[b];
+        BombermanBomba& s = saida[b];
+        s.x = bomba.x;
+        s.z = bomba.z;
+        int detona = e.detonacao[e.mapa.index(bomba.x, bomba.z)];
+        s.ticks = bomba.explodiu || detona == SEM_PERIGO ? 0 : max(detona - e.tick_atual, 1);
+        s.explosao = bomba.explodiu ? bomba.frame_explosao : 0;
+        s.dono = bomba.dono;
+    }
+    return n;
+}
+
+size_t bomberman_planes(BombermanJogo* jogo, int j, uint8_t* saida, size_t capacidade) {
+    size_t tamanho = (size_t)NUM_PLANOS * jogo->estado.mapa.largura * jogo->estado.mapa.altura;
+    if (!saida || capacidade < tamanho) return tamanho;
+    NaThread na_thread(jogo);
+    writePlanes(j, saida);
+    return tamanho;
+}
+
+uint64_t bomberman_checksum(BombermanJogo* jogo) {
+    NaThread na_thread(jogo);
+    return stateChecksum();
+}
+
+BombermanFoto* bomberman_snapshot(BombermanJogo* jogo, BombermanFoto* foto) {
+    BombermanFoto* nova = foto ? 0 : new (nothrow) BombermanFoto();
+    if (!foto && !nova) return 0;
+    if (nova) foto = nova;
+    try {
+        NaThread na_thread(jogo);
+        snapshot(foto->estado);
+    } catch (...) {
+        // Cópia pela metade: a foto fica vazia (bomberman_restore() a recusa)
+        foto->estado = GameState();
+        delete nova;
+        return 0;
+    }
+    return foto;
+}
+
+int bomberman_restore(BombermanJogo* jogo, BombermanFoto* foto) {
+    if (!foto || foto->estado.largura == 0) return 0;
+    try {
+        NaThread na_thread(jogo);
+        restore(foto->estado);
+    } catch (...) {
+        return 0;
+    }
+    return 1;
+}
+
+void bomberman_snapshot_destroy(BombermanFoto* foto) {
+    delete foto;
+}
+
+}
@@ -0,0 +1,350 @@
+/*
+ * Estados da partida comprimidos por diferença (ver delta.h)
+ */
+#include "delta.h"
+#include "net.h"
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+static const size_t BYTES_CABECALHO = 4 + 4 + 4 + 4 + 2 + 2 + 1;
+static const size_t CELULAS_POR_TILE = MAPA_TILE * MAPA_TILE;
+
+// Bits para guardar qualquer coordenada do mapa
+static int coordBits(int largura, int altura) {
+    int maior = max(largura, altura) - 1, n = 1;
+    while ((maior >> n) != 0) n++;
+    return n;
+}
+
+static inline int32_t packPos(int x, int z) { return x | (z << 16); }
+
+HistoricoDelta::HistoricoDelta() : ultimo(0), relogio(0) {}
+
+void HistoricoDelta::record(uint32_t seq) {
+    QuadroDelta& q = quadros[seq % JANELA_DELTA];
+    q.seq = seq;
+    q.partida = currentMatch();
+    q.largura = gameMap.largura;
+    q.altura = gameMap.altura;
+    q.tick = tick_atual;
+    q.player_won = player_won;
+    q.jogadores = jogadores;
+    q.bombas = bombas;
+    q.celulas_alteradas.clear();
+
+    q.inimigos.clear();
+    for (size_t i = 0; i < inimigos.size(); i++) {
+        uint32_t id = inimigos.id[i];
+        if (id >= q.inimigos.size()) q.inimigos.resize(id + 1, -1);
+        q.inimigos[id] = packPos(inimigos.x[i], inimigos.z[i]);
+    }
+
+    // Células alteradas desde o quadro anterior: só os blocos com revisão nova
+    // são comparados com o espelho. Partida nova ou mapa de outro tamanho não
+    // entram no diário (nenhum quadro anterior serve de base).
+    const QuadroDelta& anterior = quadros[(seq - 1) % JANELA_DELTA];
+    bool continua = ultimo != 0 && anterior.seq == seq - 1 && anterior.partida == q.partida &&
+                    espelho.size() == gameMap.celulas.size();
+    if (!continua) {
+        espelho = gameMap.celulas;
+        revisao = gameMap.revisao;
+        marcada.assign(gameMap.celulas.size(), 0);
+    } else if (relogio != gameMap.relogio) {
+        for (size_t t = 0; t < revisao.size(); t++) {
+            if (revisao[t] == gameMap.revisao[t]) continue;
+            revisao[t] = gameMap.revisao[t];
+            const uint8_t* atual = &gameMap.celulas[t * CELULAS_POR_TILE];
+            uint8_t* antes = &espelho[t * CELULAS_POR_TILE];
+            for (size_t c = 0; c < CELULAS_POR_TILE; c++) {
+                if (atual[c] == antes[c]) continue;
+                antes[c] = atual[c];
+                q.celulas_alteradas.push_back((uint32_t)(t * CELULAS_POR_TILE + c));
+            }
+        }
+    }
+    relogio = gameMap.relogio;
+    ultimo = seq;
+}
+
+bool HistoricoDelta::isBaseline(uint32_t base) const {
+    if (base == 0 || ultimo == 0 || base == ultimo || ultimo - base >= (uint32_t)JANELA_DELTA) return false;
+    const QuadroDelta& b = quadros[base % JANELA_DELTA];
+    const QuadroDelta& atual = quadros[ultimo % JANELA_DELTA];
+    if (b.seq != base || b.partida != atual.partida || b.largura != atual.largura || b.altura != atual.altura)
+        return false;
+    // O diário precisa estar inteiro entre a base e o quadro atual
+    for (uint32_t s = base + 1; s != ultimo; s++)
+        if (quadros[s % JANELA_DELTA].seq != s || quadros[s % JANELA_DELTA].partida != atual.partida) return false;
+    return true;
+}
+
+static void writeBytes(vector<uint8_t>& saida, uint32_t v, int n) {
+    for (int i = 0; i < n; i++) saida.push_back((uint8_t)(v >> (8 * i)));
+}
+
+uint32_t HistoricoDelta::encode(uint32_t base, vector<uint8_t>& saida) {
+    const QuadroDelta& q = quadros[ultimo % JANELA_DELTA];
+    if (!isBaseline(base)) base = 0;
+    const QuadroDelta* b = base ? &quadros[base % JANELA_DELTA] : 0;
+    const int bits_coord = coordBits(q.largura, q.altura);
+
+    saida.clear();
+    writeBytes(saida, q.seq, 4);
+    writeBytes(saida, base, 4);
+    writeBytes(saida, q.partida, 4);
+    writeBytes(saida, (uint32_t)q.tick, 4);
+    writeBytes(saida, (uint32_t)q.largura, 2);
+    writeBytes(saida, (uint32_t)q.altura, 2);
+    writeBytes(saida, q.player_won ? 1 : 0, 1);
+    EscritorBits e(saida);
+
+    // Jogadores: os que já existiam na base mandam só um bit se nada mudou
+    e.golomb((uint32_t)q.jogadores.size());
+    for (size_t j = 0; j < q.jogadores.size(); j++) {
+        const Jogador& p = q.jogadores[j];
+        uint32_t flags = (p.ativo ? 1 : 0) | (p.vivo ? 2 : 0);
+        if (b && j < b->jogadores.size()) {
+            const Jogador& a = b->jogadores[j];
+            bool mudou = p.x != a.x || p.z != a.z || p.ativo != a.ativo || p.vivo != a.vivo;
+            e.bits(mudou, 1);
+            if (!mudou) continue;
+            e.bits(flags, 2);
+            e.golombSinal(p.x - a.x);
+            e.golombSinal(p.z - a.z);
+        } else {
+            e.bits(flags, 2);
+            e.bits((uint32_t)p.x, bits_coord);
+            e.bits((uint32_t)p.z, bits_coord);
+        }
+    }
+
+    // Bombas: poucas e o timer muda todo tick, então vão sempre inteiras
+    e.golomb((uint32_t)q.bombas.size());
+    for (size_t i = 0; i < q.bombas.size(); i++) {
+        const Bomba& bomba = q.bombas[i];
+        e.bits((uint32_t)bomba.x, bits_coord);
+        e.bits((uint32_t)bomba.z, bits_coord);
+        e.bits((uint32_t)min(max(bomba.timer, 0), 7), 3);
+        e.bits((uint32_t)min(max(bomba.frame_explosao, 0), 7), 3);
+        e.bits(bomba.explodiu, 1);
+        e.bits(bomba.dono == DONO_INIMIGO, 1);
+        if (bomba.dono != DONO_INIMIGO) e.golomb((uint32_t)bomba.dono);
+    }
+
+    // Inimigos por id. Completo: um bit de presença por id e a posição. Com
+    // base: só os ids que mudaram (distância até o anterior), com o movimento
+    // em diferença, a posição de quem apareceu ou só o bit de quem morreu.
+    e.golomb((uint32_t)q.inimigos.size());
+    if (!b) {
+        for (size_t id = 0; id < q.inimigos.size(); id++) {
+            int32_t p = q.inimigos[id];
+            e.bits(p >= 0, 1);
+            if (p < 0) continue;
+            e.bits((uint32_t)(p & 0xFFFF), bits_coord);
+            e.bits((uint32_t)(p >> 16), bits_coord);
+        }
+    } else {
+        alteradas.clear();
+        size_t n = max(q.inimigos.size(), b->inimigos.size());
+        for (size_t id = 0; id < n; id++) {
+            int32_t agora = id < q.inimigos.size() ? q.inimigos[id] : -1;
+            int32_t antes = id < b->inimigos.size() ? b->inimigos[id] : -1;
+            if (agora != antes) alteradas.push_back((uint32_t)id);
+        }
+        e.golomb((uint32_t)alteradas.size());
+        uint32_t anterior = 0;
+        for (size_t k = 0; k < alteradas.size(); k++) {
+            uint32_t id = alteradas[k];
+            e.golomb(id - anterior);
+            anterior = id + 1;
+            int32_t agora = id < q.inimigos.size() ? q.inimigos[id] : -1;
+            int32_t antes = id < b->inimigos.size() ? b->inimigos[id] : -1;
+            if (antes >= 0) {
+                e.bits(agora >= 0, 1);
+                if (agora < 0) continue;
+                e.golombSinal((agora & 0xFFFF) - (antes & 0xFFFF));
+                e.golombSinal((agora >> 16) - (antes >> 16));
+            } else {
+                e.bits((uint32_t)(agora & 0xFFFF), bits_coord);
+                e.bits((uint32_t)(agora >> 16), bits_coord);
+            }
+        }
+    }
+
+    // Mapa: 2 bits por célula, todas (completo, 4 por byte a partir do
+    // próximo byte inteiro) ou só as alteradas desde a base
+    if (!b) {
+        e.flush();
+        const uint8_t* c = &gameMap.celulas[0];
+        for (size_t i = 0; i < gameMap.celulas.size(); i += 4)
+            saida.push_back((uint8_t)(c[i] | (c[i + 1] << 2) | (c[i + 2] << 4) | (c[i + 3] << 6)));
+    } else {
+        alteradas.clear();
+        for (uint32_t s = base + 1; s != ultimo + 1; s++) {
+            const vector<uint32_t>& diario = quadros[s % JANELA_DELTA].celulas_alteradas;
+            for (size_t k = 0; k < diario.size(); k++) {
+                if (marcada[diario[k]]) continue;
+                marcada[diario[k]] = 1;
+                alteradas.push_back(diario[k]);
+            }
+        }
+        sort(alteradas.begin(), alteradas.end());
+        e.golomb((uint32_t)alteradas.size());
+        uint32_t anterior = 0;
+        for (size_t k = 0; k < alteradas.size(); k++) {
+            e.golomb(alteradas[k] - anterior);
+            anterior = alteradas[k] + 1;
+            e.bits(gameMap.celulas[alteradas[k]], 2);
+            marcada[alteradas[k]] = 0;
+        }
+    }
+    e.flush();
+    return base;
+}
+
+bool peekDelta(const uint8_t* dados, size_t n, CabecalhoDelta& cab) {
+    if (n < BYTES_CABECALHO) return false;
+    Leitor l(dados, n);
+    cab.seq = l.u32();
+    cab.base = l.u32();
+    cab.partida = l.u32();
+    cab.tick = (int)l.u32();
+    cab.largura = l.u16();
+    cab.altura = l.u16();
+    cab.player_won = (l.u8() & 1) != 0;
+    return cab.seq != 0 && cab.largura >= MAP_SIZE_MIN && cab.altura >= MAP_SIZE_MIN &&
+           cab.largura <= MAP_SIZE_MAX && cab.altura <= MAP_SIZE_MAX;
+}
+
+bool decodeDelta(const uint8_t* dados, size_t n, HistoricoCliente& historico, Mapa& mapa, const QuadroDelta*& saida) {
+    CabecalhoDelta cab;
+    if (!peekDelta(dados, n, cab) || cab.largura != mapa.largura || cab.altura != mapa.altura) return false;
+    const QuadroDelta* b = 0;
+    if (cab.base) {
+        b = &historico.quadros[cab.base % JANELA_DELTA];
+        if (b->seq != cab.base || b->partida != cab.partida) return false;
+    }
+    // O quadro novo não pode ocupar a vaga da própria base
+    if (cab.base && cab.seq % JANELA_DELTA == cab.base % JANELA_DELTA) return false;
+
+    QuadroDelta& q = historico.quadros[cab.seq % JANELA_DELTA];
+    q.seq = 0; // inválido até terminar
+    q.partida = cab.partida;
+    q.largura = cab.largura;
+    q.altura = cab.altura;
+    q.tick = cab.tick;
+    q.player_won = cab.player_won;
+    const int bits_coord = coordBits(cab.largura, cab.altura);
+    LeitorBits l(dados + BYTES_CABECALHO, n - BYTES_CABECALHO);
+
+    uint32_t n_jogadores = l.golomb();
+    if (n_jogadores > 0xFFFF) return false;
+    q.jogadores.resize(n_jogadores);
+    for (size_t j = 0; j < n_jogadores && !l.erro; j++) {
+        Jogador& p = q.jogadores[j];
+        uint32_t flags;
+        if (b && j < b->jogadores.size()) {
+            p = b->jogadores[j];
+            if (!l.bits(1)) continue;
+            flags = l.bits(2);
+            p.x += l.golombSinal();
+            p.z += l.golombSinal();
+        } else {
+            flags = l.bits(2);
+            p.x = (int)l.bits(bits_coord);
+            p.z = (int)l.bits(bits_coord);
+        }
+        p.ativo = (flags & 1) != 0;
+        p.vivo = (flags & 2) != 0;
+        if (p.x < 0 || p.z < 0 || p.x >= cab.largura || p.z >= cab.altura) l.erro = true;
+    }
+
+    uint32_t n_bombas = l.golomb();
+    if (n_bombas > (uint32_t)cab.largura * cab.altura) return false;
+    q.bombas.resize(n_bombas);
+    for (size_t i = 0; i < n_bombas && !l.erro; i++) {
+        Bomba& bomba = q.bombas[i];
+        bomba.x = (int)l.bits(bits_coord);
+        bomba.z = (int)l.bits(bits_coord);
+        bomba.timer = (int)l.bits(3);
+        bomba.frame_explosao = (int)l.bits(3);
+        bomba.explodiu = l.bits(1) != 0;
+        bomba.dono = l.bits(1) ? DONO_INIMIGO : (int)l.golomb();
+        if (bomba.x >= cab.largura || bomba.z >= cab.altura) l.erro = true;
+    }
+
+    uint32_t n_ids = l.golomb();
+    if (n_ids > (uint32_t)cab.largura * cab.altura) return false;
+    if (!b) {
+        q.inimigos.assign(n_ids, -1);
+        for (size_t id = 0; id < n_ids && !l.erro; id++) {
+            if (!l.bits(1)) continue;
+            int x = (int)l.bits(bits_coord), z = (int)l.bits(bits_coord);
+            q.inimigos[id] = packPos(x, z);
+        }
+    } else {
+        q.inimigos = b->inimigos;
+        q.inimigos.resize(n_ids, -1);
+        uint32_t n_alterados = l.golomb(), id = 0;
+        for (uint32_t k = 0; k < n_alterados && !l.erro; k++) {
+            id += l.golomb();
+            if (id >= n_ids && !(id < b->inimigos.size() && b->inimigos[id] >= 0)) { l.erro = true; break; }
+            int32_t antes = id < b->inimigos.size() ? b->inimigos[id] : -1;
+            int32_t agora = -1;
+            if (antes >= 0) {
+                if (l.bits(1)) {
+                    int64_t x = (antes & 0xFFFF) + (int64_t)l.golombSinal();
+                    int64_t z = (antes >> 16) + (int64_t)l.golombSinal();
+                    // Fora do mapa o packPos() daria negativo ou invadiria o z
+                    if (x < 0 || z < 0 || x >= cab.largura || z >= cab.altura) { l.erro = true; break; }
+                    agora = packPos((int)x, (int)z);
+                }
+            } else {
+                int x = (int)l.bits(bits_coord), z = (int)l.bits(bits_coord);
+                agora = packPos(x, z);
+            }
+            if (id < n_ids) q.inimigos[id] = agora;
+            id++;
+        }
+    }
+    for (size_t id = 0; id < q.inimigos.size(); id++) {
+        int32_t p = q.inimigos[id];
+        if (p >= 0 && ((p & 0xFFFF) >= cab.largura || (p >> 16) >= cab.altura)) l.erro = true;
+    }
+    if (l.erro) return false;
+
+    // Mapa: o completo é escrito direto nas células; as diferenças por set()
+    if (!b) {
+        l.align();
+        const size_t n_bytes = mapa.celulas.size() / 4;
+        if (l.tam - l.pos < n_bytes) return false;
+        const uint8_t* p = l.dados + l.pos;
+        for (size_t i = 0; i < n_bytes; i++) {
+            mapa.celulas[4 * i] = p[i] & 3;
+            mapa.celulas[4 * i + 1] = (p[i] >> 2) & 3;
+            mapa.celulas[4 * i + 2] = (p[i] >> 4) & 3;
+            mapa.celulas[4 * i + 3] = p[i] >> 6;
+        }
+        mapa.touchAll();
+    } else {
+        uint32_t n_celulas = l.golomb(), c = 0;
+        if (n_celulas > mapa.celulas.size()) return false;
+        for (uint32_t k = 0; k < n_celulas && !l.erro; k++) {
+            c += l.golomb();
+            uint8_t tipo = (uint8_t)l.bits(2);
+            if (c >= mapa.celulas.size()) { l.erro = true; break; }
+            // set() recebe (x, z): o índice em blocos é desfeito aqui
+            size_t tile = c >> (2 * MAPA_TILE_BITS);
+            int x = (int)(tile % mapa.tiles_x) * MAPA_TILE + (int)(c & (MAPA_TILE - 1));
+            int z = (int)(tile / mapa.tiles_x) * MAPA_TILE + (int)((c >> MAPA_TILE_BITS) & (MAPA_TILE - 1));
+            if (mapa.celulas[c] != tipo) mapa.set(x, z, tipo);
+            c++;
+        }
+    }
+    if (l.erro) return false;
+
+    q.seq = cab.seq;
+    saida = &q;
+    return true;
+}
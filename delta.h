@@ -0,0 +1,158 @@
+/*
+ * Estados da partida comprimidos por diferença (delta) para a rede e gravações
+ *
+ * O servidor guarda um quadro por estado enviado: as entidades e as células do
+ * mapa que mudaram desde o quadro anterior. Cada estado é codificado contra a
+ * base que o cliente confirmou (um quadro antigo que ele com certeza tem):
+ * só vão os jogadores e inimigos que mudaram, com posições em diferença, e as
+ * células alteradas desde a base. Tudo é empacotado em bits: coordenadas com o
+ * mínimo de bits para o tamanho do mapa, contagens e diferenças em Exp-Golomb
+ * (valores pequenos ocupam poucos bits) e 2 bits por célula.
+ *
+ * Sem base válida (cliente novo, base antiga demais ou partida nova), o estado
+ * vai completo: entidades absolutas e o mapa inteiro a 2 bits por célula.
+ */
+#ifndef DELTA_H
+#define DELTA_H
+
+#include "game.h"
+#include <vector>
+
+// Escrita de bits (do menos para o mais significativo) num vetor que cresce
+struct EscritorBits {
+    std::vector<uint8_t>* dados;
+    uint64_t acumulado;
+    int n_bits;
+
+    explicit EscritorBits(std::vector<uint8_t>& saida) : dados(&saida), acumulado(0), n_bits(0) {}
+
+    void bits(uint32_t v, int n) {
+        acumulado |= (uint64_t)v << n_bits;
+        n_bits += n;
+        while (n_bits >= 8) {
+            dados->push_back((uint8_t)acumulado);
+            acumulado >>= 8;
+            n_bits -= 8;
+        }
+    }
+    // Exp-Golomb de ordem 0: v = 0 ocupa 1 bit, 1..2 ocupam 3, 3..6 ocupam 5...
+    // (zeros, um bit 1 e os bits de v + 1 abaixo do mais alto)
+    void golomb(uint32_t v) {
+        uint64_t w = (uint64_t)v + 1;
+        int tamanho = 0;
+        while ((w >> tamanho) > 1) tamanho++;
+        bits(0, tamanho);
+        bits(1, 1);
+        bits((uint32_t)(w & ((1ULL << tamanho) - 1)), tamanho);
+    }
+    void golombSinal(int v) { golomb(v >= 0 ? 2u * (uint32_t)v : 2u * (uint32_t)(-v) - 1); }
+    void flush() {
+        if (n_bits > 0) dados->push_back((uint8_t)acumulado);
+        acumulado = 0;
+        n_bits = 0;
+    }
+};
+
+struct LeitorBits {
+    const uint8_t* dados;
+    size_t tam, pos;
+    uint64_t acumulado;
+    int n_bits;
+    bool erro;
+
+    LeitorBits(const uint8_t* buf, size_t n) : dados(buf), tam(n), pos(0), acumulado(0), n_bits(0), erro(false) {}
+
+    uint32_t bits(int n) {
+        while (n_bits < n) {
+            if (pos >= tam) { erro = true; return 0; }
+            acumulado |= (uint64_t)dados[pos++] << n_bits;
+            n_bits += 8;
+        }
+        uint32_t v = (uint32_t)(acumulado & ((1ULL << n) - 1));
+        acumulado >>= n;
+        n_bits -= n;
+        return v;
+    }
+    uint32_t golomb() {
+        int tamanho = 0;
+        while (bits(1) == 0) {
+            if (erro || ++tamanho > 32) { erro = true; return 0; }
+        }
+        uint64_t w = (1ULL << tamanho) | bits(tamanho);
+        return (uint32_t)(w - 1);
+    }
+    int golombSinal() {
+        uint32_t v = golomb();
+        return (v & 1) ? -(int)((v + 1) >> 1) : (int)(v >> 1);
+    }
+    // Descarta o resto do byte atual (par de EscritorBits::flush())
+    void align() {
+        acumulado = 0;
+        n_bits = 0;
+    }
+};
+
+// Um estado da partida como o cliente o vê (sem o mapa, que fica num Mapa à parte)
+struct QuadroDelta {
+    uint32_t seq;     // 0 = vazio
+    uint32_t partida; // quadros de partidas diferentes não servem de base um para o outro
+    int largura, altura;
+    int tick;
+    bool player_won;
+    std::vector<Jogador> jogadores;
+    std::vector<Bomba> bombas;
+    std::vector<int32_t> inimigos; // posição (x | z << 16) de cada id, -1 se o inimigo não existe
+    std::vector<uint32_t> celulas_alteradas; // só no servidor: índices (Mapa::index) desde o quadro anterior
+
+    QuadroDelta() : seq(0), partida(0), largura(0), altura(0), tick(0), player_won(false) {}
+};
+
+const int JANELA_DELTA = 64; // quadros guardados (bases aceitas até 64 estados atrás)
+
+// Lado do servidor: histórico de quadros e codificação contra uma base
+class HistoricoDelta {
+public:
+    HistoricoDelta();
+
+    // Grava o estado atual da partida (globais de game.h) como o quadro 'seq'
+    void record(uint32_t seq);
+    // true se 'seq' ainda pode ser base do quadro mais novo
+    bool isBaseline(uint32_t seq) const;
+    // Codifica o quadro mais novo (o estado atual, então chame logo depois de
+    // record()) contra 'base'; base inválida ou 0 gera o estado completo.
+    // Retorna a base usada (0 = completo).
+    uint32_t encode(uint32_t base, std::vector<uint8_t>& saida);
+
+private:
+    QuadroDelta quadros[JANELA_DELTA];
+    uint32_t ultimo;
+    std::vector<uint8_t> espelho;   // mapa como estava no último quadro
+    std::vector<uint32_t> revisao;  // revisão de cada bloco no espelho
+    uint32_t relogio;
+    std::vector<uint8_t> marcada;   // células já incluídas na codificação atual
+    std::vector<uint32_t> alteradas;
+};
+
+// Lado do cliente: quadros recebidos (bases possíveis) e o mapa reconstruído.
+// decodeDelta() aplica as células em 'mapa' com Mapa::set() (as revisões dos
+// blocos mudam, como no jogo local) e preenche 'saida' com as entidades.
+struct HistoricoCliente {
+    QuadroDelta quadros[JANELA_DELTA];
+};
+
+// Cabeçalho (alinhado em bytes) de um estado codificado
+struct CabecalhoDelta {
+    uint32_t seq, base, partida;
+    int tick;
+    int largura, altura;
+    bool player_won;
+};
+
+bool peekDelta(const uint8_t* dados, size_t n, CabecalhoDelta& cab);
+
+// Falha se a base não está no histórico ou se o mapa tem outro tamanho (o
+// chamador redimensiona antes, ver peekDelta). 'saida' aponta para o quadro
+// novo dentro do histórico.
+bool decodeDelta(const uint8_t* dados, size_t n, HistoricoCliente& historico, Mapa& mapa, const QuadroDelta*& saida);
+
+#endif
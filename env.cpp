@@ -0,0 +1,202 @@
+/*
+ * Lote de ambientes para treinar bots (ver env.h)
+ */
+#include "env.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+void writeObservation(int j, uint8_t* saida) {
+    const Mapa& gameMap = ::gameMap;
+    const vector<int>& perigo = ::perigo;
+    const vector<uint8_t>& bombas_na_celula = ::bombas_na_celula;
+    const int raio = LADO_OBSERVACAO / 2;
+    const int cx = jogadores[j].x, cz = jogadores[j].z;
+    for (int dz = -raio; dz <= raio; dz++) {
+        int z = cz + dz;
+        for (int dx = -raio; dx <= raio; dx++, saida++) {
+            int x = cx + dx;
+            if (x < 0 || z < 0 || x >= gameMap.largura || z >= gameMap.altura) {
+                *saida = OBS_FORA;
+                continue;
+            }
+            size_t c = gameMap.index(x, z);
+            uint8_t celula = gameMap.celulas[c];
+            if (celula == CELULA_PAREDE) *saida = OBS_PAREDE;
+            else if (celula == CELULA_BLOCO) *saida = OBS_BLOCO;
+            else if (enemyAt(x, z) >= 0) *saida = OBS_INIMIGO;
+            else if (bombas_na_celula[c] > 0) *saida = OBS_BOMBA;
+            else if (perigo[c] != SEM_PERIGO) *saida = OBS_PERIGO;
+            else *saida = OBS_VAZIA;
+        }
+    }
+}
+
+size_t planesSize() {
+    return (size_t)NUM_PLANOS * gameMap.largura * gameMap.altura;
+}
+
+static inline uint8_t ticksUntil(int tick, int agora) {
+    return tick == SEM_PERIGO ? 0 : (uint8_t)min(max(tick - agora, 1), 255);
+}
+
+void writePlanes(int j, uint8_t* saida) {
+    const Mapa& gameMap = ::gameMap;
+    const vector<int>& perigo = ::perigo;
+    const vector<int>& detonacao = ::detonacao;
+    const int largura = gameMap.largura, altura = gameMap.altura;
+    const size_t area = (size_t)largura * altura;
+    const int agora = tick_atual;
+    uint8_t* parede = saida + PLANO_PAREDE * area;
+    uint8_t* bloco = saida + PLANO_BLOCO * area;
+    uint8_t* perigo_plano = saida + PLANO_PERIGO * area;
+
+    // Grades: cada linha de um bloco de 16x16 é contígua no Mapa
+    for (int z = 0; z < altura; z++) {
+        for (int x0 = 0; x0 < largura; x0 += MAPA_TILE) {
+            const size_t c = gameMap.index(x0, z);
+            const uint8_t* celulas = &gameMap.celulas[c];
+            const int* p = &perigo[c];
+            const size_t o = (size_t)z * largura + x0;
+            const int n = min(MAPA_TILE, largura - x0);
+            for (int k = 0; k < n; k++) {
+                parede[o + k] = celulas[k] == CELULA_PAREDE;
+                bloco[o + k] = celulas[k] == CELULA_BLOCO;
+                perigo_plano[o + k] = ticksUntil(p[k], agora);
+            }
+        }
+    }
+
+    // Entidades: planos zerados e preenchidos só onde há alguma
+    memset(saida + PLANO_JOGADOR * area, 0, (PLANO_EXPLOSAO - PLANO_JOGADOR + 1) * area);
+    uint8_t* jogador = saida + PLANO_JOGADOR * area;
+    for (size_t k = 0; k < jogadores.size(); k++) {
+        const Jogador& p = jogadores[k];
+        if (p.ativo && p.vivo) jogador[(size_t)p.z * largura + p.x] = (int)k == j ? 1 : 2;
+    }
+
+    const Inimigos& inimigos = ::inimigos;
+    uint8_t* inimigo = saida + PLANO_INIMIGO * area;
+    for (size_t i = 0; i < inimigos.size(); i++) inimigo[(size_t)inimigos.z[i] * largura + inimigos.x[i]] = 1;
+
+    uint8_t* bomba = saida + PLANO_BOMBA * area;
+    uint8_t* explosao = saida + PLANO_EXPLOSAO * area;
+    const vector<Bomba>& bombas = ::bombas;
+    for (size_t b = 0; b < bombas.size(); b++) {
+        const Bomba& bb = bombas[b];
+        if (!bb.explodiu) {
+            bomba[(size_t)bb.z * largura + bb.x] = ticksUntil(detonacao[gameMap.index(bb.x, bb.z)], agora);
+            continue;
+        }
+        if (bb.frame_explosao <= 0) continue;
+        // Centro e as 4 vizinhas que não são parede, como em drawExplosions()
+        uint8_t duracao = (uint8_t)min(bb.frame_explosao, 255);
+        const int dx[5] = { 0, -1, 1, 0, 0 }, dz[5] = { 0, 0, 0, -1, 1 };
+        for (int d = 0; d < 5; d++) {
+            int x = bb.x + dx[d], z = bb.z + dz[d];
+            if (d > 0 && gameMap.at(x, z) == CELULA_PAREDE) continue;
+            uint8_t& e = explosao[(size_t)z * largura + x];
+            e = max(e, duracao);
+        }
+    }
+}
+
+void LoteAmbientes::start(const ConfigLote& c, uint8_t* observacoes) {
+    cfg = c;
+    cfg.largura = max(MAP_SIZE_MIN, min(MAP_SIZE_MAX, cfg.largura)); // como setMapSize()
+    cfg.altura = max(MAP_SIZE_MIN, min(MAP_SIZE_MAX, cfg.altura));
+    partidas.clear();
+    partidas.resize(cfg.ambientes > 0 ? cfg.ambientes : 0);
+    ambientes.assign(partidas.size(), Ambiente());
+    uint64_t gerador = cfg.semente;
+    for (size_t i = 0; i < ambientes.size(); i++) {
+        ambientes[i].gerador = splitmix64(gerador);
+        ambientes[i].passos = 0;
+    }
+
+    parallelFor(partidas.size(), 16, [&](size_t inicio, size_t fim) {
+        for (size_t i = inicio; i < fim; i++) {
+            // Cria a partida no lugar da desta thread e devolve a desta
+            swapMatch(partidas[i]);
+            setMapSize(cfg.largura, cfg.altura);
+            jogadores.assign(1, Jogador());
+            reset(i);
+            observe(i, observacoes);
+            swapMatch(partidas[i]);
+        }
+    });
+}
+
+size_t LoteAmbientes::observationBytes() const {
+    if (cfg.observacao == OBSERVACAO_PLANOS) return (size_t)NUM_PLANOS * cfg.largura * cfg.altura;
+    return TAM_OBSERVACAO;
+}
+
+void LoteAmbientes::observe(size_t i, uint8_t* observacoes) const {
+    if (!observacoes) return;
+    if (cfg.observacao == OBSERVACAO_PLANOS) writePlanes(0, observacoes + i * observationBytes());
+    else writeObservation(0, observacoes + i * TAM_OBSERVACAO);
+}
+
+void LoteAmbientes::reset(size_t i) {
+    tick_atual = 0;
+    initMap(splitmix64(ambientes[i].gerador));
+    ambientes[i].passos = 0;
+}
+
+void LoteAmbientes::stepRange(size_t inicio, size_t fim, const uint8_t* acoes, float* recompensas,
+                              uint8_t* terminou, uint8_t* observacoes) {
+    for (size_t i = inicio; i < fim; i++) {
+        Ambiente& a = ambientes[i];
+        swapMatch(partidas[i]);
+
+        size_t antes = inimigos.size();
+        int acao = acoes[i];
+        if (acao > ACAO_NENHUMA && acao < NUM_ACOES) applyAction(0, acao);
+        if (!player_won && jogadores[0].vivo) stepGame();
+        a.passos++;
+        a.est.passos++;
+
+        float r = RECOMPENSA_PASSO + RECOMPENSA_INIMIGO * (float)(antes - inimigos.size());
+        bool fim_episodio = false;
+        if (!jogadores[0].vivo) {
+            r += RECOMPENSA_MORTE;
+            a.est.mortes++;
+            fim_episodio = true;
+        } else if (player_won) {
+            r += RECOMPENSA_VITORIA;
+            a.est.vitorias++;
+            fim_episodio = true;
+        } else if (a.passos >= cfg.max_passos) {
+            fim_episodio = true;
+        }
+        if (fim_episodio) {
+            a.est.episodios++;
+            reset(i);
+        }
+
+        if (recompensas) recompensas[i] = r;
+        if (terminou) terminou[i] = fim_episodio ? 1 : 0;
+        observe(i, observacoes);
+        swapMatch(partidas[i]);
+    }
+}
+
+void LoteAmbientes::step(const uint8_t* acoes, float* recompensas, uint8_t* terminou, uint8_t* observacoes) {
+    // Blocos pequenos: o custo de um passo varia muito (mapa novo ao recomeçar)
+    parallelFor(partidas.size(), 8, [&](size_t inicio, size_t fim) {
+        stepRange(inicio, fim, acoes, recompensas, terminou, observacoes);
+    });
+}
+
+EstatisticasLote LoteAmbientes::stats() const {
+    EstatisticasLote total;
+    for (size_t i = 0; i < ambientes.size(); i++) {
+        total.passos += ambientes[i].est.passos;
+        total.episodios += ambientes[i].est.episodios;
+        total.vitorias += ambientes[i].est.vitorias;
+        total.mortes += ambientes[i].est.mortes;
+    }
+    return total;
+}
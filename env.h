@@ -0,0 +1,117 @@
+/*
+ * Lote de ambientes para treinar bots (sem OpenGL)
+ *
+ * N partidas de um jogador, guardadas lado a lado num vetor de EstadoPartida,
+ * avançam juntas com uma chamada: step() recebe uma ação por ambiente e
+ * preenche recompensas, fim de episódio e observações em vetores do chamador.
+ * Um ambiente cujo episódio acabou (vitória, morte ou limite de passos)
+ * recomeça sozinho, e a observação devolvida já é a do episódio novo. Cada
+ * passo é uma ação do jogador seguida de um tick das regras (stepGame()).
+ *
+ * Os episódios só dependem da semente do lote, do tamanho do mapa e de
+ * num_inimigos/densidades, não do número de threads.
+ */
+#ifndef ENV_H
+#define ENV_H
+
+#include "game.h"
+#include <vector>
+#include <stdint.h>
+
+// Recompensas de um passo
+const float RECOMPENSA_INIMIGO = 1.0f;  // por inimigo morto
+const float RECOMPENSA_VITORIA = 10.0f;
+const float RECOMPENSA_MORTE = -10.0f;
+const float RECOMPENSA_PASSO = -0.01f;  // incentiva terminar logo
+
+// Observação: janela de LADO_OBSERVACAO x LADO_OBSERVACAO células centrada no
+// jogador, uma célula por byte (linha a linha, z crescente)
+const int LADO_OBSERVACAO = 11;
+const int TAM_OBSERVACAO = LADO_OBSERVACAO * LADO_OBSERVACAO;
+enum {
+    OBS_FORA = 0,   // fora do mapa
+    OBS_VAZIA,
+    OBS_PAREDE,
+    OBS_BLOCO,
+    OBS_PERIGO,     // alguma bomba armada alcança a célula
+    OBS_BOMBA,
+    OBS_INIMIGO,
+};
+
+// Observação em planos: o tabuleiro inteiro, NUM_PLANOS planos de
+// largura x altura bytes (linha a linha, z crescente), um depois do outro
+enum {
+    PLANO_PAREDE = 0,  // 1 se parede fixa
+    PLANO_BLOCO,       // 1 se bloco destrutível
+    PLANO_JOGADOR,     // 1 = o jogador observado, 2 = outro jogador vivo
+    PLANO_INIMIGO,     // 1 se há inimigo
+    PLANO_BOMBA,       // ticks até a bomba armada explodir (com as cadeias), 0 = sem bomba
+    PLANO_EXPLOSAO,    // ticks que a explosão ainda dura na célula, 0 = sem explosão
+    PLANO_PERIGO,      // ticks até uma explosão alcançar a célula, 0 = nenhuma
+    NUM_PLANOS
+};
+
+enum { OBSERVACAO_JANELA = 0, OBSERVACAO_PLANOS };
+
+struct ConfigLote {
+    int ambientes;
+    int largura, altura;
+    int max_passos;     // episódio truncado depois disso (conta como fim)
+    int observacao;     // OBSERVACAO_JANELA ou OBSERVACAO_PLANOS
+    uint64_t semente;
+
+    ConfigLote() : ambientes(256), largura(15), altura(15), max_passos(1000), observacao(OBSERVACAO_JANELA),
+                   semente(1) {}
+};
+
+struct EstatisticasLote {
+    uint64_t passos;
+    uint64_t episodios;
+    uint64_t vitorias;
+    uint64_t mortes;
+
+    EstatisticasLote() : passos(0), episodios(0), vitorias(0), mortes(0) {}
+};
+
+class LoteAmbientes {
+public:
+    // Cria e começa todos os ambientes; observacoes (ambientes x
+    // observationBytes()) pode ser nulo
+    void start(const ConfigLote& cfg, uint8_t* observacoes);
+
+    // acoes: um Acao por ambiente; recompensas, terminou e observacoes (qualquer
+    // um pode ser nulo) recebem um valor (ou uma observação) por ambiente. Roda
+    // em workerCount() threads (parallel.h).
+    void step(const uint8_t* acoes, float* recompensas, uint8_t* terminou, uint8_t* observacoes);
+
+    int size() const { return (int)partidas.size(); }
+    size_t observationBytes() const; // de um ambiente
+    EstatisticasLote stats() const;
+
+private:
+    struct Ambiente {
+        uint64_t gerador;   // sementes dos episódios
+        int passos;         // do episódio atual
+        EstatisticasLote est;
+    };
+
+    void reset(size_t i);   // com a partida i na thread atual
+    void observe(size_t i, uint8_t* observacoes) const;
+    void stepRange(size_t inicio, size_t fim, const uint8_t* acoes, float* recompensas, uint8_t* terminou,
+                   uint8_t* observacoes);
+
+    ConfigLote cfg;
+    std::vector<EstadoPartida> partidas;
+    std::vector<Ambiente> ambientes;
+};
+
+// Janela de observação do jogador j da partida desta thread
+void writeObservation(int j, uint8_t* saida);
+
+// Planos do tabuleiro da partida desta thread, vistos pelo jogador j, em
+// 'saida' (planesSize() bytes). Não aloca nem usa OpenGL; custa uma passada
+// pelo mapa mais O(entidades).
+size_t planesSize();
+void writePlanes(int j, uint8_t* saida);
+
+#endif
@@ -0,0 +1,1027 @@
+/*
+ * Regras do Bomberman 3D: mapa, inimigos, bombas e explosões
+ */
+#include "game.h"
+#include "parallel.h"
+#include "mapgen.h"
+#include "stats.h"
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+using namespace std;
+
+thread_local Mapa gameMap;
+thread_local vector<Jogador> jogadores(1, Jogador()); // offline: só o jogador local
+thread_local bool player_won = false; // Nova variável para controlar vitória
+
+thread_local Inimigos inimigos;
+int num_inimigos = NUM_ENEMIES;
+int densidade_blocos = 25;
+int densidade_paredes = 0;
+thread_local vector<int32_t> ocupacao;
+
+thread_local vector<Bomba> bombas;
+thread_local vector<uint8_t> bombas_na_celula;
+
+thread_local vector<uint16_t> dist_perigo;
+thread_local vector<uint16_t> dist_jogador;
+
+thread_local int tick_atual = 0;
+thread_local uint64_t semente_partida = 1;
+static thread_local int enemy_move_counter = 0; // ticks desde o último movimento dos inimigos
+static thread_local uint32_t partida_atual = 0;  // muda a cada initMap() (paredes diferentes)
+static atomic<uint32_t> partidas_criadas(0);     // do processo: ids únicos entre threads
+static atomic<uint64_t> mapas_criados(0);        // idem para as identidades de Mapa
+thread_local vector<int> detonacao;
+thread_local vector<int> perigo;
+
+// Todo acesso a uma global thread_local com construtor (vetores) passa por uma
+// verificação de inicialização, e o compilador não a tira dos laços. As funções
+// quentes começam com referências locais de mesmo nome (Mapa& gameMap =
+// ::gameMap), e o corpo continua igual.
+
+// Filas das buscas em largura: coordenadas empacotadas como x | (z << 16).
+// dist_jogador tem a sua para rodar ao mesmo tempo que dist_perigo.
+static thread_local vector<int> fila;
+static thread_local vector<int> fila_jogador;
+static thread_local vector<int> fontes_por_linha; // fontes de perigo por linha de blocos
+static thread_local vector<uint8_t> marca; // marcações temporárias por célula
+
+// Comandos de commandEnemy() para o próximo moveEnemies(): id e Acao
+static thread_local vector<pair<uint32_t, uint8_t> > comandos;
+
+static inline int packCell(int x, int z) { return x | (z << 16); }
+static inline int cellX(int c) { return c & 0xFFFF; }
+static inline int cellZ(int c) { return c >> 16; }
+
+void setMapSize(int largura, int altura) {
+    if (largura < MAP_SIZE_MIN) largura = MAP_SIZE_MIN;
+    if (altura < MAP_SIZE_MIN) altura = MAP_SIZE_MIN;
+    if (largura > MAP_SIZE_MAX) largura = MAP_SIZE_MAX;
+    if (altura > MAP_SIZE_MAX) altura = MAP_SIZE_MAX;
+
+    gameMap.resize(largura, altura);
+    size_t n = gameMap.cellCount();
+    dist_perigo.assign(n, DIST_INFINITA);
+    dist_jogador.assign(n, DIST_INFINITA);
+    detonacao.assign(n, SEM_PERIGO);
+    perigo.assign(n, SEM_PERIGO);
+    marca.assign(n, 0);
+    ocupacao.assign(n, -1);
+    bombas_na_celula.assign(n, 0);
+    fila.assign((size_t)largura * altura, 0);
+    fila_jogador.assign((size_t)largura * altura, 0);
+    fontes_por_linha.assign(gameMap.tiles_z, 0);
+}
+
+static void clearDangerMap() {
+    fill(detonacao.begin(), detonacao.end(), SEM_PERIGO);
+    fill(perigo.begin(), perigo.end(), SEM_PERIGO);
+}
+
+// Marca (valor 1) ou desmarca (0) as células a menos de 4 passos (Manhattan) de
+// algum jogador ativo
+static void markPlayerSurroundings(uint8_t valor) {
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        if (!jogadores[j].ativo) continue;
+        for (int dz = -3; dz <= 3; dz++) {
+            for (int dx = -3 + abs(dz); dx <= 3 - abs(dz); dx++) {
+                int x = jogadores[j].x + dx, z = jogadores[j].z + dz;
+                if (x >= 0 && z >= 0 && x < gameMap.largura && z < gameMap.altura)
+                    marca[gameMap.index(x, z)] = valor;
+            }
+        }
+    }
+}
+
+// Sorteios de initMap() e spawnEnemies(): rand(), para srand() controlar a
+// partida, ou o gerador de initMap(semente), que não depende de outras threads
+static thread_local uint64_t* gerador_partida = 0;
+
+static unsigned int matchRandom() {
+    return gerador_partida ? (unsigned int)(splitmix64(*gerador_partida) >> 33) : (unsigned int)rand();
+}
+
+// Células onde um inimigo pode nascer: vazias e a pelo menos 4 passos (Manhattan) dos jogadores
+static thread_local vector<int> celulas_livres;
+
+int spawnEnemies(int quantidade) {
+    inimigos.clear();
+    fill(ocupacao.begin(), ocupacao.end(), -1);
+
+    markPlayerSurroundings(1);
+    celulas_livres.clear();
+    for (int z = 1; z < gameMap.altura - 1; z++) {
+        for (int x = 1; x < gameMap.largura - 1; x++) {
+            size_t c = gameMap.index(x, z);
+            if (gameMap.celulas[c] == CELULA_VAZIA && !marca[c])
+                celulas_livres.push_back(packCell(x, z));
+        }
+    }
+    markPlayerSurroundings(0);
+
+    int capacidade = (int)celulas_livres.size();
+    if (quantidade > capacidade) {
+        fprintf(stderr, "Nao ha espaco para %d inimigos neste mapa (cabem %d)\n", quantidade, capacidade);
+        quantidade = capacidade;
+    }
+    inimigos.reserve(quantidade);
+
+    // Fisher-Yates parcial: cada sorteio troca a célula escolhida para o início
+    // da lista, então não há repetição nem tentativas perdidas
+    uint64_t estado = ((uint64_t)matchRandom() << 32) ^ (uint64_t)matchRandom();
+    for (int i = 0; i < quantidade; i++) {
+        size_t j = i + (size_t)(splitmix64(estado) % (uint64_t)(capacidade - i));
+        swap(celulas_livres[i], celulas_livres[j]);
+        int x = cellX(celulas_livres[i]), z = cellZ(celulas_livres[i]);
+        ocupacao[gameMap.index(x, z)] = (int32_t)inimigos.size();
+        inimigos.add(x, z, INIMIGO_COMUM, (uint32_t)i);
+    }
+    return quantidade;
+}
+
+// Começa uma partida nova com 'quantidade' inimigos
+static bool startMatch(int quantidade) {
+    if (gameMap.largura == 0) setMapSize(MAP_SIZE, MAP_SIZE);
+    comandos.clear();
+    const int largura = gameMap.largura, altura = gameMap.altura;
+
+    // Mapa novo a cada partida (a semente vem de rand(), então srand() continua
+    // controlando a partida inteira)
+    ParametrosMapa p;
+    p.largura = largura;
+    p.altura = altura;
+    p.densidade_blocos = densidade_blocos;
+    p.densidade_paredes = densidade_paredes;
+    p.semente = ((uint64_t)matchRandom() << 32) ^ (uint64_t)matchRandom();
+
+    // Jogadores ativos renascem: o primeiro no canto (1, 1), como no jogo
+    // original, e os demais em salas (x e z ímpares) sorteadas
+    player_won = false;
+    bool primeiro = true;
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        if (!jogadores[j].ativo) continue;
+        if (primeiro) {
+            jogadores[j].x = 1;
+            jogadores[j].z = 1;
+            primeiro = false;
+        } else {
+            jogadores[j].x = 2 * (matchRandom() % ((largura - 1) / 2)) + 1;
+            jogadores[j].z = 2 * (matchRandom() % ((altura - 1) / 2)) + 1;
+        }
+        jogadores[j].vivo = true;
+    }
+
+    generateMap(gameMap, p, 1, 1);
+    for (size_t j = 0; j < jogadores.size(); j++)
+        if (jogadores[j].ativo) clearSpawnPocket(gameMap, jogadores[j].x, jogadores[j].z);
+
+    partida_atual = ++partidas_criadas;
+
+    // Cria os inimigos em posições aleatórias válidas
+    bool coube = spawnEnemies(quantidade) == quantidade;
+
+    // Nenhuma bomba no início da partida
+    bombas.clear();
+    fill(bombas_na_celula.begin(), bombas_na_celula.end(), 0);
+    clearDangerMap();
+    return coube;
+}
+
+bool initMap() {
+    return startMatch(num_inimigos);
+}
+
+bool initMap(uint64_t semente) {
+    return initMap(semente, num_inimigos);
+}
+
+bool initMap(uint64_t semente, int inimigos) {
+    uint64_t gerador = semente;
+    semente_partida = splitmix64(gerador);
+    gerador_partida = &gerador;
+    bool coube = startMatch(inimigos);
+    gerador_partida = 0;
+    return coube;
+}
+
+uint32_t currentMatch() {
+    return partida_atual;
+}
+
+// Verifica se há uma bomba na posição (x,z): armada (ainda não explodiu, mesmo
+// com timer zerado) ou explodindo (frame_explosao > 0)
+bool hasBomb(int x, int z) {
+    contadores_tick.chamadas_hasbomb++;
+    return bombas_na_celula[gameMap.index(x, z)] > 0;
+}
+
+int enemyAt(int x, int z) {
+    return ocupacao[gameMap.index(x, z)];
+}
+
+// Verifica se o jogador j está na explosão
+bool playerInExplosion(int j, int bomb_x, int bomb_z) {
+    int player_x = jogadores[j].x, player_z = jogadores[j].z;
+
+    // Verifica se o jogador está no centro da explosão
+    if (player_x == bomb_x && player_z == bomb_z)
+        return true;
+
+    // Verifica se o jogador está nos braços da explosão
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            if (abs(dx) + abs(dz) == 1) {
+                int nx = bomb_x + dx, nz = bomb_z + dz;
+                // Só verifica se não há parede bloqueando
+                if (gameMap.at(nx, nz) != CELULA_PAREDE && player_x == nx && player_z == nz)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Verifica se algum inimigo está na explosão e retorna o índice do inimigo atingido
+// Retorna -1 se nenhum inimigo foi atingido
+int enemyInExplosion(int bomb_x, int bomb_z) {
+    // Verifica se o inimigo está no centro da explosão
+    int i = enemyAt(bomb_x, bomb_z);
+    if (i >= 0) return i;
+
+    // Verifica se o inimigo está nos braços da explosão
+    for (int dir = 0; dir < 4; dir++) {
+        int nx = bomb_x + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+        int nz = bomb_z + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+        // Só verifica se não há parede bloqueando
+        if (gameMap.at(nx, nz) != CELULA_PAREDE && (i = enemyAt(nx, nz)) >= 0)
+            return i;
+    }
+    return -1; // Nenhum inimigo atingido
+}
+
+// Remove o inimigo i; o último inimigo passa a ocupar o índice i
+void killEnemy(int i) {
+    size_t ultimo = inimigos.size() - 1;
+    ocupacao[gameMap.index(inimigos.x[i], inimigos.z[i])] = -1;
+    if ((size_t)i != ultimo)
+        ocupacao[gameMap.index(inimigos.x[ultimo], inimigos.z[ultimo])] = i;
+    inimigos.removeSwap(i);
+}
+
+bool anyPlayerAlive() {
+    for (size_t j = 0; j < jogadores.size(); j++)
+        if (jogadores[j].ativo && jogadores[j].vivo) return true;
+    return false;
+}
+
+// Bomba do jogador j ainda armada ou explodindo (cada jogador tem uma por vez)
+bool hasActiveBomb(int j) {
+    for (size_t i = 0; i < bombas.size(); i++) {
+        if (bombas[i].dono == j && (!bombas[i].explodiu || bombas[i].frame_explosao > 0))
+            return true;
+    }
+    return false;
+}
+
+bool applyAction(int j, int acao) {
+    Jogador& jogador = jogadores[j];
+    if (!jogador.ativo || !jogador.vivo) return false;
+
+    if (acao == ACAO_BOMBA) {
+        if (hasActiveBomb(j) || hasBomb(jogador.x, jogador.z)) return false;
+        plantBomb(jogador.x, jogador.z, j);
+        return true;
+    }
+
+    int dx = 0, dz = 0;
+    if (acao == ACAO_CIMA) dz = -1;
+    else if (acao == ACAO_BAIXO) dz = 1;
+    else if (acao == ACAO_ESQUERDA) dx = -1;
+    else if (acao == ACAO_DIREITA) dx = 1;
+    else return false;
+
+    // Só anda se o destino for livre, sem bomba nem inimigo
+    int nx = jogador.x + dx, nz = jogador.z + dz;
+    if (gameMap.at(nx, nz) != CELULA_VAZIA || hasBomb(nx, nz) || enemyAt(nx, nz) >= 0) return false;
+    jogador.x = nx;
+    jogador.z = nz;
+    return true;
+}
+
+int addPlayer() {
+    size_t j = 0;
+    while (j < jogadores.size() && jogadores[j].ativo) j++;
+    if (j == jogadores.size()) jogadores.push_back(Jogador());
+
+    // Entra no meio da partida numa célula vazia, sem bomba, inimigo nem perigo;
+    // sorteia algumas vezes e, se não achar, procura em ordem
+    Jogador& novo = jogadores[j];
+    novo.ativo = true;
+    novo.vivo = true;
+    novo.x = 1;
+    novo.z = 1;
+    bool achou = false;
+    for (int tentativa = 0; tentativa < 64 && !achou; tentativa++) {
+        int x = rand() % (gameMap.largura - 2) + 1;
+        int z = rand() % (gameMap.altura - 2) + 1;
+        size_t c = gameMap.index(x, z);
+        if (gameMap.celulas[c] == CELULA_VAZIA && bombas_na_celula[c] == 0 && ocupacao[c] < 0 && perigo[c] == SEM_PERIGO) {
+            novo.x = x;
+            novo.z = z;
+            achou = true;
+        }
+    }
+    for (int z = 1; z < gameMap.altura - 1 && !achou; z++) {
+        for (int x = 1; x < gameMap.largura - 1 && !achou; x++) {
+            size_t c = gameMap.index(x, z);
+            if (gameMap.celulas[c] == CELULA_VAZIA && bombas_na_celula[c] == 0 && ocupacao[c] < 0 && perigo[c] == SEM_PERIGO) {
+                novo.x = x;
+                novo.z = z;
+                achou = true;
+            }
+        }
+    }
+    return (int)j;
+}
+
+void removePlayer(int j) {
+    jogadores[j].ativo = false;
+    jogadores[j].vivo = false;
+}
+
+// Tick da primeira explosão que alcança (x,z): a bomba da própria célula ou a de
+// um vizinho, desde que a célula não seja parede (paredes bloqueiam os braços)
+static int cellDanger(int x, int z) {
+    const Mapa& gameMap = ::gameMap;
+    const vector<int>& detonacao = ::detonacao;
+    int t = detonacao[gameMap.index(x, z)];
+    if (gameMap.at(x, z) == CELULA_PAREDE) return t;
+
+    for (int dir = 0; dir < 4; dir++) {
+        int nx = x + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+        int nz = z + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+        int vizinha = detonacao[gameMap.index(nx, nz)];
+        if (vizinha < t) t = vizinha;
+    }
+    return t;
+}
+
+// Atualiza o perigo das (no máximo 5) células alcançadas por uma bomba em (x,z)
+static void refreshDangerAround(int x, int z) {
+    perigo[gameMap.index(x, z)] = cellDanger(x, z);
+    for (int dir = 0; dir < 4; dir++) {
+        int nx = x + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+        int nz = z + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+        if (gameMap.at(nx, nz) != CELULA_PAREDE) perigo[gameMap.index(nx, nz)] = cellDanger(nx, nz);
+    }
+}
+
+// Antecipa a explosão da bomba em (x,z) para 'tick' e propaga para as bombas
+// armadas que ela alcança (reação em cadeia)
+static void scheduleDetonation(int x, int z, int tick) {
+    const Mapa& gameMap = ::gameMap;
+    vector<int>& detonacao = ::detonacao;
+    vector<int>& fila = ::fila;
+    int fim = 0;
+
+    detonacao[gameMap.index(x, z)] = tick;
+    fila[fim++] = packCell(x, z);
+    for (int inicio = 0; inicio < fim; inicio++) {
+        int bx = cellX(fila[inicio]);
+        int bz = cellZ(fila[inicio]);
+        refreshDangerAround(bx, bz);
+
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = bx + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+            int nz = bz + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+            size_t n = gameMap.index(nx, nz);
+            if (gameMap.celulas[n] != CELULA_PAREDE && detonacao[n] != SEM_PERIGO && detonacao[n] > tick) {
+                detonacao[n] = tick;
+                fila[fim++] = packCell(nx, nz);
+            }
+        }
+    }
+}
+
+void plantBomb(int x, int z, int dono) {
+    Bomba nova;
+    nova.x = x;
+    nova.z = z;
+    nova.timer = 4;
+    nova.explodiu = false;
+    nova.frame_explosao = 0;
+    nova.dono = dono;
+    bombas.push_back(nova);
+    bombas_na_celula[gameMap.index(x, z)]++;
+    contadores_tick.bombas_plantadas++;
+
+    // A bomba explode quando o timer zera ou junto com a primeira bomba armada
+    // que já alcança esta célula, o que acontecer antes
+    int tick = tick_atual + nova.timer + 1;
+    if (perigo[gameMap.index(x, z)] < tick) tick = perigo[gameMap.index(x, z)];
+    scheduleDetonation(x, z, tick);
+}
+
+int ticksToExplosion(int x, int z) {
+    if (perigo[gameMap.index(x, z)] == SEM_PERIGO) return -1;
+    return perigo[gameMap.index(x, z)] - tick_atual;
+}
+
+void rebuildDangerMap() {
+    static thread_local vector<pair<int, int> > ordem; // (tick próprio, célula) de cada bomba armada
+    const Mapa& gameMap = ::gameMap;
+    vector<int>& detonacao = ::detonacao;
+    vector<int>& perigo = ::perigo;
+    vector<int>& fila = ::fila;
+    vector<uint8_t>& marca = ::marca;
+
+    clearDangerMap();
+    ordem.clear();
+    for (size_t i = 0; i < bombas.size(); i++) {
+        if (bombas[i].explodiu) continue;
+        marca[gameMap.index(bombas[i].x, bombas[i].z)] = 1; // armada
+        ordem.push_back(make_pair(tick_atual + bombas[i].timer + 1, packCell(bombas[i].x, bombas[i].z)));
+    }
+
+    // Em ordem crescente de tempo, cada bomba ainda sem tempo definido detona
+    // (em cadeia) todas as bombas armadas que consegue alcançar
+    sort(ordem.begin(), ordem.end());
+    for (size_t i = 0; i < ordem.size(); i++) {
+        int tick = ordem[i].first;
+        size_t c = gameMap.index(cellX(ordem[i].second), cellZ(ordem[i].second));
+        if (detonacao[c] != SEM_PERIGO) continue;
+
+        int fim = 0;
+        detonacao[c] = tick;
+        fila[fim++] = ordem[i].second;
+        for (int inicio = 0; inicio < fim; inicio++) {
+            int bx = cellX(fila[inicio]);
+            int bz = cellZ(fila[inicio]);
+            for (int dir = 0; dir < 4; dir++) {
+                int nx = bx + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+                int nz = bz + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+                size_t n = gameMap.index(nx, nz);
+                if (gameMap.celulas[n] != CELULA_PAREDE && marca[n] && detonacao[n] == SEM_PERIGO) {
+                    detonacao[n] = tick;
+                    fila[fim++] = packCell(nx, nz);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < bombas.size(); i++)
+        marca[gameMap.index(bombas[i].x, bombas[i].z)] = 0;
+
+    for (int z = 0; z < gameMap.altura; z++)
+        for (int x = 0; x < gameMap.largura; x++)
+            perigo[gameMap.index(x, z)] = cellDanger(x, z);
+}
+
+// BFS multi-fonte: as fontes já estão na fila com distância 0. Células marcadas
+// (com bomba) recebem distância mas não propagam, pois ninguém atravessa uma bomba.
+static void propagateDistances(const Mapa& mapa, const vector<uint8_t>& marca, vector<int>& fila,
+                               vector<uint16_t>& dist, int fim) {
+    for (int inicio = 0; inicio < fim; inicio++) {
+        int x = cellX(fila[inicio]);
+        int z = cellZ(fila[inicio]);
+        size_t c = mapa.index(x, z);
+        if (marca[c] && dist[c] > 0) continue;
+        uint16_t proxima = dist[c] + 1 < DIST_INFINITA ? dist[c] + 1 : DIST_INFINITA - 1;
+
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+            int nz = z + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+            size_t n = mapa.index(nx, nz);
+            if (mapa.celulas[n] != CELULA_VAZIA || dist[n] != DIST_INFINITA) continue;
+            dist[n] = proxima;
+            fila[fim++] = packCell(nx, nz);
+        }
+    }
+}
+
+// O que computeDistanceFields() divide entre as threads. As threads auxiliares
+// têm o próprio estado, então tudo vem por referência da thread que chamou.
+struct CamposDistancia {
+    const Mapa& mapa;
+    const vector<int>& perigo;
+    const vector<uint8_t>& marca;
+    vector<uint16_t>& dist_perigo;
+    vector<uint16_t>& dist_jogador;
+    vector<int>& fila;
+    vector<int>& fila_jogador;
+    vector<int>& fontes_por_linha;
+    int fim_perigo, fim_jogador;
+};
+
+// Limpa os dois campos e acha as fontes de perigo nas linhas de blocos
+// [inicio, fim). As fontes da linha r vão para a fila a partir da célula
+// (0, 16r), onde não alcançam as da linha seguinte.
+static void findDangerSources(CamposDistancia& t, size_t inicio, size_t fim) {
+    const Mapa& mapa = t.mapa;
+    const size_t celulas_por_linha = (size_t)mapa.tiles_x * MAPA_TILE * MAPA_TILE;
+    for (size_t r = inicio; r < fim; r++) {
+        fill(t.dist_perigo.begin() + r * celulas_por_linha, t.dist_perigo.begin() + (r + 1) * celulas_por_linha,
+             DIST_INFINITA);
+        fill(t.dist_jogador.begin() + r * celulas_por_linha, t.dist_jogador.begin() + (r + 1) * celulas_por_linha,
+             DIST_INFINITA);
+        int z0 = (int)r * MAPA_TILE, z1 = min(z0 + MAPA_TILE, mapa.altura);
+        int* fontes = &t.fila[(size_t)z0 * mapa.largura];
+        int n = 0;
+        for (int z = z0; z < z1; z++) {
+            for (int x = 0; x < mapa.largura; x++) {
+                size_t c = mapa.index(x, z);
+                if (t.perigo[c] != SEM_PERIGO) {
+                    t.dist_perigo[c] = 0;
+                    fontes[n++] = packCell(x, z);
+                }
+            }
+        }
+        t.fontes_por_linha[r] = n;
+    }
+}
+
+// Recalcula dist_perigo (a partir das áreas de explosão) e dist_jogador em
+// O(células). A limpeza e a busca das fontes são divididas por linhas de
+// blocos entre as threads, e as duas buscas em largura rodam ao mesmo tempo
+// (as distâncias não dependem da ordem das fontes na fila).
+void computeDistanceFields() {
+    const Mapa& gameMap = ::gameMap;
+    vector<uint8_t>& marca = ::marca;
+    CamposDistancia t = { gameMap, perigo, marca, dist_perigo, dist_jogador, fila, fila_jogador, fontes_por_linha,
+                          0, 0 };
+
+    // Toda célula que alguma bomba armada vai alcançar é fonte de perigo; as
+    // fontes de cada linha de blocos são juntadas no início da fila
+    parallelFor(gameMap.tiles_z, 1, [&t](size_t inicio, size_t fim) { findDangerSources(t, inicio, fim); });
+    for (int r = 0; r < gameMap.tiles_z; r++) {
+        const int* fontes = &t.fila[(size_t)r * MAPA_TILE * gameMap.largura];
+        copy(fontes, fontes + t.fontes_por_linha[r], t.fila.begin() + t.fim_perigo);
+        t.fim_perigo += t.fontes_por_linha[r];
+    }
+
+    // Todos os jogadores vivos são fontes: dist_jogador é a distância ao mais próximo
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        if (!jogadores[j].ativo || !jogadores[j].vivo) continue;
+        size_t c = gameMap.index(jogadores[j].x, jogadores[j].z);
+        if (t.dist_jogador[c] == 0) continue;
+        t.dist_jogador[c] = 0;
+        t.fila_jogador[t.fim_jogador++] = packCell(jogadores[j].x, jogadores[j].z);
+    }
+
+    for (size_t b = 0; b < bombas.size(); b++)
+        marca[gameMap.index(bombas[b].x, bombas[b].z)] = 1;
+    parallelFor(2, 1, [&t](size_t inicio, size_t fim) {
+        for (size_t k = inicio; k < fim; k++) {
+            if (k == 0) propagateDistances(t.mapa, t.marca, t.fila, t.dist_perigo, t.fim_perigo);
+            else propagateDistances(t.mapa, t.marca, t.fila_jogador, t.dist_jogador, t.fim_jogador);
+        }
+    });
+    for (size_t b = 0; b < bombas.size(); b++)
+        marca[gameMap.index(bombas[b].x, bombas[b].z)] = 0;
+}
+
+// Número pseudoaleatório de 64 bits que depende só da semente, do tick e do
+// inimigo (splitmix64), para que as decisões não dependam da ordem de execução
+static inline uint64_t enemyRandom(uint64_t semente, int tick, uint32_t id) {
+    uint64_t estado = semente ^ ((uint64_t)tick << 32) ^ (uint64_t)id;
+    return splitmix64(estado);
+}
+
+// Decisão de um inimigo: direção em DECISAO_DIR (0 = parado, 1..4 = -x, +x, -z, +z)
+// e flags de fuga e de bomba
+enum { DECISAO_DIR = 0x07, DECISAO_FUGINDO = 0x08, DECISAO_BOMBA = 0x10 };
+static thread_local vector<uint8_t> decisao;
+
+static const int DIR_DX[5] = { 0, -1, 1, 0, 0 };
+static const int DIR_DZ[5] = { 0, 0, 0, -1, 1 };
+
+// O que a fase de decisão lê e escreve. O estado do jogo é por thread e as
+// threads auxiliares do parallelFor() recebem o da thread que chamou.
+struct VisaoDecisao {
+    const Mapa* mapa;
+    const Inimigos* inimigos;
+    const int* perigo;
+    const uint8_t* bombas_na_celula;
+    const uint16_t* dist_perigo;
+    const uint16_t* dist_jogador;
+    uint8_t* decisao;
+    uint64_t semente;
+    int tick;
+};
+
+// Fase de decisão: só lê o estado do tick e escreve decisao[i], então pode
+// rodar em paralelo em qualquer ordem
+static void decideEnemies(const VisaoDecisao& v, size_t inicio, size_t fim) {
+    const Mapa& mapa = *v.mapa;
+    const Inimigos& inimigos = *v.inimigos;
+    for (size_t i = inicio; i < fim; i++) {
+        int ex = inimigos.x[i], ez = inimigos.z[i];
+        uint64_t aleatorio = enemyRandom(v.semente, v.tick, inimigos.id[i]);
+        uint8_t d = 0;
+
+        // Foge depois de plantar uma bomba ou sempre que está na área de alguma explosão
+        if (inimigos.fuga[i] > 0 || v.perigo[mapa.index(ex, ez)] != SEM_PERIGO) {
+            d |= DECISAO_FUGINDO;
+
+            // Foge para o vizinho mais distante do perigo (distância real, contornando paredes)
+            int max_dist = -1;
+            for (int dir = 1; dir <= 4; dir++) {
+                size_t n = mapa.index(ex + DIR_DX[dir], ez + DIR_DZ[dir]);
+                if (mapa.celulas[n] == CELULA_VAZIA && v.bombas_na_celula[n] == 0 && v.dist_perigo[n] > max_dist) {
+                    max_dist = v.dist_perigo[n];
+                    d = (uint8_t)((d & ~DECISAO_DIR) | dir);
+                }
+            }
+        } else {
+            // Movimento aleatório normal
+            d |= (uint8_t)(1 + (aleatorio & 3));
+        }
+
+        bool perto_de_bloco = false;
+        bool perto_do_jogador = v.dist_jogador[mapa.index(ex, ez)] == 1;
+
+        // Verifica vizinhança
+        for (int dir = 1; dir <= 4; dir++) {
+            if (mapa.at(ex + DIR_DX[dir], ez + DIR_DZ[dir]) == CELULA_BLOCO)
+                perto_de_bloco = true;
+        }
+
+        // Define a chance: maior se perto do jogador, média se perto de bloco, pequena caso contrário
+        int chance = 30; // padrão: chance baixa
+        if (perto_de_bloco) chance = 10; // médio (10%)
+        if (perto_do_jogador) chance = 3; // alto (33%)
+
+        if ((aleatorio >> 8) % chance == 0)
+            d |= DECISAO_BOMBA;
+
+        v.decisao[i] = d;
+    }
+}
+
+void commandEnemy(uint32_t id, int acao) {
+    comandos.push_back(make_pair(id, (uint8_t)acao));
+}
+
+// Troca a decisão sorteada dos inimigos comandados pela do comando
+static void applyEnemyCommands() {
+    const Inimigos& inimigos = ::inimigos;
+    for (size_t i = 0; i < inimigos.size(); i++) {
+        for (size_t k = 0; k < comandos.size(); k++) {
+            if (comandos[k].first != inimigos.id[i]) continue;
+            int acao = comandos[k].second;
+            uint8_t d = inimigos.fuga[i] > 0 ? DECISAO_FUGINDO : 0;
+            if (acao == ACAO_ESQUERDA) d |= 1;
+            else if (acao == ACAO_DIREITA) d |= 2;
+            else if (acao == ACAO_CIMA) d |= 3;
+            else if (acao == ACAO_BAIXO) d |= 4;
+            else if (acao == ACAO_BOMBA) d |= DECISAO_BOMBA;
+            decisao[i] = d;
+        }
+    }
+    comandos.clear();
+}
+
+// Movimento aleatório dos inimigos em duas fases: todos decidem em paralelo
+// olhando o mesmo estado e depois as decisões são aplicadas em série, na ordem
+// dos índices. Quando dois inimigos querem a mesma célula, o de menor índice
+// fica com ela; o resultado não depende do número de threads.
+void moveEnemies() {
+    const Mapa& gameMap = ::gameMap;
+    Inimigos& inimigos = ::inimigos;
+    vector<int32_t>& ocupacao = ::ocupacao;
+    const vector<uint8_t>& bombas_na_celula = ::bombas_na_celula;
+    const vector<uint8_t>& decisao = ::decisao;
+    computeDistanceFields();
+
+    ::decisao.resize(inimigos.size());
+    VisaoDecisao v = { &gameMap, &inimigos, perigo.data(), bombas_na_celula.data(), dist_perigo.data(),
+                       dist_jogador.data(), ::decisao.data(), semente_partida, tick_atual };
+    parallelFor(inimigos.size(), 1024, [&v](size_t inicio, size_t fim) { decideEnemies(v, inicio, fim); });
+    if (!comandos.empty()) applyEnemyCommands();
+
+    uint32_t tentados = 0, feitos = 0;
+    for (size_t i = 0; i < inimigos.size(); i++) {
+        uint8_t d = decisao[i];
+        int ex = inimigos.x[i], ez = inimigos.z[i];
+
+        if (d & DECISAO_FUGINDO) {
+            inimigos.estado[i] = INIMIGO_FUGINDO;
+            if (inimigos.fuga[i] > 0) inimigos.fuga[i]--;
+        } else {
+            inimigos.estado[i] = INIMIGO_VAGANDO;
+        }
+
+        // Verifica se o movimento ainda é válido (não colide com paredes, blocos,
+        // bombas plantadas neste tick ou inimigos que já se moveram)
+        int dir = d & DECISAO_DIR;
+        if (dir != 0) {
+            size_t n = gameMap.index(ex + DIR_DX[dir], ez + DIR_DZ[dir]);
+            tentados++;
+            if (gameMap.celulas[n] == CELULA_VAZIA && bombas_na_celula[n] == 0 && ocupacao[n] < 0) {
+                feitos++;
+                ocupacao[gameMap.index(ex, ez)] = -1;
+                ocupacao[n] = (int32_t)i;
+                ex += DIR_DX[dir];
+                ez += DIR_DZ[dir];
+                inimigos.x[i] = (int16_t)ex;
+                inimigos.z[i] = (int16_t)ez;
+            }
+        }
+
+        if ((d & DECISAO_BOMBA) && !hasBomb(ex, ez)) {
+            plantBomb(ex, ez, DONO_INIMIGO);
+            inimigos.fuga[i] = 4; // inimigo entra em fuga imediatamente
+        }
+    }
+    contadores_tick.movimentos_tentados += tentados;
+    contadores_tick.movimentos_feitos += feitos;
+}
+
+// As bombas que continuam são compactadas no próprio vetor, na mesma ordem
+// (nada chamado no laço lê 'bombas'): o tick não aloca
+void updateBombs() {
+    size_t ficam = 0;
+
+    for (size_t i = 0; i < bombas.size(); i++) {
+        int bx = bombas[i].x, bz = bombas[i].z;
+
+        if (!bombas[i].explodiu && detonacao[gameMap.index(bx, bz)] > tick_atual) {
+            // Ainda esta contando para explodir
+            bombas[i].timer--;
+            bombas[ficam++] = bombas[i];
+        }
+        else if (!bombas[i].explodiu) {
+            // Explodiu agora! (pelo próprio timer ou em cadeia: o mapa de perigo
+            // já antecipou a detonação de toda bomba alcançada por outra)
+            contadores_tick.bombas_detonadas++;
+            if (bombas[i].timer > 0) contadores_tick.bombas_encadeadas++;
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    if (abs(dx) + abs(dz) == 1) {
+                        int nx = bx + dx, nz = bz + dz;
+                        if (gameMap.at(nx, nz) == CELULA_BLOCO) {
+                            gameMap.set(nx, nz, CELULA_VAZIA);
+                            contadores_tick.celulas_destruidas++;
+                        }
+                    }
+                }
+            }
+
+            // Verifica colisão da explosão com os jogadores (morrem na hora)
+            for (size_t j = 0; j < jogadores.size(); j++) {
+                if (jogadores[j].ativo && jogadores[j].vivo && playerInExplosion((int)j, bx, bz))
+                    jogadores[j].vivo = false;
+            }
+
+            // Verifica colisão da explosão com os inimigos (todos os atingidos morrem)
+            int hit_enemy_index;
+            while ((hit_enemy_index = enemyInExplosion(bx, bz)) >= 0) {
+                killEnemy(hit_enemy_index);
+            }
+
+            detonacao[gameMap.index(bx, bz)] = SEM_PERIGO;
+            refreshDangerAround(bx, bz);
+
+            bombas[i].timer = 0;
+            bombas[i].explodiu = true;
+            bombas[i].frame_explosao = 4;  // ? tempo de duracao da explosao (4 ciclos = 2s se timerFunc=500ms)
+            bombas[ficam++] = bombas[i];
+        }
+        else if (bombas[i].frame_explosao > 0) {
+            // Esta no tempo da explosao ainda
+            bombas[i].frame_explosao--;
+            if (bombas[i].frame_explosao > 0)
+                bombas[ficam++] = bombas[i];
+            else
+                bombas_na_celula[gameMap.index(bx, bz)]--; // a célula fica livre
+        }
+        // ?? Quando frame_explosao chega a 0, a bomba e removida da lista (desaparece tudo)
+    }
+
+    bombas.resize(ficam);
+}
+
+void stepGame() {
+    // Movimento dos inimigos a cada 2 ciclos (para não ficar muito rápido)
+    // Com o registro de ticks ligado (stats.h), mede moveEnemies() e as explosões
+    bool medir = registrando_ticks;
+    uint64_t t0 = medir ? statsNs() : 0;
+    if (++enemy_move_counter >= 2) {
+        moveEnemies();
+        enemy_move_counter = 0;
+    }
+    uint64_t t1 = medir ? statsNs() : 0;
+
+    // Bombas plantadas até aqui explodem em tick_atual + timer + 1
+    tick_atual++;
+    updateBombs();
+    if (medir) {
+        uint64_t t2 = statsNs();
+        contadores_tick.ns_inimigos += (uint32_t)(t1 - t0);
+        contadores_tick.ns_explosoes += (uint32_t)(t2 - t1);
+    }
+
+    // Verifica se o jogo acabou
+    if (anyPlayerAlive()) {
+        // Verifica se todos os inimigos estão mortos (mortos saem do vetor)
+        if (inimigos.size() == 0) {
+            // Jogador venceu
+            player_won = true;
+        }
+    }
+    recordTick();
+}
+
+// Soma de verificação do estado da partida (FNV-1a), para comparar execuções
+uint64_t stateChecksum() {
+    uint64_t h = 1469598103934665603ULL;
+    struct Mistura {
+        static void bytes(uint64_t& h, const void* dados, size_t n) {
+            const uint8_t* p = (const uint8_t*)dados;
+            for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 1099511628211ULL;
+        }
+    };
+
+    Mistura::bytes(h, &gameMap.celulas[0], gameMap.celulas.size());
+    Mistura::bytes(h, &tick_atual, sizeof(tick_atual));
+    Mistura::bytes(h, &enemy_move_counter, sizeof(enemy_move_counter));
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        Mistura::bytes(h, &jogadores[j].x, sizeof(jogadores[j].x));
+        Mistura::bytes(h, &jogadores[j].z, sizeof(jogadores[j].z));
+        Mistura::bytes(h, &jogadores[j].ativo, sizeof(jogadores[j].ativo));
+        Mistura::bytes(h, &jogadores[j].vivo, sizeof(jogadores[j].vivo));
+    }
+    for (size_t i = 0; i < inimigos.size(); i++) {
+        Mistura::bytes(h, &inimigos.id[i], sizeof(inimigos.id[i]));
+        Mistura::bytes(h, &inimigos.x[i], sizeof(inimigos.x[i]));
+        Mistura::bytes(h, &inimigos.z[i], sizeof(inimigos.z[i]));
+        Mistura::bytes(h, &inimigos.fuga[i], sizeof(inimigos.fuga[i]));
+    }
+    for (size_t i = 0; i < bombas.size(); i++) {
+        Mistura::bytes(h, &bombas[i].x, sizeof(bombas[i].x));
+        Mistura::bytes(h, &bombas[i].z, sizeof(bombas[i].z));
+        Mistura::bytes(h, &bombas[i].timer, sizeof(bombas[i].timer));
+        Mistura::bytes(h, &bombas[i].frame_explosao, sizeof(bombas[i].frame_explosao));
+    }
+    return h;
+}
+
+static const size_t BYTES_POR_TILE = MAPA_TILE * MAPA_TILE;
+
+uint64_t newMapIdentity() {
+    return ++mapas_criados;
+}
+
+void snapshot(GameState& estado) {
+    estado.basico.player_won = player_won;
+    estado.basico.tick_atual = tick_atual;
+    estado.basico.enemy_move_counter = enemy_move_counter;
+    estado.basico.semente_partida = semente_partida;
+    estado.basico.partida = partida_atual;
+
+    // Mapa: cópia inteira na primeira foto (ou se o tamanho mudou, ou se o
+    // estado guardava outro Mapa, cujas revisões não se comparam com estas);
+    // depois só os blocos cuja revisão mudou desde a última foto deste Mapa
+    if (estado.mapa != gameMap.identidade.valor || estado.largura != gameMap.largura ||
+        estado.altura != gameMap.altura || estado.celulas.size() != gameMap.celulas.size()) {
+        estado.largura = gameMap.largura;
+        estado.altura = gameMap.altura;
+        estado.celulas = gameMap.celulas;
+        estado.revisao = gameMap.revisao;
+        estado.mapa = gameMap.identidade.valor;
+    } else if (estado.relogio != gameMap.relogio) {
+        for (size_t t = 0; t < estado.revisao.size(); t++) {
+            if (estado.revisao[t] == gameMap.revisao[t]) continue;
+            memcpy(&estado.celulas[t * BYTES_POR_TILE], &gameMap.celulas[t * BYTES_POR_TILE], BYTES_POR_TILE);
+            estado.revisao[t] = gameMap.revisao[t];
+        }
+    }
+    estado.relogio = gameMap.relogio;
+
+    estado.jogadores = jogadores;
+    estado.inimigos = inimigos;
+    estado.bombas = bombas;
+    estado.detonacao_bombas.resize(bombas.size());
+    for (size_t b = 0; b < bombas.size(); b++)
+        estado.detonacao_bombas[b] = detonacao[gameMap.index(bombas[b].x, bombas[b].z)];
+}
+
+// Tira das grades derivadas as bombas e os inimigos atuais
+void clearEntityGrids() {
+    for (size_t b = 0; b < bombas.size(); b++) {
+        int x = bombas[b].x, z = bombas[b].z;
+        size_t c = gameMap.index(x, z);
+        bombas_na_celula[c] = 0;
+        detonacao[c] = SEM_PERIGO;
+        perigo[c] = SEM_PERIGO;
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + ((dir == 0) ? -1 : (dir == 1) ? 1 : 0);
+            int nz = z + ((dir == 2) ? -1 : (dir == 3) ? 1 : 0);
+            if (gameMap.at(nx, nz) != CELULA_PAREDE) perigo[gameMap.index(nx, nz)] = SEM_PERIGO;
+        }
+    }
+    for (size_t i = 0; i < inimigos.size(); i++)
+        ocupacao[gameMap.index(inimigos.x[i], inimigos.z[i])] = -1;
+}
+
+void rebuildEntityGrids() {
+    for (size_t i = 0; i < inimigos.size(); i++)
+        ocupacao[gameMap.index(inimigos.x[i], inimigos.z[i])] = (int32_t)i;
+    for (size_t b = 0; b < bombas.size(); b++)
+        bombas_na_celula[gameMap.index(bombas[b].x, bombas[b].z)]++;
+
+    // Como em plantBomb(): scheduleDetonation() mantém as cadeias certas em
+    // qualquer ordem de inserção
+    for (size_t b = 0; b < bombas.size(); b++) {
+        if (bombas[b].explodiu) continue;
+        size_t c = gameMap.index(bombas[b].x, bombas[b].z);
+        int tick = tick_atual + bombas[b].timer + 1;
+        if (perigo[c] < tick) tick = perigo[c];
+        scheduleDetonation(bombas[b].x, bombas[b].z, tick);
+    }
+}
+
+void restore(GameState& estado) {
+    comandos.clear();
+    // De outra partida (paredes diferentes) ou de outro tamanho: as grades
+    // derivadas são limpas por inteiro em vez de só em volta das entidades
+    bool mesma_partida = estado.basico.partida == partida_atual &&
+                         estado.largura == gameMap.largura && estado.altura == gameMap.altura;
+    if (!mesma_partida) {
+        if (estado.largura != gameMap.largura || estado.altura != gameMap.altura)
+            setMapSize(estado.largura, estado.altura);
+        fill(ocupacao.begin(), ocupacao.end(), -1);
+        fill(bombas_na_celula.begin(), bombas_na_celula.end(), 0);
+        clearDangerMap();
+    } else {
+        clearEntityGrids();
+    }
+
+    // Foto de outra partida ou de outro Mapa: as revisões dela não dizem nada
+    // sobre este relógio, então o mapa volta inteiro e todos os blocos ganham
+    // revisão nova, que a foto passa a reconhecer como sua.
+    // Da mesma partida neste mesmo Mapa: só os blocos que mudaram desde a foto
+    // voltam, também com revisão nova (o renderizador precisa refazer as malhas).
+    if (!mesma_partida || estado.mapa != gameMap.identidade.valor) {
+        gameMap.celulas = estado.celulas;
+        gameMap.touchAll();
+        estado.revisao = gameMap.revisao;
+        estado.relogio = gameMap.relogio;
+        estado.mapa = gameMap.identidade.valor;
+    } else if (estado.relogio != gameMap.relogio) {
+        for (size_t t = 0; t < estado.revisao.size(); t++) {
+            if (gameMap.revisao[t] == estado.revisao[t]) continue;
+            memcpy(&gameMap.celulas[t * BYTES_POR_TILE], &estado.celulas[t * BYTES_POR_TILE], BYTES_POR_TILE);
+            gameMap.revisao[t] = ++gameMap.relogio;
+            estado.revisao[t] = gameMap.revisao[t];
+        }
+        estado.relogio = gameMap.relogio;
+    }
+
+    player_won = estado.basico.player_won;
+    tick_atual = estado.basico.tick_atual;
+    enemy_move_counter = estado.basico.enemy_move_counter;
+    semente_partida = estado.basico.semente_partida;
+    partida_atual = estado.basico.partida;
+
+    jogadores = estado.jogadores;
+    inimigos = estado.inimigos;
+    bombas = estado.bombas;
+
+    // Refaz as grades derivadas em volta das entidades restauradas
+    for (size_t i = 0; i < inimigos.size(); i++)
+        ocupacao[gameMap.index(inimigos.x[i], inimigos.z[i])] = (int32_t)i;
+    for (size_t b = 0; b < bombas.size(); b++) {
+        size_t c = gameMap.index(bombas[b].x, bombas[b].z);
+        bombas_na_celula[c]++;
+        detonacao[c] = estado.detonacao_bombas[b];
+    }
+    for (size_t b = 0; b < bombas.size(); b++)
+        refreshDangerAround(bombas[b].x, bombas[b].z);
+}
+
+void swapMatch(EstadoPartida& outra) {
+    swap(gameMap, outra.mapa);
+    jogadores.swap(outra.jogadores);
+    swap(player_won, outra.player_won);
+    swap(inimigos, outra.inimigos);
+    bombas.swap(outra.bombas);
+    swap(tick_atual, outra.tick_atual);
+    swap(enemy_move_counter, outra.enemy_move_counter);
+    swap(semente_partida, outra.semente_partida);
+    swap(partida_atual, outra.partida);
+    ocupacao.swap(outra.ocupacao);
+    bombas_na_celula.swap(outra.bombas_na_celula);
+    marca.swap(outra.marca);
+    dist_perigo.swap(outra.dist_perigo);
+    dist_jogador.swap(outra.dist_jogador);
+    detonacao.swap(outra.detonacao);
+    perigo.swap(outra.perigo);
+    fila.swap(outra.fila);
+    fila_jogador.swap(outra.fila_jogador);
+    fontes_por_linha.swap(outra.fontes_por_linha);
+    comandos.swap(outra.comandos);
+}
@@ -0,0 +1,287 @@
+/*
+ * Regras do Bomberman 3D (simulacao sem OpenGL/GLUT)
+ */
+#ifndef GAME_H
+#define GAME_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <stdint.h>
+
+#define MAP_SIZE 13      // tamanho padrão (mapa clássico 13x13)
+#define MAP_SIZE_MIN 7   // os inimigos nascem a pelo menos 4 passos do jogador
+#define MAP_SIZE_MAX 4096
+
+// Gerador splitmix64: rápido e com boa qualidade, avança 'estado' a cada chamada
+static inline uint64_t splitmix64(uint64_t& estado) {
+    uint64_t h = (estado += 0x9E3779B97F4A7C15ULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+// Tipos de célula
+enum { CELULA_VAZIA = 0, CELULA_PAREDE = 1, CELULA_BLOCO = 2 };
+
+// Mapa com dimensões escolhidas em tempo de execução. Cada célula ocupa 1 byte e
+// as células são guardadas em blocos de 16x16 (256 bytes contíguos), então a
+// vizinhança de uma célula quase sempre está nas mesmas linhas de cache, mesmo
+// em arenas de 4096x4096. Todas as grades por célula usam o mesmo index().
+const int MAPA_TILE_BITS = 4;
+const int MAPA_TILE = 1 << MAPA_TILE_BITS; // 16
+
+// Identidade de um Mapa no processo. As revisões só valem dentro do relógio de
+// um mesmo Mapa: uma cópia ganha identidade nova e quem é movido leva a sua
+// (o Mapa de origem fica com uma nova), então comparar identidades diz se
+// revisões guardadas de um Mapa podem ser comparadas com as de outro.
+uint64_t newMapIdentity();
+
+struct IdentidadeMapa {
+    uint64_t valor;
+
+    IdentidadeMapa() : valor(newMapIdentity()) {}
+    IdentidadeMapa(const IdentidadeMapa&) : valor(newMapIdentity()) {}
+    IdentidadeMapa(IdentidadeMapa&& outra) : valor(outra.valor) { outra.valor = newMapIdentity(); }
+    IdentidadeMapa& operator=(const IdentidadeMapa& outra) {
+        if (this != &outra) valor = newMapIdentity();
+        return *this;
+    }
+    IdentidadeMapa& operator=(IdentidadeMapa&& outra) {
+        if (this != &outra) {
+            valor = outra.valor;
+            outra.valor = newMapIdentity();
+        }
+        return *this;
+    }
+};
+
+struct Mapa {
+    int largura, altura; // em células (x em [0, largura), z em [0, altura))
+    int tiles_x, tiles_z;
+    std::vector<uint8_t> celulas;
+    // Revisão de cada bloco de 16x16: muda sempre que uma célula do bloco muda
+    // por set(), para quem guarda dados derivados (ex.: malhas do renderizador)
+    std::vector<uint32_t> revisao;
+    uint32_t relogio; // nunca volta, então uma revisão vista nunca se repete
+    IdentidadeMapa identidade;
+
+    Mapa() : largura(0), altura(0), tiles_x(0), tiles_z(0), relogio(0) {}
+
+    void resize(int l, int a) {
+        largura = l;
+        altura = a;
+        tiles_x = (l + MAPA_TILE - 1) >> MAPA_TILE_BITS;
+        tiles_z = (a + MAPA_TILE - 1) >> MAPA_TILE_BITS;
+        celulas.assign((size_t)tiles_x * tiles_z * MAPA_TILE * MAPA_TILE, CELULA_PAREDE);
+        revisao.assign((size_t)tiles_x * tiles_z, ++relogio);
+    }
+
+    // Número de posições nas grades por célula (inclui o preenchimento dos blocos)
+    size_t cellCount() const { return celulas.size(); }
+
+    size_t index(int x, int z) const {
+        size_t tile = (size_t)(z >> MAPA_TILE_BITS) * tiles_x + (x >> MAPA_TILE_BITS);
+        return (tile << (2 * MAPA_TILE_BITS)) | ((z & (MAPA_TILE - 1)) << MAPA_TILE_BITS) | (x & (MAPA_TILE - 1));
+    }
+
+    uint8_t at(int x, int z) const { return celulas[index(x, z)]; }
+    void set(int x, int z, uint8_t tipo) {
+        size_t i = index(x, z);
+        celulas[i] = tipo;
+        revisao[i >> (2 * MAPA_TILE_BITS)] = ++relogio;
+    }
+    uint32_t tileRevision(int tx, int tz) const { return revisao[(size_t)tz * tiles_x + tx]; }
+    // Marca todos os blocos como alterados (para quem escreve direto em celulas)
+    void touchAll() { revisao.assign(revisao.size(), ++relogio); }
+};
+
+// Inimigos em estrutura de vetores (SoA): cada campo fica num vetor contíguo e
+// os laços quentes percorrem só os campos que usam. Inimigos mortos são
+// removidos na hora (o último ocupa a vaga), então todo índice em [0, size())
+// é um inimigo vivo. O id não muda com a compactação.
+enum { INIMIGO_VAGANDO = 0, INIMIGO_FUGINDO = 1 };
+enum { INIMIGO_COMUM = 0 };
+
+struct Inimigos {
+    std::vector<int16_t> x, z;
+    std::vector<uint8_t> estado; // INIMIGO_VAGANDO / INIMIGO_FUGINDO
+    std::vector<uint8_t> fuga;   // ticks restantes de fuga depois de plantar uma bomba
+    std::vector<uint8_t> tipo;
+    std::vector<uint32_t> id;
+
+    size_t size() const { return x.size(); }
+    void clear() {
+        x.clear(); z.clear(); estado.clear(); fuga.clear(); tipo.clear(); id.clear();
+    }
+    void reserve(size_t n) {
+        x.reserve(n); z.reserve(n); estado.reserve(n); fuga.reserve(n); tipo.reserve(n); id.reserve(n);
+    }
+    void add(int px, int pz, uint8_t t, uint32_t identificador) {
+        x.push_back((int16_t)px); z.push_back((int16_t)pz);
+        estado.push_back(INIMIGO_VAGANDO); fuga.push_back(0);
+        tipo.push_back(t); id.push_back(identificador);
+    }
+    // Remove o inimigo i trazendo o último para a vaga
+    void removeSwap(size_t i) {
+        size_t u = size() - 1;
+        x[i] = x[u]; z[i] = z[u]; estado[i] = estado[u];
+        fuga[i] = fuga[u]; tipo[i] = tipo[u]; id[i] = id[u];
+        x.pop_back(); z.pop_back(); estado.pop_back(); fuga.pop_back(); tipo.pop_back(); id.pop_back();
+    }
+};
+
+const int DONO_INIMIGO = -1;
+
+struct Bomba {
+    int x, z;
+    int timer;
+    bool explodiu;
+    int frame_explosao;
+    int dono; // índice do jogador que plantou, ou DONO_INIMIGO
+};
+
+// Jogadores: o índice é estável durante a partida (vagas livres ficam com
+// ativo = false e são reaproveitadas). Offline só existe o jogador 0.
+struct Jogador {
+    int x, z;
+    bool ativo; // vaga ocupada (no servidor: cliente conectado)
+    bool vivo;
+
+    Jogador() : x(1), z(1), ativo(true), vivo(true) {}
+};
+
+// O que um jogador faz num tick: vem do teclado, da rede ou de um bot
+enum Acao { ACAO_NENHUMA = 0, ACAO_CIMA, ACAO_BAIXO, ACAO_ESQUERDA, ACAO_DIREITA, ACAO_BOMBA, NUM_ACOES };
+
+// O estado da partida é por thread (thread_local): cada thread simula a sua e
+// várias partidas rodam ao mesmo tempo em threads diferentes (ver host.h).
+// As opções de geração (num_inimigos, densidades) valem para o processo todo.
+extern thread_local Mapa gameMap;
+extern thread_local std::vector<Jogador> jogadores;
+extern thread_local bool player_won; // todos os inimigos morreram com algum jogador vivo
+
+extern thread_local Inimigos inimigos;
+const int NUM_ENEMIES = 3; // Total de inimigos padrão (1 original + 2 novos)
+extern int num_inimigos;   // inimigos criados a cada initMap()
+extern thread_local std::vector<int32_t> ocupacao; // índice do inimigo em cada célula, -1 se vazia
+
+// Geração do mapa em initMap() (ver mapgen.h)
+extern int densidade_blocos;  // % de blocos destrutíveis (padrão 25, como o rand() % 4 original)
+extern int densidade_paredes; // % de paredes fixas extras (padrão 0, layout clássico)
+
+extern thread_local std::vector<Bomba> bombas;
+extern thread_local std::vector<uint8_t> bombas_na_celula; // bombas armadas ou explodindo em cada célula (o hasBomb() sem contar chamada)
+
+// Campos de distância (BFS sobre gameMap) compartilhados por todos os inimigos.
+// São recalculados uma vez por tick em computeDistanceFields(), de modo que a
+// decisão de cada inimigo se resume a algumas leituras nestes vetores
+// (indexados por gameMap.index(x, z)). Distâncias longas saturam em DIST_INFINITA - 1.
+const uint16_t DIST_INFINITA = 0xFFFF;
+extern thread_local std::vector<uint16_t> dist_perigo;  // passos até a área de explosão mais próxima
+extern thread_local std::vector<uint16_t> dist_jogador; // passos até o jogador
+
+// Mapa de perigo: para cada célula, o tick em que a primeira bomba armada que a
+// alcança vai explodir (já considerando reações em cadeia). Mantido de forma
+// incremental quando bombas são plantadas, encadeadas ou explodem.
+const int SEM_PERIGO = 0x7FFFFFFF;
+extern thread_local int tick_atual;             // ticks já simulados
+extern thread_local uint64_t semente_partida;   // semente das decisões aleatórias dos inimigos
+extern thread_local std::vector<int> detonacao; // tick de explosão da bomba armada na célula
+extern thread_local std::vector<int> perigo;    // tick da primeira explosão que alcança a célula
+
+void setMapSize(int largura, int altura); // redimensiona mapa e grades; chame initMap() depois
+bool initMap();                   // false se nem todos os num_inimigos couberam no mapa
+bool initMap(uint64_t semente);   // idem, sem rand(): a partida (e semente_partida) só depende da semente
+bool initMap(uint64_t semente, int inimigos); // idem, com 'inimigos' em vez de num_inimigos
+uint32_t currentMatch();          // muda a cada initMap() e restore() de outra partida
+int spawnEnemies(int quantidade); // recria os inimigos; retorna quantos couberam
+bool hasBomb(int x, int z);
+int enemyAt(int x, int z); // índice do inimigo na célula ou -1
+bool playerInExplosion(int j, int bomb_x, int bomb_z);
+int enemyInExplosion(int bomb_x, int bomb_z);
+void killEnemy(int i);
+void computeDistanceFields();
+void moveEnemies();
+// O inimigo 'id' faz 'acao' (um Acao) no próximo moveEnemies() em vez de
+// sortear; vale uma vez e é descartado por initMap() e restore()
+void commandEnemy(uint32_t id, int acao);
+void plantBomb(int x, int z, int dono);
+void updateBombs();
+void stepGame();
+
+bool applyAction(int j, int acao); // move o jogador j ou planta a bomba dele; false se não deu
+bool hasActiveBomb(int j);
+bool anyPlayerAlive();
+int addPlayer();          // ocupa uma vaga (entrando no meio da partida); retorna o índice
+void removePlayer(int j);
+
+int ticksToExplosion(int x, int z); // -1 se nenhuma explosão alcança a célula
+void rebuildDangerMap();            // recálculo completo (referência para o benchmark)
+
+// Para quem troca bombas e inimigos por fora das regras (cliente de rede): tire
+// as entidades atuais das grades derivadas (ocupação, bombas por célula, mapa de
+// perigo), troque os vetores e ponha de volta. Custa O(entidades), não O(área).
+void clearEntityGrids();
+void rebuildEntityGrids();
+
+uint64_t stateChecksum();           // muda se qualquer parte do estado da partida mudar
+
+// Foto da partida para voltar no tempo (bots de busca, rollback na rede,
+// "tentar de novo do checkpoint"). Guarda só o que não dá para recalcular; as
+// grades derivadas (ocupação, bombas por célula, mapa de perigo) são refeitas em
+// volta das entidades, então snapshot() e restore() custam O(entidades + blocos
+// do mapa alterados), não O(área). Reaproveitar o mesmo GameState em fotos
+// seguidas copia só os blocos de 16x16 do mapa que mudaram desde a anterior.
+struct EstadoBasico { // POD, copiado de uma vez
+    bool player_won;
+    int tick_atual;
+    int enemy_move_counter;
+    uint64_t semente_partida; // toda a aleatoriedade do tick vem desta semente
+    uint32_t partida;         // muda a cada initMap()
+};
+
+struct GameState {
+    EstadoBasico basico;
+    int largura, altura;
+    std::vector<uint8_t> celulas;     // mesma organização em blocos do Mapa
+    std::vector<uint32_t> revisao;    // revisão de cada bloco quando foi copiado
+    uint32_t relogio;                 // relógio do Mapa na última cópia (igual = nada mudou)
+    uint64_t mapa;                    // identidade do Mapa de revisao/relogio (0 = nenhum)
+    std::vector<Jogador> jogadores;
+    Inimigos inimigos;
+    std::vector<Bomba> bombas;
+    std::vector<int> detonacao_bombas; // detonacao[] na célula de cada bomba
+
+    GameState() : basico(), largura(0), altura(0), relogio(0), mapa(0) {}
+};
+
+void snapshot(GameState& estado);
+void restore(GameState& estado); // atualiza as revisões guardadas em 'estado'
+
+// Uma partida inteira fora da thread, com as grades derivadas e as áreas de
+// trabalho do tamanho do mapa. swapMatch() troca a partida da thread atual
+// com esta em O(1) (só troca os vetores), então uma partida pode ser
+// simulada por qualquer thread: troca, simula, troca de volta.
+struct EstadoPartida {
+    Mapa mapa;
+    std::vector<Jogador> jogadores;
+    bool player_won;
+    Inimigos inimigos;
+    std::vector<Bomba> bombas;
+    int tick_atual;
+    int enemy_move_counter;
+    uint64_t semente_partida;
+    uint32_t partida;
+    std::vector<int32_t> ocupacao;
+    std::vector<uint8_t> bombas_na_celula, marca;
+    std::vector<uint16_t> dist_perigo, dist_jogador;
+    std::vector<int> detonacao, perigo, fila, fila_jogador, fontes_por_linha;
+    std::vector<std::pair<uint32_t, uint8_t> > comandos; // de commandEnemy(), ainda não aplicados
+
+    EstadoPartida() : player_won(false), tick_atual(0), enemy_move_counter(0), semente_partida(1), partida(0) {}
+};
+
+void swapMatch(EstadoPartida& outra);
+
+#endif
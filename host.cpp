@@ -0,0 +1,284 @@
+/*
+ * Muitas partidas num processo, com roubo de trabalho (ver host.h)
+ */
+#include "host.h"
+#include "game.h"
+#include "net.h"
+#include "parallel.h"
+#include "rollback.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+namespace {
+
+// Deque de Chase-Lev com capacidade fixa: só a dona empilha e desempilha
+// (embaixo); as outras threads roubam do topo. Guarda índices de partida.
+class DequeRoubo {
+public:
+    static const int VAZIA = -1;
+
+    explicit DequeRoubo(size_t capacidade) : mascara(0), topo(0), fundo(0) {
+        size_t n = 1;
+        while (n < capacidade) n <<= 1;
+        itens.reset(new atomic<int>[n]);
+        mascara = n - 1;
+    }
+
+    void push(int v) {
+        int64_t b = fundo.load(memory_order_relaxed);
+        itens[b & mascara].store(v, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        fundo.store(b + 1, memory_order_relaxed);
+    }
+
+    int pop() {
+        int64_t b = fundo.load(memory_order_relaxed) - 1;
+        fundo.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t t = topo.load(memory_order_relaxed);
+        if (t > b) {
+            fundo.store(b + 1, memory_order_relaxed);
+            return VAZIA;
+        }
+        int v = itens[b & mascara].load(memory_order_relaxed);
+        if (t == b) {
+            // Último item: disputa com quem está roubando
+            if (!topo.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) v = VAZIA;
+            fundo.store(b + 1, memory_order_relaxed);
+        }
+        return v;
+    }
+
+    int steal() {
+        int64_t t = topo.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t b = fundo.load(memory_order_acquire);
+        if (t >= b) return VAZIA;
+        int v = itens[t & mascara].load(memory_order_relaxed);
+        if (!topo.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) return VAZIA;
+        return v;
+    }
+
+private:
+    unique_ptr<atomic<int>[]> itens;
+    size_t mascara;
+    // Em linhas de cache separadas: o topo é disputado pelos ladrões (com
+    // preenchimento, não alignas, que em C++11 o new não respeita)
+    char antes[64];
+    atomic<int64_t> topo;
+    char entre[64];
+    atomic<int64_t> fundo;
+    char depois[64];
+};
+
+struct PartidaHospedada {
+    EstadoPartida estado;
+    uint64_t gerador;        // bots
+    int quadro;              // ticks desde o começo da partida atual
+    vector<uint8_t> entradas;
+    EstatisticasPartida est;
+};
+
+// Bot: uma seta a cada ~4 ticks e de vez em quando uma bomba (como
+// bench_servidor, com as entradas de stepFrame())
+static uint8_t botInput(uint64_t& gerador) {
+    uint64_t r = splitmix64(gerador);
+    uint8_t e = r % 4 == 0 ? (uint8_t)(ACAO_CIMA + (r >> 8) % 4) : 0;
+    if ((r >> 16) % 32 == 0) e |= ENTRADA_BOMBA;
+    return e;
+}
+
+static void tickMatch(PartidaHospedada& p, int passo) {
+    swapMatch(p.estado);
+    for (size_t j = 0; j < p.entradas.size(); j++) p.entradas[j] = botInput(p.gerador);
+    stepFrame(&p.entradas[0], p.quadro++, passo);
+    if (player_won || !anyPlayerAlive()) {
+        // Gerador da partida: rand() é global e não é seguro entre threads
+        initMap(splitmix64(p.gerador));
+        p.quadro = 0;
+        p.est.reinicios++;
+    }
+    swapMatch(p.estado);
+}
+
+// Estado compartilhado entre o coordenador e as threads
+struct Pool {
+    vector<PartidaHospedada> partidas;
+    vector<unique_ptr<DequeRoubo> > deques;
+    int passo;
+
+    mutex m;
+    condition_variable cv_rodada, cv_fim;
+    atomic<uint64_t> rodada;   // número da rodada liberada (muda sob m)
+    bool encerrar;             // sob m
+    atomic<double> prazo;      // da rodada atual (escrito antes de liberá-la)
+    atomic<int> restantes;     // partidas da rodada ainda não simuladas
+    double fim_rodada;         // quando a última partida da rodada terminou (sob m)
+
+    vector<double> trabalho;   // por thread
+    vector<uint64_t> roubos;   // por thread
+
+    Pool() : passo(1), rodada(0), encerrar(false), prazo(0), restantes(0), fim_rodada(0) {}
+};
+
+static void workerLoop(Pool& pool, int w) {
+    const int n_threads = (int)pool.deques.size();
+    const int n_partidas = (int)pool.partidas.size();
+    DequeRoubo& minha = *pool.deques[w];
+    uint64_t gerador = 0x9E3779B97F4A7C15ULL * (w + 1);
+    uint64_t vista = 0;
+
+    for (;;) {
+        {
+            unique_lock<mutex> lock(pool.m);
+            pool.cv_rodada.wait(lock, [&] { return pool.encerrar || pool.rodada != vista; });
+            if (pool.encerrar) return;
+            vista = pool.rodada;
+        }
+        for (int i = w; i < n_partidas; i += n_threads) minha.push(i);
+
+        // Sai também se a próxima rodada já começou: uma thread que ficasse
+        // aqui nunca empilharia as partidas da casa dela
+        while (pool.restantes.load(memory_order_acquire) > 0 && pool.rodada.load() == vista) {
+            int p = minha.pop();
+            if (p == DequeRoubo::VAZIA) {
+                // Rouba de uma vítima sorteada, depois das seguintes
+                int inicio = (int)(splitmix64(gerador) % (uint64_t)n_threads);
+                for (int k = 0; k < n_threads && p == DequeRoubo::VAZIA; k++) {
+                    int v = (inicio + k) % n_threads;
+                    if (v != w) p = pool.deques[v]->steal();
+                }
+                if (p == DequeRoubo::VAZIA) {
+                    this_thread::yield(); // o resto está rodando em outras threads
+                    continue;
+                }
+                pool.roubos[w]++;
+            }
+
+            // A partida pode ser da rodada seguinte, então o prazo é lido aqui
+            const double prazo = pool.prazo.load();
+            PartidaHospedada& partida = pool.partidas[p];
+            double inicio = nowSeconds();
+            tickMatch(partida, pool.passo);
+            double fim = nowSeconds();
+
+            EstatisticasPartida& est = partida.est;
+            est.ticks++;
+            est.tempo_tick_max = max(est.tempo_tick_max, fim - inicio);
+            if (fim > prazo) {
+                est.atrasados++;
+                est.atraso_max = max(est.atraso_max, fim - prazo);
+            }
+            pool.trabalho[w] += fim - inicio;
+
+            if (pool.restantes.fetch_sub(1, memory_order_acq_rel) == 1) {
+                lock_guard<mutex> lock(pool.m);
+                pool.fim_rodada = fim;
+                pool.cv_fim.notify_one();
+            }
+        }
+    }
+}
+
+}
+
+uint64_t RelatorioHost::ticks() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < partidas.size(); i++) total += partidas[i].ticks;
+    return total;
+}
+
+uint64_t RelatorioHost::atrasados() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < partidas.size(); i++) total += partidas[i].atrasados;
+    return total;
+}
+
+double RelatorioHost::matchesPerCore(int hz) const {
+    uint64_t n = ticks();
+    if (n == 0 || trabalho <= 0) return 0;
+    return 1.0 / (trabalho / (double)n * hz);
+}
+
+bool runHost(const ConfigHost& cfg, const atomic<bool>& parar, RelatorioHost& relatorio) {
+    const int hz = cfg.hz > 0 ? cfg.hz : 20;
+    const double periodo = 1.0 / hz;
+    int n_threads = cfg.threads > 0 ? cfg.threads : (int)thread::hardware_concurrency();
+    if (n_threads <= 0) n_threads = 1;
+    if (cfg.partidas <= 0) return false;
+
+    // As partidas já rodam em paralelo entre si; devolve o número de threads no fim
+    const int threads_antes = workerCount();
+    setWorkerCount(1);
+
+    Pool pool;
+    pool.passo = max(1, (int)(0.4 * hz + 0.5));
+    pool.partidas.resize(cfg.partidas);
+    const int largura = gameMap.largura, altura = gameMap.altura;
+    for (int i = 0; i < cfg.partidas; i++) {
+        PartidaHospedada& p = pool.partidas[i];
+        p.gerador = 0xB0B0ULL + (uint64_t)i;
+        p.quadro = 0;
+        p.entradas.assign(max(1, cfg.jogadores), 0);
+        // Cria a partida no lugar da desta thread e devolve a desta
+        swapMatch(p.estado);
+        setMapSize(largura, altura);
+        jogadores.assign(p.entradas.size(), Jogador());
+        initMap(splitmix64(p.gerador));
+        swapMatch(p.estado);
+    }
+    for (int w = 0; w < n_threads; w++) pool.deques.push_back(unique_ptr<DequeRoubo>(new DequeRoubo(cfg.partidas)));
+    pool.trabalho.assign(n_threads, 0);
+    pool.roubos.assign(n_threads, 0);
+
+    vector<thread> threads;
+    for (int w = 0; w < n_threads; w++) threads.push_back(thread(workerLoop, ref(pool), w));
+
+    double comeco = nowSeconds(), proximo = comeco;
+    while (!parar) {
+        double agora = nowSeconds();
+        if (agora < proximo) {
+            sleepSeconds(proximo - agora);
+            continue;
+        }
+        // Atrasado mais de um tick (host sobrecarregado): não tenta compensar
+        proximo = agora - proximo > periodo ? agora + periodo : proximo + periodo;
+
+        pool.restantes.store(cfg.partidas, memory_order_release);
+        {
+            lock_guard<mutex> lock(pool.m);
+            pool.prazo.store(agora + periodo);
+            pool.rodada++;
+        }
+        pool.cv_rodada.notify_all();
+
+        unique_lock<mutex> lock(pool.m);
+        pool.cv_fim.wait(lock, [&] { return pool.restantes.load(memory_order_acquire) == 0; });
+        relatorio.rodada_max = max(relatorio.rodada_max, pool.fim_rodada - agora);
+        relatorio.rodadas++;
+    }
+
+    {
+        lock_guard<mutex> lock(pool.m);
+        pool.encerrar = true;
+    }
+    pool.cv_rodada.notify_all();
+    for (size_t w = 0; w < threads.size(); w++) threads[w].join();
+
+    relatorio.threads = n_threads;
+    relatorio.duracao = nowSeconds() - comeco;
+    relatorio.trabalho = 0;
+    relatorio.roubos = 0;
+    for (int w = 0; w < n_threads; w++) {
+        relatorio.trabalho += pool.trabalho[w];
+        relatorio.roubos += pool.roubos[w];
+    }
+    relatorio.partidas.resize(cfg.partidas);
+    for (int i = 0; i < cfg.partidas; i++) relatorio.partidas[i] = pool.partidas[i].est;
+    setWorkerCount(threads_antes);
+    return true;
+}
@@ -0,0 +1,62 @@
+/*
+ * Muitas partidas independentes num processo só (sem OpenGL)
+ *
+ * Cada partida é um EstadoPartida (game.h) com jogadores controlados por bots,
+ * e todas avançam um tick a cada 1/hz segundos. O trabalho de cada tick é
+ * dividido por um pool de threads com deques de roubo de trabalho: cada thread
+ * começa pelas partidas "da casa" (índice % threads, que ficam quentes no
+ * mesmo cache) e, quando a sua deque esvazia, rouba do topo da deque de outra,
+ * então uma partida cara não atrasa as vizinhas. Cada tick de cada partida tem
+ * um prazo (o começo do próximo tick); os atrasos são contados por partida.
+ */
+#ifndef HOST_H
+#define HOST_H
+
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+struct ConfigHost {
+    int partidas;
+    int threads;    // 0 = número de núcleos
+    int hz;         // ticks por segundo de cada partida (regras a cada 0,4 s, como no servidor)
+    int jogadores;  // bots por partida
+
+    ConfigHost() : partidas(64), threads(0), hz(20), jogadores(4) {}
+};
+
+struct EstatisticasPartida {
+    uint64_t ticks;
+    uint64_t atrasados;    // ticks terminados depois do prazo
+    uint64_t reinicios;    // partidas que acabaram e recomeçaram
+    double atraso_max;     // segundos além do prazo
+    double tempo_tick_max; // segundos de trabalho num tick
+
+    EstatisticasPartida() : ticks(0), atrasados(0), reinicios(0), atraso_max(0), tempo_tick_max(0) {}
+};
+
+struct RelatorioHost {
+    int threads;
+    uint64_t rodadas;     // ticks do host (todas as partidas)
+    uint64_t roubos;      // partidas tiradas da deque de outra thread
+    double duracao;       // segundos de relógio
+    double trabalho;      // segundos simulando, somados entre as threads
+    double rodada_max;    // rodada mais demorada, do começo do tick até a última partida
+    std::vector<EstatisticasPartida> partidas;
+
+    RelatorioHost() : threads(0), rodadas(0), roubos(0), duracao(0), trabalho(0), rodada_max(0) {}
+
+    uint64_t ticks() const;
+    uint64_t atrasados() const;
+    // Partidas que um núcleo aguenta nesse hz, pelo custo médio de um tick
+    double matchesPerCore(int hz) const;
+};
+
+// Roda até *parar ficar true. Todas as partidas usam o tamanho de mapa e as
+// opções de geração da thread que chama (setMapSize, num_inimigos, ...). Cada
+// partida roda numa thread por vez, então o parallelFor() dos inimigos fica
+// com uma thread só enquanto o host roda (o workerCount() anterior volta no
+// fim). Cada partida gera e reinicia o mapa com o próprio gerador, sem rand().
+bool runHost(const ConfigHost& cfg, const std::atomic<bool>& parar, RelatorioHost& relatorio);
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Gerador de mapas com semente
+ *
+ * O layout segue o clássico: borda e pilares (x e z pares) são paredes fixas.
+ * As células com x e z ímpares são "salas" e as demais (uma coordenada par)
+ * são passagens entre duas salas vizinhas. Paredes extras só entram em
+ * passagens, então a conectividade se resume a um grafo de salas; uma passada
+ * de union-find reabre (como bloco destrutível) toda parede extra que separa
+ * duas regiões.
+ */
+#include "mapgen.h"
+#include "parallel.h"
+#include <vector>
+using namespace std;
+
+static inline bool isPillar(int x, int z) { return (x & 1) == 0 && (z & 1) == 0; }
+
+// Union-find das salas (união por posto, compressão de caminho por divisão ao meio)
+static int findRoot(vector<int32_t>& pai, int a) {
+    while (pai[a] != a) {
+        pai[a] = pai[pai[a]];
+        a = pai[a];
+    }
+    return a;
+}
+
+static bool unite(vector<int32_t>& pai, int a, int b) {
+    a = findRoot(pai, a);
+    b = findRoot(pai, b);
+    if (a == b) return false;
+    if (a < b) pai[b] = a; else pai[a] = b;
+    return true;
+}
+
+// Reabre paredes extras até todas as salas ficarem na mesma região
+static void connectRooms(Mapa& mapa) {
+    const int salas_x = (mapa.largura - 1) / 2, salas_z = (mapa.altura - 1) / 2;
+    // Reaproveitado entre mapas do mesmo tamanho: recomeçar a partida não aloca
+    static thread_local vector<int32_t> pai;
+    pai.resize((size_t)salas_x * salas_z);
+    for (size_t i = 0; i < pai.size(); i++) pai[i] = (int32_t)i;
+
+    // Passagens abertas (livres ou com bloco) já ligam as salas
+    for (int sz = 0; sz < salas_z; sz++) {
+        for (int sx = 0; sx < salas_x; sx++) {
+            int x = 2 * sx + 1, z = 2 * sz + 1, sala = sz * salas_x + sx;
+            if (sx + 1 < salas_x && mapa.celulas[mapa.index(x + 1, z)] != CELULA_PAREDE) unite(pai, sala, sala + 1);
+            if (sz + 1 < salas_z && mapa.celulas[mapa.index(x, z + 1)] != CELULA_PAREDE) unite(pai, sala, sala + salas_x);
+        }
+    }
+
+    // Como o pai tem sempre índice menor que o filho, uma passada em ordem
+    // crescente aponta cada sala direto para a raiz e as buscas abaixo ficam
+    // com um salto só
+    for (size_t i = 0; i < pai.size(); i++) pai[i] = pai[pai[i]];
+
+    // Cada parede extra entre regiões diferentes vira bloco. Como o grafo com
+    // todas as passagens abertas é conexo, uma passada basta.
+    for (int sz = 0; sz < salas_z; sz++) {
+        for (int sx = 0; sx < salas_x; sx++) {
+            int x = 2 * sx + 1, z = 2 * sz + 1, sala = sz * salas_x + sx;
+            if (sx + 1 < salas_x) {
+                uint8_t& passagem = mapa.celulas[mapa.index(x + 1, z)];
+                if (passagem == CELULA_PAREDE && unite(pai, sala, sala + 1)) passagem = CELULA_BLOCO;
+            }
+            if (sz + 1 < salas_z) {
+                uint8_t& passagem = mapa.celulas[mapa.index(x, z + 1)];
+                if (passagem == CELULA_PAREDE && unite(pai, sala, sala + salas_x)) passagem = CELULA_BLOCO;
+            }
+        }
+    }
+}
+
+void clearSpawnPocket(Mapa& mapa, int px, int pz) {
+    static const int DX[4] = { 1, -1, 0, 0 };
+    static const int DZ[4] = { 0, 0, 1, -1 };
+    if (px < 1 || pz < 1 || px > mapa.largura - 2 || pz > mapa.altura - 2) return;
+
+    mapa.set(px, pz, CELULA_VAZIA);
+    for (int d = 0; d < 4; d++) {
+        for (int k = 1; k <= 2; k++) {
+            int x = px + DX[d] * k, z = pz + DZ[d] * k;
+            if (x < 1 || z < 1 || x > mapa.largura - 2 || z > mapa.altura - 2 || isPillar(x, z)) break;
+            mapa.set(x, z, CELULA_VAZIA);
+        }
+    }
+}
+
+void generateMap(Mapa& mapa, const ParametrosMapa& p, int jogador_x, int jogador_z) {
+    if (mapa.largura != p.largura || mapa.altura != p.altura)
+        mapa.resize(p.largura, p.altura);
+
+    const int largura = mapa.largura, altura = mapa.altura;
+    // Limiares sobre 8 bits aleatórios
+    const unsigned limiar_bloco = (unsigned)p.densidade_blocos * 256 / 100;
+    const unsigned limiar_parede = (unsigned)p.densidade_paredes * 256 / 100;
+    Mapa* destino = &mapa;
+
+    // Cada linha tem o próprio gerador (semente + z), então as linhas podem ser
+    // preenchidas em paralelo sem mudar o resultado. As células são escritas
+    // direto no vetor; as revisões são marcadas de uma vez no final.
+    auto preencher = [=](size_t inicio, size_t fim) {
+        for (size_t lz = inicio; lz < fim; lz++) {
+            int z = (int)lz;
+            uint64_t estado = p.semente ^ ((uint64_t)z * 0xD1B54A32D192ED03ULL);
+            uint64_t bits = 0;
+            int restantes = 0;
+            bool linha_de_parede = z == 0 || z == altura - 1;
+            bool linha_par = (z & 1) == 0;
+
+            // A linha é escrita em trechos de MAPA_TILE células contíguas
+            for (int x0 = 0; x0 < largura; x0 += MAPA_TILE) {
+                uint8_t* celula = &destino->celulas[destino->index(x0, z)];
+                int x_fim = x0 + MAPA_TILE < largura ? x0 + MAPA_TILE : largura;
+                for (int x = x0; x < x_fim; x++, celula++) {
+                    bool coluna_par = (x & 1) == 0;
+                    if (linha_de_parede || x == 0 || x == largura - 1 || (linha_par && coluna_par)) {
+                        *celula = CELULA_PAREDE;
+                        continue;
+                    }
+                    if (restantes == 0) {
+                        bits = splitmix64(estado);
+                        restantes = 4;
+                    }
+                    unsigned b = (unsigned)(bits & 0xFF), w = (unsigned)((bits >> 8) & 0xFF);
+                    bits >>= 16;
+                    restantes--;
+
+                    // Sem desvios: as duas comparações são aleatórias e errariam a predição
+                    unsigned bloco = b < limiar_bloco;
+                    unsigned parede = (linha_par || coluna_par) & (w < limiar_parede);
+                    *celula = (uint8_t)(parede ? (unsigned)CELULA_PAREDE : bloco * CELULA_BLOCO);
+                }
+            }
+        }
+    };
+    // O std::function do parallelFor() guarda só a referência sem alocar (as
+    // cópias capturadas por 'preencher' não caberiam nele)
+    parallelFor((size_t)altura, 64, [&preencher](size_t inicio, size_t fim) { preencher(inicio, fim); });
+    if (p.densidade_paredes > 0) connectRooms(mapa);
+    mapa.touchAll();
+
+    clearSpawnPocket(mapa, jogador_x, jogador_z);
+}
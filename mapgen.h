@@ -0,0 +1,28 @@
+/*
+ * Gerador de mapas com semente: pilares fixos, blocos destrutíveis com a
+ * densidade escolhida e paredes extras opcionais, sempre com o mapa conexo
+ */
+#ifndef MAPGEN_H
+#define MAPGEN_H
+
+#include "game.h"
+
+struct ParametrosMapa {
+    int largura, altura;
+    int densidade_blocos;  // % das células livres que viram blocos destrutíveis
+    int densidade_paredes; // % das passagens entre pilares que viram paredes fixas
+    uint64_t semente;
+};
+
+// Gera o mapa (redimensionando-o se preciso). O mesmo conjunto de parâmetros
+// sempre gera o mesmo mapa. Toda célula que não é parede alcança qualquer
+// outra, no máximo passando por blocos destrutíveis, e as células em volta de
+// (jogador_x, jogador_z) ficam livres para o jogador plantar a primeira bomba
+// e fugir dela.
+void generateMap(Mapa& mapa, const ParametrosMapa& p, int jogador_x, int jogador_z);
+
+// Libera a célula (px, pz) e até 2 células em cada direção, para que um
+// jogador que nasce ali possa plantar uma bomba e sair do alcance dela
+void clearSpawnPocket(Mapa& mapa, int px, int pz);
+
+#endif
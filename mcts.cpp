@@ -0,0 +1,226 @@
+/*
+ * Bot por busca em árvore Monte Carlo (ver mcts.h)
+ */
+#include "mcts.h"
+#include "stats.h"
+#include <chrono>
+#include <cmath>
+using namespace std;
+
+static double nowSecondsMcts() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int findEnemy(uint32_t id) {
+    const Inimigos& inimigos = ::inimigos;
+    for (size_t i = 0; i < inimigos.size(); i++)
+        if (inimigos.id[i] == id) return (int)i;
+    return -1;
+}
+
+static size_t livePlayers() {
+    size_t n = 0;
+    for (size_t j = 0; j < jogadores.size(); j++)
+        if (jogadores[j].ativo && jogadores[j].vivo) n++;
+    return n;
+}
+
+int BuscaMcts::newNode() {
+    if ((int)nos.size() >= max_nos) return -1;
+    No n;
+    for (int a = 0; a < NUM_ACOES; a++) n.filho[a] = -1;
+    n.visitas = 0;
+    n.soma = 0;
+    n.legais = 0;
+    nos.push_back(n);
+    return (int)nos.size() - 1;
+}
+
+// Política das jogadas ao acaso: anda ou fica, e bomba de vez em quando
+int BuscaMcts::rolloutAction() {
+    uint64_t r = splitmix64(gerador);
+    if (r % 10 == 0) return ACAO_BOMBA;
+    return (int)((r >> 8) % ACAO_BOMBA); // ACAO_NENHUMA .. ACAO_DIREITA
+}
+
+uint8_t BuscaMcts::legalActions(const AgenteMcts& agente) const {
+    static const int DX[NUM_ACOES] = { 0, 0, 0, -1, 1, 0 };
+    static const int DZ[NUM_ACOES] = { 0, -1, 1, 0, 0, 0 };
+    int x, z;
+    bool pode_bomba;
+    if (agente.jogador >= 0) {
+        x = jogadores[agente.jogador].x;
+        z = jogadores[agente.jogador].z;
+        pode_bomba = !hasActiveBomb(agente.jogador) && !hasBomb(x, z);
+    } else {
+        int i = findEnemy(agente.inimigo);
+        if (i < 0) return 1 << ACAO_NENHUMA;
+        x = inimigos.x[i];
+        z = inimigos.z[i];
+        pode_bomba = !hasBomb(x, z);
+    }
+
+    uint8_t legais = 1 << ACAO_NENHUMA;
+    for (int a = ACAO_CIMA; a <= ACAO_DIREITA; a++) {
+        int nx = x + DX[a], nz = z + DZ[a];
+        if (gameMap.at(nx, nz) == CELULA_VAZIA && !hasBomb(nx, nz) && enemyAt(nx, nz) < 0) legais |= 1 << a;
+    }
+    if (pode_bomba) legais |= 1 << ACAO_BOMBA;
+    return legais;
+}
+
+bool BuscaMcts::over(const AgenteMcts& agente) const {
+    if (player_won || !anyPlayerAlive()) return true;
+    if (agente.jogador >= 0) return !jogadores[agente.jogador].vivo;
+    return findEnemy(agente.inimigo) < 0;
+}
+
+void BuscaMcts::playMove(const AgenteMcts& agente, int acao) {
+    for (size_t j = 0; j < jogadores.size(); j++)
+        if ((int)j != agente.jogador && jogadores[j].ativo && jogadores[j].vivo) applyAction((int)j, rolloutAction());
+
+    if (agente.jogador >= 0) {
+        applyAction(agente.jogador, acao);
+        stepGame();
+        ticks++;
+    } else {
+        // O comando vale no próximo movimento dos inimigos (um a cada 2 ticks)
+        commandEnemy(agente.inimigo, acao);
+        for (int t = 0; t < 2 && !player_won && anyPlayerAlive(); t++) {
+            stepGame();
+            ticks++;
+        }
+    }
+}
+
+// 0 = agente morto, 1 = venceu; no meio, quanto o agente avançou, menos um
+// tanto se estiver na área de uma explosão armada
+float BuscaMcts::evaluate(const AgenteMcts& agente) const {
+    int x, z;
+    float v;
+    if (agente.jogador >= 0) {
+        const Jogador& eu = jogadores[agente.jogador];
+        if (!eu.vivo) return 0.0f;
+        if (player_won) return 1.0f;
+        size_t mortos = inimigos_iniciais - inimigos.size();
+        v = 0.5f + 0.4f * (float)mortos / (float)(inimigos_iniciais ? inimigos_iniciais : 1);
+        x = eu.x;
+        z = eu.z;
+    } else {
+        int i = findEnemy(agente.inimigo);
+        if (i < 0) return 0.0f;
+        if (!anyPlayerAlive()) return 1.0f;
+        size_t mortos = jogadores_vivos_iniciais - livePlayers();
+        v = 0.5f + 0.4f * (float)mortos / (float)(jogadores_vivos_iniciais ? jogadores_vivos_iniciais : 1);
+        x = inimigos.x[i];
+        z = inimigos.z[i];
+    }
+    if (ticksToExplosion(x, z) >= 0) v -= 0.2f;
+    return v;
+}
+
+int BuscaMcts::search(const AgenteMcts& agente, const ConfigMcts& cfg, ResultadoMcts* resultado) {
+    double inicio = nowSecondsMcts();
+    PausaEstatisticas pausa; // as simulações não são ticks da partida
+    snapshot(raiz);
+    gerador = cfg.semente ^ ((uint64_t)tick_atual << 32);
+    ticks = 0;
+    max_nos = cfg.max_nos > 1 ? cfg.max_nos : 2;
+    inimigos_iniciais = inimigos.size();
+    jogadores_vivos_iniciais = livePlayers();
+    nos.clear();
+    nos.reserve(max_nos);
+    newNode();
+    nos[0].legais = legalActions(agente);
+
+    int simulacoes = 0;
+    if (!over(agente)) {
+        for (;;) {
+            if (cfg.max_simulacoes > 0 && simulacoes >= cfg.max_simulacoes) break;
+            if (cfg.orcamento > 0 && simulacoes > 0 && nowSecondsMcts() - inicio >= cfg.orcamento) break;
+            if (cfg.max_simulacoes <= 0 && cfg.orcamento <= 0) break;
+            if (simulacoes > 0) restore(raiz);
+
+            // Seleção e expansão
+            caminho.clear();
+            caminho.push_back(0);
+            int no = 0;
+            while (!over(agente)) {
+                No& atual = nos[no];
+                int escolhida = -1;
+                // Primeiro as jogadas legais que ainda não foram abertas
+                int abertas = 0;
+                for (int a = 0; a < NUM_ACOES; a++) {
+                    if (!(atual.legais & (1 << a))) continue;
+                    if (atual.filho[a] < 0) {
+                        escolhida = a;
+                        break;
+                    }
+                    abertas++;
+                }
+                if (escolhida < 0 && abertas > 0) {
+                    double log_n = log((double)atual.visitas + 1.0), melhor = -1.0;
+                    for (int a = 0; a < NUM_ACOES; a++) {
+                        int f = atual.filho[a];
+                        if (f < 0) continue;
+                        const No& filho = nos[f];
+                        double uct = filho.soma / (filho.visitas + 1e-9) +
+                                     cfg.exploracao * sqrt(log_n / (filho.visitas + 1e-9));
+                        if (uct > melhor) {
+                            melhor = uct;
+                            escolhida = a;
+                        }
+                    }
+                }
+                if (escolhida < 0) break;
+
+                playMove(agente, escolhida);
+                if (nos[no].filho[escolhida] >= 0) {
+                    no = nos[no].filho[escolhida];
+                    caminho.push_back(no);
+                    continue;
+                }
+                int novo = newNode();
+                if (novo >= 0) {
+                    nos[no].filho[escolhida] = novo;
+                    nos[novo].legais = over(agente) ? 0 : legalActions(agente);
+                    caminho.push_back(novo);
+                }
+                break;
+            }
+
+            // Jogadas ao acaso a partir da folha
+            for (int d = 0; d < cfg.profundidade && !over(agente); d++) playMove(agente, rolloutAction());
+
+            float v = evaluate(agente);
+            for (size_t k = 0; k < caminho.size(); k++) {
+                nos[caminho[k]].visitas++;
+                nos[caminho[k]].soma += v;
+            }
+            simulacoes++;
+        }
+        restore(raiz);
+    }
+
+    // A mais visitada (a mais robusta); sem simulações, fica parado
+    int acao = ACAO_NENHUMA;
+    uint32_t mais = 0;
+    for (int a = 0; a < NUM_ACOES; a++) {
+        int f = nos[0].filho[a];
+        if (f >= 0 && nos[f].visitas > mais) {
+            mais = nos[f].visitas;
+            acao = a;
+        }
+    }
+
+    if (resultado) {
+        resultado->acao = acao;
+        resultado->simulacoes = simulacoes;
+        resultado->ticks = ticks;
+        resultado->tempo = nowSecondsMcts() - inicio;
+        int f = nos[0].filho[acao];
+        resultado->valor = f >= 0 && nos[f].visitas ? nos[f].soma / nos[f].visitas : 0.0;
+        resultado->nos = (int)nos.size();
+    }
+    return acao;
+}
@@ -0,0 +1,83 @@
+/*
+ * Bot por busca em árvore Monte Carlo (MCTS) sobre as regras do jogo (sem OpenGL)
+ *
+ * Cada simulação volta à foto da partida (restore()), desce pela árvore de
+ * jogadas escolhendo pelo UCT, abre uma jogada nova, joga mais algumas ao acaso
+ * e avalia o resultado. As regras são determinísticas (os inimigos sorteiam a
+ * partir de semente_partida), então a árvore vê exatamente o que vai acontecer
+ * com o agente; outros jogadores jogam ao acaso. Quanto mais simulações por
+ * segundo as regras aguentam, melhor a jogada no mesmo orçamento de tempo.
+ *
+ * O agente é um jogador (uma jogada = uma ação e um tick das regras) ou um
+ * inimigo (uma jogada = um comando por commandEnemy() e os 2 ticks até o
+ * próximo movimento dos inimigos).
+ */
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "game.h"
+#include <vector>
+#include <stdint.h>
+
+struct AgenteMcts {
+    int jogador;        // >= 0: o jogador controlado
+    uint32_t inimigo;   // com jogador < 0: id do inimigo controlado
+
+    static AgenteMcts player(int j) { AgenteMcts a; a.jogador = j; a.inimigo = 0; return a; }
+    static AgenteMcts enemy(uint32_t id) { AgenteMcts a; a.jogador = -1; a.inimigo = id; return a; }
+};
+
+struct ConfigMcts {
+    double orcamento;    // segundos por jogada (0 = sem limite de tempo)
+    int max_simulacoes;  // 0 = sem limite (só o tempo); com limite e sem tempo, a busca é reprodutível
+    int profundidade;    // jogadas ao acaso depois de sair da árvore
+    int max_nos;         // limite da árvore; cheia, as simulações só jogam ao acaso
+    double exploracao;   // constante do UCT
+    uint64_t semente;
+
+    ConfigMcts() : orcamento(0.05), max_simulacoes(0), profundidade(12), max_nos(1 << 16), exploracao(0.7),
+                   semente(1) {}
+};
+
+struct ResultadoMcts {
+    int acao;            // Acao escolhida (a mais visitada)
+    int simulacoes;
+    uint64_t ticks;      // ticks das regras simulados
+    double tempo;        // segundos
+    double valor;        // avaliação média da jogada escolhida, em [0, 1]
+    int nos;
+
+    ResultadoMcts() : acao(ACAO_NENHUMA), simulacoes(0), ticks(0), tempo(0), valor(0), nos(0) {}
+};
+
+class BuscaMcts {
+public:
+    // Melhor jogada do agente na partida desta thread, que fica como estava.
+    // Reaproveita a árvore e a foto entre chamadas (sem alocar depois da primeira).
+    int search(const AgenteMcts& agente, const ConfigMcts& cfg, ResultadoMcts* resultado = 0);
+
+private:
+    struct No {
+        int32_t filho[NUM_ACOES]; // -1 = ainda não aberto
+        uint32_t visitas;
+        float soma;               // soma das avaliações
+        uint8_t legais;           // bit por Acao, visto na primeira visita
+    };
+
+    int newNode();
+    int rolloutAction();
+    uint8_t legalActions(const AgenteMcts& agente) const;
+    bool over(const AgenteMcts& agente) const;
+    void playMove(const AgenteMcts& agente, int acao);
+    float evaluate(const AgenteMcts& agente) const;
+
+    std::vector<No> nos;
+    std::vector<int> caminho;
+    GameState raiz;
+    uint64_t gerador;
+    uint64_t ticks;
+    int max_nos;
+    size_t inimigos_iniciais, jogadores_vivos_iniciais;
+};
+
+#endif
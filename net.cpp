@@ -0,0 +1,108 @@
+/*
+ * Sockets UDP não bloqueantes (POSIX ou Winsock)
+ */
+#include "net.h"
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+bool netInit() {
+#ifdef _WIN32
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    return true;
+#endif
+}
+
+SocketUdp udpOpen(uint16_t porta) {
+    SocketUdp s = (SocketUdp)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == SOCKET_INVALIDO) return SOCKET_INVALIDO;
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(porta);
+    if (bind(s, (sockaddr*)&local, sizeof(local)) != 0) {
+        udpClose(s);
+        return SOCKET_INVALIDO;
+    }
+
+#ifdef _WIN32
+    u_long nao_bloqueante = 1;
+    ioctlsocket(s, FIONBIO, &nao_bloqueante);
+#else
+    fcntl((int)s, F_SETFL, fcntl((int)s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    return s;
+}
+
+void udpClose(SocketUdp s) {
+    if (s == SOCKET_INVALIDO) return;
+#ifdef _WIN32
+    closesocket(s);
+#else
+    close((int)s);
+#endif
+}
+
+void udpSetBuffers(SocketUdp s, int bytes) {
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char*)&bytes, sizeof(bytes));
+    setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char*)&bytes, sizeof(bytes));
+}
+
+uint16_t udpLocalPort(SocketUdp s) {
+    sockaddr_in local;
+    socklen_t tam = sizeof(local);
+    if (getsockname(s, (sockaddr*)&local, &tam) != 0) return 0;
+    return ntohs(local.sin_port);
+}
+
+bool udpSend(SocketUdp s, const EnderecoUdp& para, const void* dados, size_t n) {
+    sockaddr_in destino;
+    memset(&destino, 0, sizeof(destino));
+    destino.sin_family = AF_INET;
+    destino.sin_addr.s_addr = htonl(para.ip);
+    destino.sin_port = htons(para.porta);
+    return sendto(s, (const char*)dados, (int)n, 0, (sockaddr*)&destino, sizeof(destino)) == (int)n;
+}
+
+int udpRecv(SocketUdp s, EnderecoUdp& de, void* dados, size_t max) {
+    sockaddr_in origem;
+    socklen_t tam = sizeof(origem);
+    int n = (int)recvfrom(s, (char*)dados, (int)max, 0, (sockaddr*)&origem, &tam);
+    if (n < 0) return -1;
+    de.ip = ntohl(origem.sin_addr.s_addr);
+    de.porta = ntohs(origem.sin_port);
+    return n;
+}
+
+bool parseAddress(const char* texto, EnderecoUdp& endereco) {
+    unsigned a, b, c, d, porta;
+    if (sscanf(texto, "%u.%u.%u.%u:%u", &a, &b, &c, &d, &porta) != 5) return false;
+    if (a > 255 || b > 255 || c > 255 || d > 255 || porta == 0 || porta > 65535) return false;
+    endereco.ip = (a << 24) | (b << 16) | (c << 8) | d;
+    endereco.porta = (uint16_t)porta;
+    return true;
+}
+
+double nowSeconds() {
+    using namespace std::chrono;
+    return duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count();
+}
+
+void sleepSeconds(double s) {
+    if (s > 0) std::this_thread::sleep_for(std::chrono::duration<double>(s));
+}
@@ -0,0 +1,81 @@
+/*
+ * Sockets UDP não bloqueantes (POSIX ou Winsock) e buffers de bytes para as
+ * mensagens da rede
+ */
+#ifndef NET_H
+#define NET_H
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+typedef intptr_t SocketUdp;
+const SocketUdp SOCKET_INVALIDO = -1;
+
+// Endereço IPv4 (ip e porta na ordem do host)
+struct EnderecoUdp {
+    uint32_t ip;
+    uint16_t porta;
+
+    EnderecoUdp() : ip(0), porta(0) {}
+    bool operator==(const EnderecoUdp& o) const { return ip == o.ip && porta == o.porta; }
+};
+
+const size_t TAMANHO_MAX_DATAGRAMA = 65507;
+
+bool netInit();
+SocketUdp udpOpen(uint16_t porta);  // 0 = porta qualquer; SOCKET_INVALIDO se falhar
+void udpClose(SocketUdp s);
+void udpSetBuffers(SocketUdp s, int bytes); // buffers de envio e recepção do sistema
+uint16_t udpLocalPort(SocketUdp s);
+bool udpSend(SocketUdp s, const EnderecoUdp& para, const void* dados, size_t n);
+int udpRecv(SocketUdp s, EnderecoUdp& de, void* dados, size_t max); // -1 se não há nada
+bool parseAddress(const char* texto, EnderecoUdp& endereco);       // "127.0.0.1:27015"
+
+double nowSeconds(); // relógio monotônico
+void sleepSeconds(double s);
+
+// Escrita de inteiros little-endian num buffer de tamanho fixo. Se faltar
+// espaço, 'estourou' fica true e o resto é ignorado.
+struct Escritor {
+    uint8_t* dados;
+    size_t cap, tam;
+    bool estourou;
+
+    Escritor(uint8_t* buf, size_t capacidade) : dados(buf), cap(capacidade), tam(0), estourou(false) {}
+
+    void bytes(const void* p, size_t n) {
+        if (tam + n > cap) { estourou = true; return; }
+        memcpy(dados + tam, p, n);
+        tam += n;
+    }
+    void u8(uint8_t v) { bytes(&v, 1); }
+    void u16(uint16_t v) { uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) }; bytes(b, 2); }
+    void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); }
+};
+
+// Leitura correspondente; 'erro' fica true se a mensagem acabar antes da hora
+struct Leitor {
+    const uint8_t* dados;
+    size_t tam, pos;
+    bool erro;
+
+    Leitor(const uint8_t* buf, size_t n) : dados(buf), tam(n), pos(0), erro(false) {}
+
+    bool bytes(void* p, size_t n) {
+        if (pos + n > tam) { erro = true; return false; }
+        memcpy(p, dados + pos, n);
+        pos += n;
+        return true;
+    }
+    const uint8_t* skip(size_t n) {
+        if (pos + n > tam) { erro = true; return 0; }
+        pos += n;
+        return dados + pos - n;
+    }
+    uint8_t u8() { uint8_t v = 0; bytes(&v, 1); return v; }
+    uint16_t u16() { uint8_t b[2] = { 0, 0 }; bytes(b, 2); return (uint16_t)(b[0] | (b[1] << 8)); }
+    uint32_t u32() { uint32_t lo = u16(); return lo | ((uint32_t)u16() << 16); }
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Pool de threads simples para laços paralelos da simulação
+ */
+#include "parallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace {
+
+// Verdadeiro nas threads do pool e na que chamou enquanto roda blocos: um
+// parallelFor() de dentro de outro (inimigos de uma partida de um lote) roda
+// direto na thread, porque o pool só faz uma rodada por vez
+thread_local bool dentro_do_pool = false;
+
+struct Pool {
+    vector<thread> threads;
+    mutex m;
+    condition_variable cv_trabalho, cv_fim;
+
+    // Trabalho atual (válido enquanto pendentes > 0)
+    const function<void(size_t, size_t)>* fn;
+    size_t n, bloco;
+    atomic<size_t> proximo;
+    size_t pendentes;       // threads auxiliares que ainda não terminaram a rodada
+    unsigned long rodada;   // incrementada a cada parallelFor()
+    bool encerrar;
+
+    Pool() : fn(0), n(0), bloco(1), proximo(0), pendentes(0), rodada(0), encerrar(false) {}
+
+    ~Pool() { resize(0); }
+
+    // Pega blocos até acabarem
+    void runChunks() {
+        for (;;) {
+            size_t inicio = proximo.fetch_add(bloco);
+            if (inicio >= n) break;
+            size_t fim = inicio + bloco < n ? inicio + bloco : n;
+            (*fn)(inicio, fim);
+        }
+    }
+
+    void workerLoop() {
+        dentro_do_pool = true;
+        unsigned long vista = 0;
+        for (;;) {
+            {
+                unique_lock<mutex> lock(m);
+                cv_trabalho.wait(lock, [&] { return encerrar || rodada != vista; });
+                if (encerrar) return;
+                vista = rodada;
+            }
+            runChunks();
+            {
+                lock_guard<mutex> lock(m);
+                if (--pendentes == 0) cv_fim.notify_one();
+            }
+        }
+    }
+
+    // Ajusta o número de threads auxiliares (a thread que chama também trabalha)
+    void resize(size_t auxiliares) {
+        {
+            lock_guard<mutex> lock(m);
+            encerrar = true;
+        }
+        cv_trabalho.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+        threads.clear();
+        encerrar = false;
+        for (size_t i = 0; i < auxiliares; i++)
+            threads.push_back(thread(&Pool::workerLoop, this));
+    }
+
+    void run(size_t total, size_t tam_bloco, const function<void(size_t, size_t)>& f) {
+        {
+            lock_guard<mutex> lock(m);
+            fn = &f;
+            n = total;
+            bloco = tam_bloco;
+            proximo = 0;
+            pendentes = threads.size();
+            rodada++;
+        }
+        cv_trabalho.notify_all();
+        dentro_do_pool = true;
+        runChunks();
+        dentro_do_pool = false;
+
+        unique_lock<mutex> lock(m);
+        cv_fim.wait(lock, [&] { return pendentes == 0; });
+    }
+};
+
+Pool pool;
+int num_threads = 1;
+
+}
+
+void setWorkerCount(int n) {
+    if (n <= 0) n = (int)thread::hardware_concurrency();
+    if (n <= 0) n = 1;
+    num_threads = n;
+    pool.resize((size_t)(n - 1));
+}
+
+int workerCount() {
+    return num_threads;
+}
+
+void parallelFor(size_t n, size_t bloco, const function<void(size_t, size_t)>& fn) {
+    if (bloco == 0) bloco = 1;
+    // Pouco trabalho ou sem threads auxiliares: roda direto na thread atual
+    if (pool.threads.empty() || n <= bloco || dentro_do_pool) {
+        for (size_t inicio = 0; inicio < n; inicio += bloco)
+            fn(inicio, inicio + bloco < n ? inicio + bloco : n);
+        return;
+    }
+    pool.run(n, bloco, fn);
+}
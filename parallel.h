@@ -0,0 +1,20 @@
+/*
+ * Pool de threads simples para laços paralelos da simulação
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+// Define quantas threads (incluindo a que chama) executam parallelFor().
+// 0 usa o número de núcleos da máquina.
+void setWorkerCount(int n);
+int workerCount();
+
+// Executa fn(inicio, fim) sobre [0, n) dividido em blocos de 'bloco' itens.
+// Retorna só quando todos os blocos terminaram. A ordem em que os blocos rodam
+// não é definida, então fn não deve depender dela.
+void parallelFor(size_t n, size_t bloco, const std::function<void(size_t, size_t)>& fn);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Protocolo da partida em rede
+ */
+#include "protocol.h"
+#include <cstdio>
+using namespace std;
+
+void writeHeader(Escritor& e, uint8_t tipo) {
+    e.u32(PROTOCOLO_MAGICO);
+    e.u8(tipo);
+}
+
+bool readHeader(Leitor& l, uint8_t& tipo) {
+    uint32_t magico = l.u32();
+    tipo = l.u8();
+    return !l.erro && magico == PROTOCOLO_MAGICO;
+}
+
+size_t writeFragment(uint8_t* buf, size_t cap, const FragmentoEstado& f) {
+    Escritor e(buf, cap);
+    writeHeader(e, MSG_ESTADO);
+    e.u32(f.seq);
+    e.u32(f.ultima_entrada);
+    e.u16((uint16_t)f.parte);
+    e.u16((uint16_t)f.partes);
+    e.bytes(f.dados, f.tam);
+    return e.estourou ? 0 : e.tam;
+}
+
+bool readFragment(Leitor& l, FragmentoEstado& f) {
+    f.seq = l.u32();
+    f.ultima_entrada = l.u32();
+    f.parte = l.u16();
+    f.partes = l.u16();
+    f.tam = l.erro ? 0 : l.tam - l.pos;
+    f.dados = l.skip(f.tam);
+    return !l.erro && f.partes > 0 && f.parte < f.partes;
+}
+
+// Troca as entidades do jogo local pelas do quadro decodificado
+static void applyFrame(const QuadroDelta& q) {
+    tick_atual = q.tick;
+    player_won = q.player_won;
+    jogadores = q.jogadores;
+    bombas = q.bombas;
+    inimigos.clear();
+    for (size_t id = 0; id < q.inimigos.size(); id++) {
+        int32_t p = q.inimigos[id];
+        if (p >= 0) inimigos.add(p & 0xFFFF, p >> 16, INIMIGO_COMUM, (uint32_t)id);
+    }
+}
+
+// Decodifica um estado inteiro (todos os fragmentos) no jogo local
+static bool applyState(SessaoCliente& sessao, const uint8_t* dados, size_t n) {
+    CabecalhoDelta cab;
+    if (!peekDelta(dados, n, cab)) return false;
+
+    // Entidades antigas saem das grades antes de o mapa e os vetores mudarem
+    if (cab.largura != gameMap.largura || cab.altura != gameMap.altura) {
+        setMapSize(cab.largura, cab.altura);
+        bombas.clear();
+        inimigos.clear();
+    } else {
+        clearEntityGrids();
+    }
+    const QuadroDelta* q = 0;
+    bool ok = decodeDelta(dados, n, sessao.historico, gameMap, q);
+    if (ok) applyFrame(*q);
+
+    // O cliente não simula: as grades servem para o aviso de perigo na tela
+    rebuildEntityGrids();
+    return ok;
+}
+
+static void sendSimple(SessaoCliente& sessao, uint8_t tipo) {
+    uint8_t buf[16];
+    Escritor e(buf, sizeof(buf));
+    writeHeader(e, tipo);
+    if (tipo != MSG_OLA) {
+        e.u16((uint16_t)sessao.jogador);
+        e.u32(sessao.token);
+    }
+    if (tipo == MSG_ACK) e.u32(sessao.seq_estado);
+    udpSend(sessao.sock, sessao.servidor, buf, e.tam);
+    sessao.ultimo_envio = nowSeconds();
+}
+
+bool clientOpen(SessaoCliente& sessao, const char* endereco) {
+    if (!parseAddress(endereco, sessao.servidor)) {
+        fprintf(stderr, "Endereco invalido: %s (use IP:PORTA)\n", endereco);
+        return false;
+    }
+    if (!netInit() || (sessao.sock = udpOpen(0)) == SOCKET_INVALIDO) {
+        fprintf(stderr, "Nao foi possivel abrir o socket UDP\n");
+        return false;
+    }
+    udpSetBuffers(sessao.sock, 1 << 20);
+    sendSimple(sessao, MSG_OLA);
+    return true;
+}
+
+void clientSendAction(SessaoCliente& sessao, int acao) {
+    if (sessao.jogador < 0) return;
+    uint8_t buf[32];
+    Escritor e(buf, sizeof(buf));
+    writeHeader(e, MSG_ENTRADA);
+    e.u16((uint16_t)sessao.jogador);
+    e.u32(sessao.token);
+    e.u32(++sessao.seq_entrada);
+    e.u8((uint8_t)acao);
+    e.u32(sessao.seq_estado);
+    udpSend(sessao.sock, sessao.servidor, buf, e.tam);
+    sessao.ultimo_envio = nowSeconds();
+}
+
+// Guarda um fragmento; retorna true quando o estado ficou completo
+static bool collectFragment(SessaoCliente& sessao, const FragmentoEstado& f) {
+    // Estados mais velhos que o aplicado ou que o em montagem são descartados,
+    // e também os maiores que o maior estado possível
+    if ((int32_t)(f.seq - sessao.seq_estado) <= 0 || f.partes > MAX_PARTES_ESTADO) return false;
+    if (sessao.seq_montagem != 0 && (int32_t)(f.seq - sessao.seq_montagem) < 0) return false;
+    if (f.seq != sessao.seq_montagem) {
+        sessao.seq_montagem = f.seq;
+        sessao.faltam = f.partes;
+        sessao.recebido.assign(f.partes, 0);
+        sessao.montagem.resize((size_t)f.partes * TAMANHO_FRAGMENTO);
+    }
+    // Só o último pedaço pode ser menor
+    bool tamanho_ok = f.parte + 1 < f.partes ? f.tam == TAMANHO_FRAGMENTO : f.tam <= TAMANHO_FRAGMENTO;
+    if (f.partes != (int)sessao.recebido.size() || sessao.recebido[f.parte] || !tamanho_ok) return false;
+    memcpy(&sessao.montagem[(size_t)f.parte * TAMANHO_FRAGMENTO], f.dados, f.tam);
+    if (f.parte + 1 == f.partes) sessao.montagem.resize((size_t)f.parte * TAMANHO_FRAGMENTO + f.tam);
+    sessao.recebido[f.parte] = 1;
+    return --sessao.faltam == 0;
+}
+
+int clientPoll(SessaoCliente& sessao) {
+    static vector<uint8_t> buf(TAMANHO_MAX_DATAGRAMA);
+    int aplicados = 0;
+    EnderecoUdp de;
+    int n;
+    while ((n = udpRecv(sessao.sock, de, &buf[0], buf.size())) >= 0) {
+        if (!(de == sessao.servidor)) continue;
+        Leitor l(&buf[0], (size_t)n);
+        uint8_t tipo;
+        if (!readHeader(l, tipo)) continue;
+
+        if (tipo == MSG_BEMVINDO && sessao.jogador < 0) {
+            sessao.jogador = l.u16();
+            sessao.token = l.u32();
+            if (l.erro) sessao.jogador = -1;
+        } else if (tipo == MSG_CHEIO) {
+            sessao.cheio = true;
+        } else if (tipo == MSG_ESTADO && sessao.jogador >= 0) {
+            FragmentoEstado f;
+            if (!readFragment(l, f) || !collectFragment(sessao, f)) continue;
+            if (applyState(sessao, &sessao.montagem[0], sessao.montagem.size())) {
+                sessao.seq_estado = sessao.seq_montagem;
+                aplicados++;
+            }
+            sessao.seq_montagem = 0;
+        }
+    }
+
+    // Confirma o estado mais novo (vira a base dos próximos), repete o OLA até
+    // ser aceito e manda sinal de vida a cada segundo
+    double agora = nowSeconds();
+    if (aplicados > 0) sendSimple(sessao, MSG_ACK);
+    else if (sessao.jogador < 0 && !sessao.cheio && agora - sessao.ultimo_envio > 0.5) sendSimple(sessao, MSG_OLA);
+    else if (sessao.jogador >= 0 && agora - sessao.ultimo_envio > 1.0) sendSimple(sessao, MSG_ACK);
+    return aplicados;
+}
+
+void clientClose(SessaoCliente& sessao) {
+    if (sessao.sock == SOCKET_INVALIDO) return;
+    if (sessao.jogador >= 0) sendSimple(sessao, MSG_TCHAU);
+    udpClose(sessao.sock);
+    sessao.sock = SOCKET_INVALIDO;
+    sessao.jogador = -1;
+}
@@ -0,0 +1,82 @@
+/*
+ * Protocolo da partida em rede: mensagens entre servidor e clientes (UDP)
+ *
+ * Toda mensagem começa com o número mágico (u32) e o tipo (u8). O servidor é
+ * a autoridade: clientes só mandam ações e recebem o estado a cada tick de rede.
+ */
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "net.h"
+#include "delta.h"
+#include "game.h"
+#include <vector>
+
+const uint16_t PORTA_PADRAO = 27015;
+const uint32_t PROTOCOLO_MAGICO = 0x44334D42; // "BM3D"
+
+enum TipoMensagem {
+    MSG_OLA = 1,       // cliente quer entrar
+    MSG_ENTRADA = 2,   // u16 jogador, u32 token, u32 seq, u8 ação, u32 último estado decodificado
+    MSG_TCHAU = 3,     // u16 jogador, u32 token
+    MSG_ACK = 4,       // u16 jogador, u32 token, u32 último estado decodificado
+    MSG_ENTRADAS_PAR = 5, // entradas entre pares na partida por rollback (ver rollback.cpp)
+    MSG_BEMVINDO = 10, // u16 jogador, u32 token, u16 ticks de rede por segundo
+    MSG_ESTADO = 11,   // um pedaço de um estado codificado por delta.h (ver FragmentoEstado)
+    MSG_CHEIO = 12     // servidor sem vagas
+};
+
+// Estados maiores que isto (o primeiro estado completo de um mapa grande) vão
+// em vários datagramas, cada um abaixo do MTU comum
+const size_t TAMANHO_FRAGMENTO = 1200;
+
+// Maior estado que um cliente aceita montar: o completo do maior mapa (2 bits
+// por célula) com 1 MiB para as entidades (mais de 300 mil inimigos). Um
+// fragmento que anuncia mais partes que isto é descartado antes de alocar.
+const size_t TAMANHO_MAX_ESTADO = (size_t)MAP_SIZE_MAX * MAP_SIZE_MAX / 4 + (1 << 20);
+const int MAX_PARTES_ESTADO = (int)((TAMANHO_MAX_ESTADO + TAMANHO_FRAGMENTO - 1) / TAMANHO_FRAGMENTO);
+
+void writeHeader(Escritor& e, uint8_t tipo);
+bool readHeader(Leitor& l, uint8_t& tipo); // false se não for uma mensagem do jogo
+
+// MSG_ESTADO: u32 seq, u32 última entrada do destinatário, u16 parte, u16 partes
+// e os bytes do pedaço
+struct FragmentoEstado {
+    uint32_t seq;
+    uint32_t ultima_entrada;
+    int parte, partes;
+    const uint8_t* dados;
+    size_t tam;
+};
+
+size_t writeFragment(uint8_t* buf, size_t cap, const FragmentoEstado& f);
+bool readFragment(Leitor& l, FragmentoEstado& f); // depois de readHeader()
+
+// Lado do cliente: conexão com o servidor, envio de ações e aplicação dos estados
+struct SessaoCliente {
+    SocketUdp sock;
+    EnderecoUdp servidor;
+    int jogador;          // -1 até o servidor responder
+    uint32_t token;
+    uint32_t seq_entrada;
+    uint32_t seq_estado;  // último estado aplicado (a base que o servidor pode usar)
+    double ultimo_envio;
+    bool cheio;           // o servidor recusou por falta de vagas
+
+    // Estado sendo remontado a partir dos fragmentos
+    uint32_t seq_montagem;
+    std::vector<uint8_t> montagem;
+    std::vector<uint8_t> recebido; // um por fragmento
+    int faltam;
+    HistoricoCliente historico;
+
+    SessaoCliente() : sock(SOCKET_INVALIDO), jogador(-1), token(0), seq_entrada(0), seq_estado(0),
+                      ultimo_envio(0), cheio(false), seq_montagem(0), faltam(0) {}
+};
+
+bool clientOpen(SessaoCliente& sessao, const char* endereco);
+int clientPoll(SessaoCliente& sessao);             // retorna quantos estados novos foram aplicados
+void clientSendAction(SessaoCliente& sessao, int acao);
+void clientClose(SessaoCliente& sessao);
+
+#endif
@@ -0,0 +1,1252 @@
+/*
+ * Desenho da cena (ver render.h)
+ */
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "render.h"
+#include "shaders.h"
+#include "stats.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+using namespace std;
+
+// Contagem das chamadas ao GL (ver ContadoresGL): as chamadas deste arquivo
+// passam pelas versões abaixo, que somam na fase atual antes de chamar o GL.
+// A última posição guarda o que é chamado fora das fases (estado inicial,
+// câmera) e some no começo do quadro.
+static ContadoresGL contadores_gl[NUM_FASES + 1];
+static ContadoresGL* contagem = &contadores_gl[NUM_FASES];
+static ContadoresGL quadro_gl[NUM_FASES + 1]; // último quadro inteiro, com o total
+
+static inline void countedBegin(GLenum modo) { contagem->desenhos++; glBegin(modo); }
+static inline void countedVertex3f(GLfloat x, GLfloat y, GLfloat z) { contagem->vertices++; glVertex3f(x, y, z); }
+static inline void countedBindTexture(GLenum alvo, GLuint tex) { contagem->texturas++; glBindTexture(alvo, tex); }
+static inline void countedEnable(GLenum estado) { contagem->estados++; glEnable(estado); }
+static inline void countedDisable(GLenum estado) { contagem->estados++; glDisable(estado); }
+static inline void countedPushMatrix() { contagem->matrizes++; glPushMatrix(); }
+static inline void countedPopMatrix() { contagem->matrizes++; glPopMatrix(); }
+static inline void countedDrawArrays(GLenum modo, GLint primeiro, GLsizei n) {
+    contagem->desenhos++;
+    contagem->vertices += (uint32_t)n;
+    glDrawArrays(modo, primeiro, n);
+}
+
+#define glBegin countedBegin
+#define glVertex3f countedVertex3f
+#define glBindTexture countedBindTexture
+#define glEnable countedEnable
+#define glDisable countedDisable
+#define glPushMatrix countedPushMatrix
+#define glPopMatrix countedPopMatrix
+#define glDrawArrays countedDrawArrays
+
+const ContadoresGL& glCounters(int fase) {
+    return quadro_gl[fase];
+}
+
+// Texturas
+GLuint tex_grama;
+GLuint tex_azulejo;
+GLuint tex_tijolo;
+
+Model playerModel;
+
+int jogador_local = 0;
+
+const Jogador* localPlayer() {
+    if (jogador_local < 0 || jogador_local >= (int)jogadores.size()) return 0;
+    return &jogadores[jogador_local];
+}
+
+float cam_angle_y = 45.0f;
+float cam_angle_x = 30.0f;
+float cam_dist = 20.0f;
+
+// Matrizes da câmera, calculadas na CPU (por colunas, como o GL): o caminho
+// fixo as carrega no GL e o com shaders as manda no uniform buffer
+static float matriz_projecao[16], matriz_vista[16];
+
+// Luz dos dois caminhos: a posição fica no espaço da câmera (o GL fixo a
+// recebe com a modelview identidade) e o ambiente global é o padrão do GL
+static const GLfloat LUZ_POSICAO[4] = { 10.0f, 10.0f, 10.0f, 1.0f };
+static const GLfloat LUZ_AMBIENTE[4] = { 0.3f, 0.3f, 0.3f, 1.0f };
+static const GLfloat LUZ_DIFUSA[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+static const GLfloat AMBIENTE_GLOBAL = 0.2f;
+
+// Caminho com shaders (ver initShaders()); no perfil core não há o fixo
+static bool shaders_disponiveis = false, shaders_ligados = false, contexto_core = false;
+static double tempo_cena = 0;
+
+static bool initShaders();
+
+// Esfera das bombas e explosões (a do GLU: o glutSolidSphere() precisa da janela do GLUT)
+static GLUquadric* esfera = 0;
+static const int FATIAS_ESFERA = 10, PILHAS_ESFERA = 10;
+
+static void drawSphere() {
+    gluSphere(esfera, 0.3, FATIAS_ESFERA, PILHAS_ESFERA);
+    // Por dentro do GLU: um leque em cada polo e uma faixa por pilha do meio
+    contagem->desenhos += PILHAS_ESFERA;
+    contagem->vertices += 2 * (FATIAS_ESFERA + 2) + (PILHAS_ESFERA - 2) * 2 * (FATIAS_ESFERA + 1);
+}
+
+void initRenderer(const char* assets, CarregarFuncaoGL carregar) {
+    contexto_core = coreProfile();
+    glEnable(GL_DEPTH_TEST);
+
+    if (!contexto_core) {
+        glEnable(GL_TEXTURE_2D);
+
+        // Configuração de iluminação básica
+        glEnable(GL_LIGHTING);
+        glEnable(GL_LIGHT0);
+        glEnable(GL_COLOR_MATERIAL);
+
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        glLightfv(GL_LIGHT0, GL_POSITION, LUZ_POSICAO);
+        glLightfv(GL_LIGHT0, GL_AMBIENT, LUZ_AMBIENTE);
+        glLightfv(GL_LIGHT0, GL_DIFFUSE, LUZ_DIFUSA);
+    }
+
+    // Carrega as texturas
+    string dir = string(assets) + "/";
+    tex_grama = loadTexture((dir + "grass.jpg").c_str());
+    tex_azulejo = loadTexture((dir + "tiles.jpg").c_str()); 
+    tex_tijolo = loadTexture((dir + "brick.jpg").c_str());
+    
+    // Carrega o modelo do jogador
+    if (!loadModel((dir + "bomberman.obj").c_str(), playerModel)) {
+        printf("Falha ao carregar modelo do jogador\n");
+        exit(1);
+    }
+    
+    if (!contexto_core) esfera = gluNewQuadric();
+    glClearColor(0.8f, 0.9f, 1.0f, 1.0f);
+
+    shaders_disponiveis = loadGL33(carregar) && initShaders();
+    if (contexto_core && !shaders_disponiveis) {
+        printf("Contexto GL core sem os shaders do GL 3.3\n");
+        exit(1);
+    }
+    shaders_ligados = shaders_disponiveis;
+}
+
+// Como o gluPerspective()
+static void perspective(float m[16], double fovy, double aspecto, double perto, double longe) {
+    double f = 1.0 / tan(fovy * 3.14159265358979 / 360.0);
+    memset(m, 0, 16 * sizeof(float));
+    m[0] = (float)(f / aspecto);
+    m[5] = (float)f;
+    m[10] = (float)((longe + perto) / (perto - longe));
+    m[11] = -1.0f;
+    m[14] = (float)(2 * longe * perto / (perto - longe));
+}
+
+// Como o gluLookAt()
+static void lookAt(float m[16], float olho_x, float olho_y, float olho_z, float alvo_x, float alvo_y,
+                   float alvo_z, float cima_x, float cima_y, float cima_z) {
+    float f[3] = { alvo_x - olho_x, alvo_y - olho_y, alvo_z - olho_z };
+    float n = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    f[0] /= n; f[1] /= n; f[2] /= n;
+    float l[3] = { f[1] * cima_z - f[2] * cima_y, f[2] * cima_x - f[0] * cima_z, f[0] * cima_y - f[1] * cima_x };
+    n = sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+    l[0] /= n; l[1] /= n; l[2] /= n;
+    float c[3] = { l[1] * f[2] - l[2] * f[1], l[2] * f[0] - l[0] * f[2], l[0] * f[1] - l[1] * f[0] };
+
+    memset(m, 0, 16 * sizeof(float));
+    for (int i = 0; i < 3; i++) {
+        m[i * 4 + 0] = l[i];
+        m[i * 4 + 1] = c[i];
+        m[i * 4 + 2] = -f[i];
+    }
+    m[12] = -(l[0] * olho_x + l[1] * olho_y + l[2] * olho_z);
+    m[13] = -(c[0] * olho_x + c[1] * olho_y + c[2] * olho_z);
+    m[14] = f[0] * olho_x + f[1] * olho_y + f[2] * olho_z;
+    m[15] = 1.0f;
+}
+
+void setViewport(int largura, int altura) {
+    int w = largura, h = altura;
+    glViewport(0, 0, w, h);
+    perspective(matriz_projecao, 60, (float)w / (float)h, 1, 100);
+}
+
+bool usingShaders() {
+    return shaders_ligados;
+}
+
+bool setShaders(bool sim) {
+    shaders_ligados = contexto_core || (sim && shaders_disponiveis);
+    return shaders_ligados;
+}
+
+void setSceneTime(double segundos) {
+    tempo_cena = segundos;
+}
+
+bool animatedScene() {
+    if (!shaders_ligados) return false;
+    for (size_t i = 0; i < bombas.size(); i++)
+        if (bombas[i].explodiu && bombas[i].frame_explosao > 0) return true;
+    return false;
+}
+
+// Distância da câmera conforme o tamanho do mapa
+void fitCamera() {
+    int lado = max(gameMap.largura, gameMap.altura);
+    cam_dist = 1.5f * min(lado, MAPA_VISTA_INTEIRA) + 0.5f; // 20 no mapa 13x13
+}
+
+GLuint loadTexture(const char* filename) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(filename, &width, &height, &channels, 0);
+    if (!data) {
+        printf("Erro ao carregar imagem: %s\n", filename);
+        exit(1);
+    }
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, 
+                 channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    stbi_image_free(data);
+    return tex;
+}
+
+bool loadModel(const char* filename, Model& model) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    // Extrai o diretório do arquivo OBJ
+    std::string obj_path = filename;
+    size_t last_slash = obj_path.find_last_of("/\\");
+    std::string base_path = (last_slash != std::string::npos) ? obj_path.substr(0, last_slash + 1) : "";
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, base_path.c_str())) {
+        // printf("Erro ao carregar modelo: %s\n", err.c_str());
+        return false;
+    }
+
+
+    // Armazena os materiais
+    model.materials = materials;
+
+    // Processa os dados do modelo
+    for (const auto& shape : shapes) {
+        
+        // Processa cada face (triângulo)
+        size_t index_offset = 0;
+        for (size_t face = 0; face < shape.mesh.num_face_vertices.size(); face++) {
+            int material_id = (face < shape.mesh.material_ids.size()) ? shape.mesh.material_ids[face] : -1;
+            
+            // Cada face tem 3 vértices (triângulo)
+            for (size_t v = 0; v < 3; v++) {
+                const auto& index = shape.mesh.indices[index_offset + v];
+                
+                model.vertices.push_back(attrib.vertices[3 * index.vertex_index + 0]);
+                model.vertices.push_back(attrib.vertices[3 * index.vertex_index + 1]);
+                model.vertices.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+
+                if (index.normal_index >= 0) {
+                    model.normals.push_back(attrib.normals[3 * index.normal_index + 0]);
+                    model.normals.push_back(attrib.normals[3 * index.normal_index + 1]);
+                    model.normals.push_back(attrib.normals[3 * index.normal_index + 2]);
+                }
+
+                if (index.texcoord_index >= 0) {
+                    model.texcoords.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
+                    model.texcoords.push_back(attrib.texcoords[2 * index.texcoord_index + 1]);
+                }
+
+                // Cada vértice da face usa o mesmo material
+                model.material_ids.push_back(material_id);
+            }
+            
+            index_offset += 3; // Próxima face
+        }
+    }
+    
+    // printf("Vértices carregados: %zu\n", model.vertices.size() / 3);
+    // printf("Materiais carregados: %zu\n", model.materials.size());
+    
+    return true;
+}
+
+void drawModelWithColor(const Model& model, float r, float g, float b) {
+    glBegin(GL_TRIANGLES);
+    for (size_t i = 0; i < model.vertices.size(); i += 3) {
+        // Aplica a cor personalizada
+        glColor3f(r, g, b);
+        
+        // Aplica normal se disponível
+        if (i < model.normals.size()) {
+            glNormal3f(model.normals[i], model.normals[i+1], model.normals[i+2]);
+        }
+        
+        glVertex3f(model.vertices[i], model.vertices[i+1], model.vertices[i+2]);
+    }
+    glEnd();
+}
+
+void drawModel(const Model& model) {
+    glBegin(GL_TRIANGLES);
+    for (size_t i = 0; i < model.vertices.size(); i += 3) {
+        // Aplica a cor do material
+        int material_id = model.material_ids[i / 3];
+        if (material_id >= 0 && material_id < model.materials.size()) {
+            const auto& material = model.materials[material_id];
+            glColor3f(material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+            // Debug: print dos primeiros materiais usados
+            // if (i < 30) { // Primeiros 10 triângulos
+            //     printf("Triângulo %zu: Material %d, Cor (%.3f, %.3f, %.3f)\n", 
+            //            i/3, material_id, material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+            // }
+        } else {
+            // Cor padrão se não houver material
+            glColor3f(1.0f, 1.0f, 1.0f);
+        }
+        
+        // Aplica normal se disponível
+        if (i < model.normals.size()) {
+            glNormal3f(model.normals[i], model.normals[i+1], model.normals[i+2]);
+        }
+        
+        glVertex3f(model.vertices[i], model.vertices[i+1], model.vertices[i+2]);
+    }
+    glEnd();
+}
+
+void drawCubeTextured(GLuint tex) {
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glColor3f(1,1,1);
+
+    float s = 0.5f;
+    float repeat = 2.0f; // Ajuste para mais repetições se quiser
+
+    glBegin(GL_QUADS);
+    // Frente
+    glTexCoord2f(0,0); glVertex3f(-s,-s, s);
+    glTexCoord2f(repeat,0); glVertex3f( s,-s, s);
+    glTexCoord2f(repeat,repeat); glVertex3f( s, s, s);
+    glTexCoord2f(0,repeat); glVertex3f(-s, s, s);
+    // Trás
+    glTexCoord2f(0,0); glVertex3f( s,-s,-s);
+    glTexCoord2f(repeat,0); glVertex3f(-s,-s,-s);
+    glTexCoord2f(repeat,repeat); glVertex3f(-s, s,-s);
+    glTexCoord2f(0,repeat); glVertex3f( s, s,-s);
+    // Direita
+    glTexCoord2f(0,0); glVertex3f( s,-s, s);
+    glTexCoord2f(repeat,0); glVertex3f( s,-s,-s);
+    glTexCoord2f(repeat,repeat); glVertex3f( s, s,-s);
+    glTexCoord2f(0,repeat); glVertex3f( s, s, s);
+    // Esquerda
+    glTexCoord2f(0,0); glVertex3f(-s,-s,-s);
+    glTexCoord2f(repeat,0); glVertex3f(-s,-s, s);
+    glTexCoord2f(repeat,repeat); glVertex3f(-s, s, s);
+    glTexCoord2f(0,repeat); glVertex3f(-s, s,-s);
+    // Topo
+    glTexCoord2f(0,0); glVertex3f(-s, s, s);
+    glTexCoord2f(repeat,0); glVertex3f( s, s, s);
+    glTexCoord2f(repeat,repeat); glVertex3f( s, s,-s);
+    glTexCoord2f(0,repeat); glVertex3f(-s, s,-s);
+    // Base
+    glTexCoord2f(0,0); glVertex3f(-s,-s,-s);
+    glTexCoord2f(repeat,0); glVertex3f( s,-s,-s);
+    glTexCoord2f(repeat,repeat); glVertex3f( s,-s, s);
+    glTexCoord2f(0,repeat); glVertex3f(-s,-s, s);
+    glEnd();
+
+    glDisable(GL_TEXTURE_2D);
+}
+
+void drawGroundTextured() {
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, tex_grama);
+    glColor3f(1,1,1); // Para não alterar a cor da textura
+
+    float y = -1.0f;
+    float size_x = (float)gameMap.largura;
+    float size_z = (float)gameMap.altura;
+    // Uma repetição da textura a cada 13 células, como no mapa original
+    float rep_x = size_x / MAP_SIZE, rep_z = size_z / MAP_SIZE;
+    glBegin(GL_QUADS);
+        glTexCoord2f(0, 0); glVertex3f(0, y, 0);
+        glTexCoord2f(rep_x, 0); glVertex3f(size_x, y, 0);
+        glTexCoord2f(rep_x, rep_z); glVertex3f(size_x, y, size_z);
+        glTexCoord2f(0, rep_z); glVertex3f(0, y, size_z);
+    glEnd();
+
+    glDisable(GL_TEXTURE_2D);
+}
+
+// O nível é desenhado em pedaços de MAPA_TILE x MAPA_TILE células (os mesmos
+// blocos do Mapa). Cada pedaço guarda as faces visíveis dos seus cubos em
+// vetores de vértices e só é reconstruído quando alguma célula dele, ou da
+// borda de um vizinho, muda. Pedaços fora do frustum da câmera não são
+// desenhados, então o custo do quadro depende do que aparece na tela.
+struct Pedaco {
+    bool construido;
+    uint32_t chave;              // soma das revisões do pedaço e dos 4 vizinhos
+    std::vector<float> paredes;  // vértices no formato GL_T2F_N3F_V3F
+    std::vector<float> blocos;
+    GLuint vbo[2];               // cópias na GPU (paredes, blocos) do caminho com shaders
+    bool enviado;                // vbo[] com os vértices atuais
+};
+
+static vector<Pedaco> pedacos;
+static int pedacos_tx = 0, pedacos_tz = 0;
+
+// Área visível em células (alinhada aos pedaços), atualizada em drawMap()
+static int vis_x0 = 0, vis_z0 = 0, vis_x1 = -1, vis_z1 = -1;
+
+// Faces do cubo na mesma ordem de drawCubeTextured(); a base fica sempre
+// encostada no chão e não é gerada
+struct FaceCubo {
+    int dx, dz;         // vizinho que esconde a face (0, 0 = nenhum)
+    float n[3];
+    float v[4][3];
+};
+
+static const FaceCubo FACES_CUBO[5] = {
+    {  0,  1, {  0, 0,  1 }, { {-1,-1, 1}, { 1,-1, 1}, { 1, 1, 1}, {-1, 1, 1} } }, // frente
+    {  0, -1, {  0, 0, -1 }, { { 1,-1,-1}, {-1,-1,-1}, {-1, 1,-1}, { 1, 1,-1} } }, // trás
+    {  1,  0, {  1, 0,  0 }, { { 1,-1, 1}, { 1,-1,-1}, { 1, 1,-1}, { 1, 1, 1} } }, // direita
+    { -1,  0, { -1, 0,  0 }, { {-1,-1,-1}, {-1,-1, 1}, {-1, 1, 1}, {-1, 1,-1} } }, // esquerda
+    {  0,  0, {  0, 1,  0 }, { {-1, 1, 1}, { 1, 1, 1}, { 1, 1,-1}, {-1, 1,-1} } }, // topo
+};
+
+static bool isSolid(int x, int z) {
+    if (x < 0 || z < 0 || x >= gameMap.largura || z >= gameMap.altura) return false;
+    return gameMap.at(x, z) != CELULA_VAZIA;
+}
+
+static uint32_t chunkKey(int tx, int tz) {
+    uint32_t chave = gameMap.tileRevision(tx, tz);
+    if (tx > 0) chave += gameMap.tileRevision(tx - 1, tz);
+    if (tz > 0) chave += gameMap.tileRevision(tx, tz - 1);
+    if (tx + 1 < gameMap.tiles_x) chave += gameMap.tileRevision(tx + 1, tz);
+    if (tz + 1 < gameMap.tiles_z) chave += gameMap.tileRevision(tx, tz + 1);
+    return chave;
+}
+
+static void buildChunk(Pedaco& p, int tx, int tz) {
+    const float s = 0.5f;
+    const float repeat = 2.0f; // igual a drawCubeTextured()
+    const float tex[4][2] = { {0, 0}, {repeat, 0}, {repeat, repeat}, {0, repeat} };
+
+    p.paredes.clear();
+    p.blocos.clear();
+    int x_fim = min((tx + 1) * MAPA_TILE, gameMap.largura);
+    int z_fim = min((tz + 1) * MAPA_TILE, gameMap.altura);
+
+    // Blocos só somem, então o pedaço nunca passa de: paredes com as faces que
+    // blocos hoje escondem e 5 faces por bloco. Reservado na primeira vez, o
+    // pedaço é reconstruído sem alocar quando um bloco é destruído.
+    if (!p.construido) {
+        size_t faces_paredes = 0, faces_blocos = 0;
+        for (int z = tz * MAPA_TILE; z < z_fim; z++) {
+            for (int x = tx * MAPA_TILE; x < x_fim; x++) {
+                uint8_t tipo = gameMap.at(x, z);
+                if (tipo == CELULA_BLOCO) faces_blocos += 5;
+                if (tipo != CELULA_PAREDE) continue;
+                for (int f = 0; f < 5; f++) {
+                    const FaceCubo& face = FACES_CUBO[f];
+                    int nx = x + face.dx, nz = z + face.dz;
+                    bool parede_vizinha = (face.dx != 0 || face.dz != 0) && nx >= 0 && nz >= 0 &&
+                                          nx < gameMap.largura && nz < gameMap.altura &&
+                                          gameMap.at(nx, nz) == CELULA_PAREDE;
+                    if (!parede_vizinha) faces_paredes++;
+                }
+            }
+        }
+        p.paredes.reserve(faces_paredes * 4 * 8);
+        p.blocos.reserve(faces_blocos * 4 * 8);
+    }
+    for (int z = tz * MAPA_TILE; z < z_fim; z++) {
+        for (int x = tx * MAPA_TILE; x < x_fim; x++) {
+            uint8_t tipo = gameMap.at(x, z);
+            if (tipo == CELULA_VAZIA) continue;
+            vector<float>& destino = tipo == CELULA_PAREDE ? p.paredes : p.blocos;
+
+            for (int f = 0; f < 5; f++) {
+                const FaceCubo& face = FACES_CUBO[f];
+                // Face colada em outro cubo nunca aparece
+                if ((face.dx != 0 || face.dz != 0) && isSolid(x + face.dx, z + face.dz)) continue;
+                for (int k = 0; k < 4; k++) {
+                    float vertice[8] = {
+                        tex[k][0], tex[k][1],
+                        face.n[0], face.n[1], face.n[2],
+                        x + s * face.v[k][0], -0.5f + s * face.v[k][1], z + s * face.v[k][2]
+                    };
+                    destino.insert(destino.end(), vertice, vertice + 8);
+                }
+            }
+        }
+    }
+    p.construido = true;
+    p.enviado = false;
+    p.chave = chunkKey(tx, tz);
+}
+
+// Planos do frustum (ax + by + cz + d >= 0 dentro) a partir das matrizes da câmera
+static void extractFrustum(float planos[6][4]) {
+    const float* proj = matriz_projecao;
+    const float* mv = matriz_vista;
+    float c[16];
+    for (int col = 0; col < 4; col++)
+        for (int lin = 0; lin < 4; lin++)
+            c[col * 4 + lin] = proj[0 * 4 + lin] * mv[col * 4 + 0] + proj[1 * 4 + lin] * mv[col * 4 + 1] +
+                               proj[2 * 4 + lin] * mv[col * 4 + 2] + proj[3 * 4 + lin] * mv[col * 4 + 3];
+    for (int i = 0; i < 6; i++) {
+        int lin = i / 2;
+        float sinal = (i % 2 == 0) ? 1.0f : -1.0f;
+        for (int col = 0; col < 4; col++)
+            planos[i][col] = c[col * 4 + 3] + sinal * c[col * 4 + lin];
+    }
+}
+
+static bool boxInFrustum(const float planos[6][4], const float minimo[3], const float maximo[3]) {
+    for (int i = 0; i < 6; i++) {
+        // Vértice da caixa mais à frente na direção da normal do plano
+        float px = planos[i][0] >= 0 ? maximo[0] : minimo[0];
+        float py = planos[i][1] >= 0 ? maximo[1] : minimo[1];
+        float pz = planos[i][2] >= 0 ? maximo[2] : minimo[2];
+        if (planos[i][0] * px + planos[i][1] * py + planos[i][2] * pz + planos[i][3] < 0) return false;
+    }
+    return true;
+}
+
+// Retângulo de células que contém os 8 cantos do frustum, para não testar
+// todos os pedaços de uma arena grande
+static void frustumCellBounds(int& x0, int& z0, int& x1, int& z1) {
+    GLdouble proj[16], mv[16];
+    GLint viewport[4] = { 0, 0, 1, 1 };
+    for (int i = 0; i < 16; i++) {
+        proj[i] = matriz_projecao[i];
+        mv[i] = matriz_vista[i];
+    }
+
+    double min_x = 1e30, min_z = 1e30, max_x = -1e30, max_z = -1e30;
+    for (int k = 0; k < 8; k++) {
+        GLdouble wx, wy, wz;
+        gluUnProject(k & 1, (k >> 1) & 1, (k >> 2) & 1, mv, proj, viewport, &wx, &wy, &wz);
+        min_x = min(min_x, wx); max_x = max(max_x, wx);
+        min_z = min(min_z, wz); max_z = max(max_z, wz);
+    }
+    x0 = max(0, (int)floor(min_x));
+    z0 = max(0, (int)floor(min_z));
+    x1 = min(gameMap.largura - 1, (int)ceil(max_x));
+    z1 = min(gameMap.altura - 1, (int)ceil(max_z));
+}
+
+static bool cellVisible(int x, int z) {
+    return x >= vis_x0 && x <= vis_x1 && z >= vis_z0 && z <= vis_z1;
+}
+
+static void drawChunkArray(const vector<float>& vertices, GLuint tex) {
+    if (vertices.empty()) return;
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glInterleavedArrays(GL_T2F_N3F_V3F, 0, &vertices[0]);
+    glDrawArrays(GL_QUADS, 0, (GLsizei)(vertices.size() / 8));
+}
+
+// Pedaços do tamanho do mapa atual e área visível; devolve os pedaços que
+// podem aparecer (o frustum ainda descarta alguns em visibleChunk())
+static void prepareChunks(float planos[6][4], int& tx0, int& tz0, int& tx1, int& tz1) {
+    if (pedacos_tx != gameMap.tiles_x || pedacos_tz != gameMap.tiles_z) {
+        for (size_t i = 0; i < pedacos.size(); i++)
+            if (pedacos[i].vbo[0]) gl33.deleteBuffers(2, pedacos[i].vbo);
+        pedacos_tx = gameMap.tiles_x;
+        pedacos_tz = gameMap.tiles_z;
+        pedacos.assign((size_t)pedacos_tx * pedacos_tz, Pedaco());
+        for (size_t i = 0; i < pedacos.size(); i++) pedacos[i].construido = false;
+    }
+
+    extractFrustum(planos);
+    int x0, z0, x1, z1;
+    frustumCellBounds(x0, z0, x1, z1);
+    tx0 = x0 >> MAPA_TILE_BITS;
+    tz0 = z0 >> MAPA_TILE_BITS;
+    tx1 = x1 >> MAPA_TILE_BITS;
+    tz1 = z1 >> MAPA_TILE_BITS;
+    vis_x0 = tx0 * MAPA_TILE;
+    vis_z0 = tz0 * MAPA_TILE;
+    vis_x1 = (tx1 + 1) * MAPA_TILE - 1;
+    vis_z1 = (tz1 + 1) * MAPA_TILE - 1;
+}
+
+// Pedaço dentro do frustum, reconstruído se mudou; 0 se não aparece
+static Pedaco* visibleChunk(const float planos[6][4], int tx, int tz) {
+    float minimo[3] = { tx * MAPA_TILE - 0.5f, -1.0f, tz * MAPA_TILE - 0.5f };
+    float maximo[3] = { (tx + 1) * MAPA_TILE - 0.5f, 0.0f, (tz + 1) * MAPA_TILE - 0.5f };
+    if (!boxInFrustum(planos, minimo, maximo)) return 0;
+
+    Pedaco& p = pedacos[(size_t)tz * pedacos_tx + tx];
+    if (!p.construido || p.chave != chunkKey(tx, tz))
+        buildChunk(p, tx, tz);
+    return &p;
+}
+
+void drawMap() {
+    // Desenha o chão branco
+    drawGroundTextured();
+
+    float planos[6][4];
+    int tx0, tz0, tx1, tz1;
+    prepareChunks(planos, tx0, tz0, tx1, tz1);
+
+    glEnable(GL_TEXTURE_2D);
+    glColor3f(1, 1, 1);
+    for (int tz = tz0; tz <= tz1; tz++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            Pedaco* p = visibleChunk(planos, tx, tz);
+            if (!p) continue;
+            drawChunkArray(p->paredes, tex_azulejo);
+            drawChunkArray(p->blocos, tex_tijolo);
+        }
+    }
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+}
+
+// Os outros jogadores (partida em rede) aparecem em azul
+void drawPlayers() {
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        if (!jogadores[j].ativo || !jogadores[j].vivo || !cellVisible(jogadores[j].x, jogadores[j].z)) continue;
+        glPushMatrix();
+        glTranslatef((float)jogadores[j].x, 0.0f, (float)jogadores[j].z);
+        glScalef(0.5f, 0.5f, 0.5f); // Ajuste o tamanho conforme necessário
+        if ((int)j == jogador_local) drawModel(playerModel);
+        else drawModelWithColor(playerModel, 0.3f, 0.5f, 1.0f);
+        glPopMatrix();
+    }
+}
+
+void drawEnemies() {
+    for (size_t i = 0; i < inimigos.size(); i++) {
+        if (!cellVisible(inimigos.x[i], inimigos.z[i])) continue;
+        glPushMatrix();
+        glTranslatef((float)inimigos.x[i], 0.0f, (float)inimigos.z[i]);
+        glScalef(0.5f, 0.5f, 0.5f); // Mesmo tamanho do jogador
+        drawModelWithColor(playerModel, 1.0f, 0.0f, 0.0f);
+        glPopMatrix();
+    }
+}
+
+void drawBombs() {
+    for (size_t i = 0; i < bombas.size(); i++) {
+        if (!bombas[i].explodiu && bombas[i].timer > 0 && cellVisible(bombas[i].x, bombas[i].z)) {
+            glPushMatrix();
+            glTranslatef((float)bombas[i].x, 0.0f, (float)bombas[i].z);
+            glColor3f(0.0f, 0.0f, 0.0f);
+            drawSphere();
+            glPopMatrix();
+        }
+    }
+}
+
+void drawExplosions() {
+    for (size_t i = 0; i < bombas.size(); i++) {
+        if (bombas[i].explodiu && bombas[i].frame_explosao > 0 && cellVisible(bombas[i].x, bombas[i].z)) {
+            glColor3f(1.0f, 0.3f, 0.0f);
+            
+            
+            //  Centro da explosão
+		    glPushMatrix();
+		    glTranslatef((float)bombas[i].x, 0.0f, (float)bombas[i].z);
+		    drawSphere();
+		    glPopMatrix();
+            
+            
+            
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    if (abs(dx) + abs(dz) == 1) {
+                        // glPushMatrix();
+                        // glTranslatef((float)(bombas[i].x + dx), 0.0f, (float)(bombas[i].z + dz));
+                        // drawSphere();
+                        // glPopMatrix();
+                        
+                        int nx = bombas[i].x + dx;
+			            int nz = bombas[i].z + dz;
+			
+			            // Só desenha explosão se não for parede sólida
+			            if (gameMap.at(nx, nz) != CELULA_PAREDE) {
+			                glPushMatrix();
+			                glTranslatef((float)nx, 0.0f, (float)nz);
+			                drawSphere();
+			                glPopMatrix();
+			            }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Caminho com shaders (GL 3.3). O nível fica em buffers na GPU, enviados só
+// quando o pedaço é reconstruído; personagens, bombas e chamas saem numa
+// chamada por fase, com a célula de cada um num buffer de instâncias montado
+// no quadro. A luz é calculada por pixel com a conta do GL fixo (ambiente +
+// difusa, sem especular), então os dois caminhos dão quase a mesma imagem,
+// menos as chamas, que aqui brilham sozinhas e tremem com o tempo.
+
+// Câmera e luz, no ponto 0 de uniform buffer de todos os programas
+#define GLSL_CAMERA \
+    "layout(std140) uniform Camera {\n" \
+    "    mat4 projecao;\n" \
+    "    mat4 vista;\n" \
+    "    vec4 luz;      // posição, no espaço da câmera\n" \
+    "    vec4 ambiente; // global + da luz\n" \
+    "    vec4 difusa;\n" \
+    "    vec4 tempo;    // x: segundos (setSceneTime())\n" \
+    "};\n"
+
+// Cor iluminada como no GL fixo com GL_COLOR_MATERIAL; a normal não é
+// normalizada, como lá sem GL_NORMALIZE
+#define GLSL_LUZ \
+    "vec3 iluminar(vec3 cor, vec3 normal, vec3 posicao) {\n" \
+    "    vec3 l = normalize(luz.xyz - posicao);\n" \
+    "    return min(cor * (ambiente.rgb + difusa.rgb * max(dot(normal, l), 0.0)), 1.0);\n" \
+    "}\n"
+
+// O bloco Camera do lado da CPU (std140: só mat4 e vec4, sem preenchimento)
+struct CameraGPU {
+    float projecao[16], vista[16];
+    float luz[4], ambiente[4], difusa[4], tempo[4];
+};
+
+static const char* const VS_NIVEL =
+    "#version 330 core\n" GLSL_CAMERA
+    "layout(location = 0) in vec3 posicao;\n"
+    "layout(location = 1) in vec3 normal;\n"
+    "layout(location = 2) in vec2 textura;\n"
+    "out vec3 v_posicao;\n"
+    "out vec3 v_normal;\n"
+    "out vec2 v_textura;\n"
+    "void main() {\n"
+    "    vec4 olho = vista * vec4(posicao, 1.0);\n"
+    "    v_posicao = olho.xyz;\n"
+    "    v_normal = mat3(vista) * normal;\n"
+    "    v_textura = textura;\n"
+    "    gl_Position = projecao * olho;\n"
+    "}\n";
+
+static const char* const FS_NIVEL =
+    "#version 330 core\n" GLSL_CAMERA GLSL_LUZ
+    "uniform sampler2D imagem;\n"
+    "in vec3 v_posicao;\n"
+    "in vec3 v_normal;\n"
+    "in vec2 v_textura;\n"
+    "out vec4 cor;\n"
+    "void main() {\n"
+    "    cor = texture(imagem, v_textura) * vec4(iluminar(vec3(1.0), v_normal, v_posicao), 1.0);\n"
+    "}\n";
+
+// Malha (posição, normal, cor do material) e, por instância, a célula (x, z)
+// e uma cor: rgb, e em a quanto ela substitui a do material
+#define GLSL_MALHA \
+    "layout(location = 0) in vec3 posicao;\n" \
+    "layout(location = 1) in vec3 normal;\n" \
+    "layout(location = 2) in vec3 material;\n" \
+    "layout(location = 3) in vec2 celula;\n" \
+    "layout(location = 4) in vec4 cor_instancia;\n"
+
+static const char* const VS_PERSONAGENS =
+    "#version 330 core\n" GLSL_CAMERA GLSL_MALHA
+    "out vec3 v_posicao;\n"
+    "out vec3 v_normal;\n"
+    "out vec3 v_cor;\n"
+    "void main() {\n"
+    "    // Metade do tamanho, como o glScalef(0.5) do GL fixo, que sem\n"
+    "    // GL_NORMALIZE deixa as normais com o dobro do comprimento\n"
+    "    vec4 olho = vista * vec4(posicao * 0.5 + vec3(celula.x, 0.0, celula.y), 1.0);\n"
+    "    v_posicao = olho.xyz;\n"
+    "    v_normal = mat3(vista) * normal * 2.0;\n"
+    "    v_cor = mix(material, cor_instancia.rgb, cor_instancia.a);\n"
+    "    gl_Position = projecao * olho;\n"
+    "}\n";
+
+static const char* const FS_PERSONAGENS =
+    "#version 330 core\n" GLSL_CAMERA GLSL_LUZ
+    "in vec3 v_posicao;\n"
+    "in vec3 v_normal;\n"
+    "in vec3 v_cor;\n"
+    "out vec4 cor;\n"
+    "void main() {\n"
+    "    cor = vec4(iluminar(v_cor, v_normal, v_posicao), 1.0);\n"
+    "}\n";
+
+// Bombas iluminadas e chamas sem luz: amarelas no miolo, da cor da instância
+// na borda, pulsando e tremendo com o tempo (em a, a fase de cada esfera)
+static const char* const VS_ESFERAS =
+    "#version 330 core\n" GLSL_CAMERA GLSL_MALHA
+    "uniform int chama;\n"
+    "out vec3 v_posicao;\n"
+    "out vec3 v_normal;\n"
+    "out vec3 v_cor;\n"
+    "out float v_fase;\n"
+    "void main() {\n"
+    "    float escala = chama != 0 ? 1.0 + 0.12 * sin(tempo.x * 9.0 + cor_instancia.a) : 1.0;\n"
+    "    vec4 olho = vista * vec4(posicao * escala + vec3(celula.x, 0.0, celula.y), 1.0);\n"
+    "    v_posicao = olho.xyz;\n"
+    "    v_normal = mat3(vista) * normal;\n"
+    "    v_cor = cor_instancia.rgb;\n"
+    "    v_fase = cor_instancia.a;\n"
+    "    gl_Position = projecao * olho;\n"
+    "}\n";
+
+static const char* const FS_ESFERAS =
+    "#version 330 core\n" GLSL_CAMERA GLSL_LUZ
+    "uniform int chama;\n"
+    "in vec3 v_posicao;\n"
+    "in vec3 v_normal;\n"
+    "in vec3 v_cor;\n"
+    "in float v_fase;\n"
+    "out vec4 cor;\n"
+    "void main() {\n"
+    "    if (chama == 0) {\n"
+    "        cor = vec4(iluminar(v_cor, v_normal, v_posicao), 1.0);\n"
+    "        return;\n"
+    "    }\n"
+    "    float frente = max(dot(normalize(v_normal), normalize(-v_posicao)), 0.0);\n"
+    "    float brilho = 0.85 + 0.15 * sin(tempo.x * 23.0 + v_fase + v_posicao.y * 9.0);\n"
+    "    cor = vec4(mix(v_cor, vec3(1.0, 0.95, 0.4), frente * frente) * brilho, 1.0);\n"
+    "}\n";
+
+static GLuint programa_nivel = 0, programa_personagens = 0, programa_esferas = 0;
+static GLint chama_esferas = -1;
+static GLuint ubo_camera = 0;
+
+// Nível: um vertex array com os atributos reapontados para o buffer de cada
+// pedaço (GL_T2F_N3F_V3F, como no caminho fixo); os quadrados viram dois
+// triângulos pelo buffer de índices, que cresce com o maior pedaço
+static GLuint vao_nivel = 0, vbo_chao = 0, ibo_quadrados = 0;
+static size_t quadrados_ibo = 0;
+static vector<uint32_t> indices_quadrados;
+static int chao_largura = 0, chao_altura = 0;
+
+// Malhas desenhadas por instâncias, uma lista por fase
+static const int FLOATS_VERTICE = 9;   // posição, normal, cor do material
+static const int FLOATS_INSTANCIA = 6; // célula (x, z), cor rgba
+
+struct Instancias {
+    GLuint vao, vbo;
+    size_t bytes;         // tamanho de vbo
+    vector<float> dados;  // montado a cada quadro; depois de crescer, sem alocar
+};
+
+static GLuint vbo_modelo = 0, vbo_esfera = 0;
+static GLsizei vertices_modelo = 0, vertices_esfera = 0;
+static Instancias inst_jogadores, inst_inimigos, inst_bombas, inst_explosoes;
+
+static void useProgram(GLuint programa) {
+    contagem->estados++;
+    gl33.useProgram(programa);
+}
+
+static void bindVertexArray(GLuint vao) {
+    contagem->estados++;
+    gl33.bindVertexArray(vao);
+}
+
+static GLuint uploadMesh(const vector<float>& malha) {
+    GLuint vbo;
+    gl33.genBuffers(1, &vbo);
+    gl33.bindBuffer(GL_ARRAY_BUFFER, vbo);
+    gl33.bufferData(GL_ARRAY_BUFFER, malha.size() * sizeof(float), malha.empty() ? 0 : &malha[0], GL_STATIC_DRAW);
+    return vbo;
+}
+
+// O modelo como drawModel() o desenha: triângulos soltos, a última normal
+// dada e branco sem material. Um OBJ sem normais (o bomberman.obj não tem)
+// fica com a normal para cima, que é a que o GL fixo acaba usando: a atual
+// depois do mapa, cuja última face de cada pedaço é o topo de um cubo.
+static void modelMesh(const Model& model, vector<float>& malha) {
+    float normal[3] = { 0.0f, 1.0f, 0.0f };
+    for (size_t i = 0; i < model.vertices.size(); i += 3) {
+        if (i < model.normals.size()) {
+            normal[0] = model.normals[i];
+            normal[1] = model.normals[i + 1];
+            normal[2] = model.normals[i + 2];
+        }
+        float cor[3] = { 1.0f, 1.0f, 1.0f };
+        int material_id = model.material_ids[i / 3];
+        if (material_id >= 0 && material_id < (int)model.materials.size())
+            memcpy(cor, model.materials[material_id].diffuse, sizeof(cor));
+        float vertice[FLOATS_VERTICE] = {
+            model.vertices[i], model.vertices[i + 1], model.vertices[i + 2],
+            normal[0], normal[1], normal[2],
+            cor[0], cor[1], cor[2]
+        };
+        malha.insert(malha.end(), vertice, vertice + FLOATS_VERTICE);
+    }
+}
+
+// A esfera do gluSphere() (raio 0.3, polos no eixo z) em triângulos
+static void sphereMesh(vector<float>& malha) {
+    const double PI = 3.14159265358979;
+    const int CANTOS[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+    for (int i = 0; i < PILHAS_ESFERA; i++) {
+        for (int j = 0; j < FATIAS_ESFERA; j++) {
+            for (int k = 0; k < 6; k++) {
+                double fi = PI * (i + CANTOS[k][0]) / PILHAS_ESFERA;
+                double teta = 2 * PI * (j + CANTOS[k][1]) / FATIAS_ESFERA;
+                float n[3] = { (float)(sin(fi) * sin(teta)), (float)(sin(fi) * cos(teta)), (float)cos(fi) };
+                float vertice[FLOATS_VERTICE] = { 0.3f * n[0], 0.3f * n[1], 0.3f * n[2], n[0], n[1], n[2], 0, 0, 0 };
+                malha.insert(malha.end(), vertice, vertice + FLOATS_VERTICE);
+            }
+        }
+    }
+}
+
+// Vertex array de uma lista: a malha por vértice e a célula e a cor por instância
+static void initInstances(Instancias& inst, GLuint malha) {
+    gl33.genVertexArrays(1, &inst.vao);
+    gl33.genBuffers(1, &inst.vbo);
+    inst.bytes = 0;
+    gl33.bindVertexArray(inst.vao);
+
+    gl33.bindBuffer(GL_ARRAY_BUFFER, malha);
+    const GLsizei passo = FLOATS_VERTICE * sizeof(float);
+    for (GLuint a = 0; a < 3; a++) {
+        gl33.enableVertexAttribArray(a);
+        gl33.vertexAttribPointer(a, 3, GL_FLOAT, GL_FALSE, passo, (const void*)(a * 3 * sizeof(float)));
+    }
+
+    gl33.bindBuffer(GL_ARRAY_BUFFER, inst.vbo);
+    const GLsizei passo_instancia = FLOATS_INSTANCIA * sizeof(float);
+    gl33.enableVertexAttribArray(3);
+    gl33.vertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, passo_instancia, 0);
+    gl33.vertexAttribDivisor(3, 1);
+    gl33.enableVertexAttribArray(4);
+    gl33.vertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, passo_instancia, (const void*)(2 * sizeof(float)));
+    gl33.vertexAttribDivisor(4, 1);
+}
+
+static void pushInstance(Instancias& inst, int x, int z, float r, float g, float b, float a) {
+    float instancia[FLOATS_INSTANCIA] = { (float)x, (float)z, r, g, b, a };
+    inst.dados.insert(inst.dados.end(), instancia, instancia + FLOATS_INSTANCIA);
+}
+
+// Manda as instâncias do quadro e desenha todas numa chamada; 'chama' vai
+// para o programa das esferas (0 bomba, 1 chama)
+static void drawInstances(Instancias& inst, GLuint programa, GLsizei vertices, int chama = -1) {
+    if (inst.dados.empty()) return;
+    useProgram(programa);
+    if (chama >= 0) gl33.uniform1i(chama_esferas, chama);
+    GLsizei n = (GLsizei)(inst.dados.size() / FLOATS_INSTANCIA);
+    size_t bytes = inst.dados.size() * sizeof(float);
+    gl33.bindBuffer(GL_ARRAY_BUFFER, inst.vbo);
+    if (bytes > inst.bytes) {
+        inst.bytes = bytes;
+        gl33.bufferData(GL_ARRAY_BUFFER, bytes, &inst.dados[0], GL_STREAM_DRAW);
+    } else {
+        // Buffer novo no lugar do que a GPU ainda pode estar lendo, sem esperar por ela
+        gl33.bufferData(GL_ARRAY_BUFFER, inst.bytes, 0, GL_STREAM_DRAW);
+        gl33.bufferSubData(GL_ARRAY_BUFFER, 0, bytes, &inst.dados[0]);
+    }
+    bindVertexArray(inst.vao);
+    contagem->desenhos++;
+    contagem->vertices += (uint32_t)(vertices * n);
+    gl33.drawArraysInstanced(GL_TRIANGLES, 0, vertices, n);
+}
+
+static void initLevelBuffers() {
+    gl33.genVertexArrays(1, &vao_nivel);
+    gl33.genBuffers(1, &vbo_chao);
+    gl33.genBuffers(1, &ibo_quadrados);
+    gl33.bindVertexArray(vao_nivel);
+    for (GLuint a = 0; a < 3; a++) gl33.enableVertexAttribArray(a);
+    gl33.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_quadrados);
+}
+
+// Índices para 'quadrados' quadrados; com vao_nivel ligado
+static void fitQuadIndices(size_t quadrados) {
+    if (quadrados <= quadrados_ibo) return;
+    quadrados = max(quadrados, 2 * quadrados_ibo);
+    indices_quadrados.clear();
+    for (uint32_t q = 0; q < quadrados; q++) {
+        uint32_t triangulos[6] = { 4 * q, 4 * q + 1, 4 * q + 2, 4 * q, 4 * q + 2, 4 * q + 3 };
+        indices_quadrados.insert(indices_quadrados.end(), triangulos, triangulos + 6);
+    }
+    gl33.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_quadrados);
+    gl33.bufferData(GL_ELEMENT_ARRAY_BUFFER, indices_quadrados.size() * sizeof(uint32_t), &indices_quadrados[0],
+                    GL_STATIC_DRAW);
+    quadrados_ibo = quadrados;
+}
+
+// O chão de drawGroundTextured(), com a normal para cima; só muda com o mapa
+static void updateGround() {
+    if (chao_largura == gameMap.largura && chao_altura == gameMap.altura) return;
+    chao_largura = gameMap.largura;
+    chao_altura = gameMap.altura;
+    float y = -1.0f, sx = (float)chao_largura, sz = (float)chao_altura;
+    float rep_x = sx / MAP_SIZE, rep_z = sz / MAP_SIZE;
+    const float chao[4 * 8] = {
+        0, 0,         0, 1, 0, 0, y, 0,
+        rep_x, 0,     0, 1, 0, sx, y, 0,
+        rep_x, rep_z, 0, 1, 0, sx, y, sz,
+        0, rep_z,     0, 1, 0, 0, y, sz,
+    };
+    gl33.bindBuffer(GL_ARRAY_BUFFER, vbo_chao);
+    gl33.bufferData(GL_ARRAY_BUFFER, sizeof(chao), chao, GL_STATIC_DRAW);
+    fitQuadIndices(1);
+}
+
+static void uploadChunk(Pedaco& p) {
+    if (!p.vbo[0]) gl33.genBuffers(2, p.vbo);
+    const vector<float>* listas[2] = { &p.paredes, &p.blocos };
+    for (int k = 0; k < 2; k++) {
+        const vector<float>& v = *listas[k];
+        gl33.bindBuffer(GL_ARRAY_BUFFER, p.vbo[k]);
+        gl33.bufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.empty() ? 0 : &v[0], GL_STATIC_DRAW);
+        fitQuadIndices(v.size() / 32);
+    }
+    p.enviado = true;
+}
+
+// Quadrados de um buffer do nível ('floats' no formato T2F_N3F_V3F)
+static void drawLevelBuffer(GLuint vbo, size_t floats, GLuint tex) {
+    if (floats == 0) return;
+    glBindTexture(GL_TEXTURE_2D, tex);
+    gl33.bindBuffer(GL_ARRAY_BUFFER, vbo);
+    const GLsizei passo = 8 * sizeof(float);
+    gl33.vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, passo, (const void*)(5 * sizeof(float)));
+    gl33.vertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, passo, (const void*)(2 * sizeof(float)));
+    gl33.vertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, passo, 0);
+    GLsizei quadrados = (GLsizei)(floats / 32);
+    contagem->desenhos++;
+    contagem->vertices += (uint32_t)(4 * quadrados);
+    glDrawElements(GL_TRIANGLES, 6 * quadrados, GL_UNSIGNED_INT, 0);
+}
+
+static bool initShaders() {
+    programa_nivel = buildProgram("nivel", VS_NIVEL, FS_NIVEL);
+    programa_personagens = buildProgram("personagens", VS_PERSONAGENS, FS_PERSONAGENS);
+    programa_esferas = buildProgram("esferas", VS_ESFERAS, FS_ESFERAS);
+    if (!programa_nivel || !programa_personagens || !programa_esferas) return false;
+
+    const GLuint programas[3] = { programa_nivel, programa_personagens, programa_esferas };
+    for (int i = 0; i < 3; i++) {
+        GLuint bloco = gl33.getUniformBlockIndex(programas[i], "Camera");
+        if (bloco == GL_INVALID_INDEX) return false;
+        gl33.uniformBlockBinding(programas[i], bloco, 0);
+    }
+    gl33.useProgram(programa_nivel);
+    gl33.uniform1i(gl33.getUniformLocation(programa_nivel, "imagem"), 0);
+    gl33.useProgram(0);
+    chama_esferas = gl33.getUniformLocation(programa_esferas, "chama");
+
+    gl33.genBuffers(1, &ubo_camera);
+    gl33.bindBuffer(GL_UNIFORM_BUFFER, ubo_camera);
+    gl33.bufferData(GL_UNIFORM_BUFFER, sizeof(CameraGPU), 0, GL_DYNAMIC_DRAW);
+    gl33.bindBufferBase(GL_UNIFORM_BUFFER, 0, ubo_camera);
+
+    vector<float> malha;
+    modelMesh(playerModel, malha);
+    vertices_modelo = (GLsizei)(malha.size() / FLOATS_VERTICE);
+    vbo_modelo = uploadMesh(malha);
+    malha.clear();
+    sphereMesh(malha);
+    vertices_esfera = (GLsizei)(malha.size() / FLOATS_VERTICE);
+    vbo_esfera = uploadMesh(malha);
+
+    initInstances(inst_jogadores, vbo_modelo);
+    initInstances(inst_inimigos, vbo_modelo);
+    initInstances(inst_bombas, vbo_esfera);
+    initInstances(inst_explosoes, vbo_esfera);
+    initLevelBuffers();
+
+    gl33.bindVertexArray(0);
+    gl33.bindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+// Câmera e luz do quadro no uniform buffer, numa cópia só
+static void beginShaderFrame() {
+    CameraGPU camera;
+    memcpy(camera.projecao, matriz_projecao, sizeof(camera.projecao));
+    memcpy(camera.vista, matriz_vista, sizeof(camera.vista));
+    memcpy(camera.luz, LUZ_POSICAO, sizeof(camera.luz));
+    for (int c = 0; c < 3; c++) {
+        camera.ambiente[c] = AMBIENTE_GLOBAL + LUZ_AMBIENTE[c];
+        camera.difusa[c] = LUZ_DIFUSA[c];
+    }
+    camera.ambiente[3] = camera.difusa[3] = 1.0f;
+    camera.tempo[0] = (float)tempo_cena;
+    camera.tempo[1] = camera.tempo[2] = camera.tempo[3] = 0.0f;
+    gl33.bindBuffer(GL_UNIFORM_BUFFER, ubo_camera);
+    gl33.bufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(camera), &camera);
+}
+
+// Devolve o estado que o GL fixo e os textos da tela esperam
+static void endShaderFrame() {
+    gl33.useProgram(0);
+    gl33.bindVertexArray(0);
+    gl33.bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void drawMapShaders() {
+    float planos[6][4];
+    int tx0, tz0, tx1, tz1;
+    prepareChunks(planos, tx0, tz0, tx1, tz1);
+
+    useProgram(programa_nivel);
+    bindVertexArray(vao_nivel);
+    updateGround();
+    drawLevelBuffer(vbo_chao, 4 * 8, tex_grama);
+    for (int tz = tz0; tz <= tz1; tz++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            Pedaco* p = visibleChunk(planos, tx, tz);
+            if (!p) continue;
+            if (!p->enviado) uploadChunk(*p);
+            drawLevelBuffer(p->vbo[0], p->paredes.size(), tex_azulejo);
+            drawLevelBuffer(p->vbo[1], p->blocos.size(), tex_tijolo);
+        }
+    }
+}
+
+// O jogador local com as cores do modelo; os outros em azul
+static void drawPlayersShaders() {
+    inst_jogadores.dados.clear();
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        if (!jogadores[j].ativo || !jogadores[j].vivo || !cellVisible(jogadores[j].x, jogadores[j].z)) continue;
+        if ((int)j == jogador_local) pushInstance(inst_jogadores, jogadores[j].x, jogadores[j].z, 1, 1, 1, 0);
+        else pushInstance(inst_jogadores, jogadores[j].x, jogadores[j].z, 0.3f, 0.5f, 1.0f, 1);
+    }
+    drawInstances(inst_jogadores, programa_personagens, vertices_modelo);
+}
+
+static void drawEnemiesShaders() {
+    inst_inimigos.dados.clear();
+    for (size_t i = 0; i < inimigos.size(); i++)
+        if (cellVisible(inimigos.x[i], inimigos.z[i]))
+            pushInstance(inst_inimigos, inimigos.x[i], inimigos.z[i], 1.0f, 0.0f, 0.0f, 1);
+    drawInstances(inst_inimigos, programa_personagens, vertices_modelo);
+}
+
+static void drawBombsShaders() {
+    inst_bombas.dados.clear();
+    for (size_t i = 0; i < bombas.size(); i++)
+        if (!bombas[i].explodiu && bombas[i].timer > 0 && cellVisible(bombas[i].x, bombas[i].z))
+            pushInstance(inst_bombas, bombas[i].x, bombas[i].z, 0.0f, 0.0f, 0.0f, 0);
+    drawInstances(inst_bombas, programa_esferas, vertices_esfera, 0);
+}
+
+// As mesmas esferas de drawExplosions(): o centro e os vizinhos que não são parede
+static void drawExplosionsShaders() {
+    inst_explosoes.dados.clear();
+    for (size_t i = 0; i < bombas.size(); i++) {
+        if (!bombas[i].explodiu || bombas[i].frame_explosao <= 0 || !cellVisible(bombas[i].x, bombas[i].z))
+            continue;
+        const int CELULAS[5][2] = { { 0, 0 }, { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 } };
+        for (int k = 0; k < 5; k++) {
+            int nx = bombas[i].x + CELULAS[k][0], nz = bombas[i].z + CELULAS[k][1];
+            if (k > 0 && gameMap.at(nx, nz) == CELULA_PAREDE) continue;
+            pushInstance(inst_explosoes, nx, nz, 1.0f, 0.3f, 0.0f, (float)(nx * 7 + nz * 13));
+        }
+    }
+    drawInstances(inst_explosoes, programa_esferas, vertices_esfera, 1);
+}
+
+// Fase do quadro: tempos e contagem das chamadas ao GL
+static void beginPhase(TemposQuadro& tempos, int fase) {
+    tempos.beginPhase(fase);
+    contagem = &contadores_gl[fase];
+}
+
+static void endPhase(TemposQuadro& tempos, int fase) {
+    tempos.endPhase(fase);
+    contagem = &contadores_gl[NUM_FASES];
+}
+
+// Função de cada fase (FaseQuadro) nos dois caminhos
+static void (*const DESENHO_FIXO[NUM_FASES])() = {
+    drawMap, drawPlayers, drawEnemies, drawBombs, drawExplosions
+};
+static void (*const DESENHO_SHADERS[NUM_FASES])() = {
+    drawMapShaders, drawPlayersShaders, drawEnemiesShaders, drawBombsShaders, drawExplosionsShaders
+};
+
+void renderScene(TemposQuadro& tempos) {
+    memset(contadores_gl, 0, sizeof(contadores_gl));
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    updateCamera();
+    if (shaders_ligados) {
+        beginShaderFrame();
+    } else {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(matriz_projecao);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(matriz_vista);
+    }
+    void (*const* desenho)() = shaders_ligados ? DESENHO_SHADERS : DESENHO_FIXO;
+
+    tempos.beginFrame();
+    for (int f = 0; f < NUM_FASES; f++) {
+        beginPhase(tempos, f);
+        desenho[f]();
+        endPhase(tempos, f);
+    }
+    tempos.endFrame();
+    if (shaders_ligados) endShaderFrame();
+
+    ContadoresGL& total = quadro_gl[NUM_FASES];
+    memset(&total, 0, sizeof(total));
+    for (int f = 0; f < NUM_FASES; f++) {
+        const ContadoresGL& c = quadro_gl[f] = contadores_gl[f];
+        total.desenhos += c.desenhos;
+        total.vertices += c.vertices;
+        total.texturas += c.texturas;
+        total.estados += c.estados;
+        total.matrizes += c.matrizes;
+    }
+    contadores_tick.quadros++;
+    contadores_tick.desenhos_gl += total.desenhos;
+    contadores_tick.vertices_gl += total.vertices;
+    contadores_tick.texturas_gl += total.texturas;
+    contadores_tick.estados_gl += total.estados;
+    contadores_tick.matrizes_gl += total.matrizes;
+}
+
+void updateCamera() {
+    float rad_y = cam_angle_y * 3.141592f / 180.0f;
+    float rad_x = cam_angle_x * 3.141592f / 180.0f;
+
+    // Mapas pequenos cabem inteiros na tela e a câmera mira o centro;
+    // em arenas maiores ela acompanha o jogador
+    float alvo_x, alvo_z;
+    if (gameMap.largura <= MAPA_VISTA_INTEIRA && gameMap.altura <= MAPA_VISTA_INTEIRA) {
+        alvo_x = (gameMap.largura - 1) * 0.5f;
+        alvo_z = (gameMap.altura - 1) * 0.5f;
+    } else if (localPlayer()) {
+        alvo_x = (float)localPlayer()->x;
+        alvo_z = (float)localPlayer()->z;
+    } else {
+        alvo_x = alvo_z = 0.0f;
+    }
+
+    float eye_x = alvo_x + cam_dist * cos(rad_x) * sin(rad_y);
+    float eye_y = cam_dist * sin(rad_x);
+    float eye_z = alvo_z + cam_dist * cos(rad_x) * cos(rad_y);
+
+    lookAt(matriz_vista, eye_x, eye_y, eye_z, alvo_x, 0, alvo_z, 0, 1, 0);
+}
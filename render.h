@@ -0,0 +1,114 @@
+/*
+ * Desenho da cena: mapa, jogadores, inimigos, bombas e explosões
+ *
+ * Dois caminhos com a mesma cena: shaders do GL 3.3 (nível texturizado em
+ * buffers na GPU, personagens e esferas desenhados por instâncias, luz por
+ * pixel e chamas animadas), quando o contexto tem, e o GL 1.x fixo, que fica
+ * de reserva. A câmera e a luz vão para os shaders num uniform buffer
+ * atualizado uma vez por quadro.
+ *
+ * Não usa o GLUT, só GL e GLU, então desenha em qualquer contexto: a janela do
+ * jogo (main.cpp) ou um contexto EGL sem tela (bench_render), inclusive só com
+ * o perfil core. Os textos da tela (fim de jogo, perigo, tempos) ficam em
+ * main.cpp, com as fontes do GLUT.
+ */
+#ifndef RENDER_H
+#define RENDER_H
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+#ifdef __APPLE__
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl.h>
+    #include <OpenGL/glu.h>
+#else
+    #include <GL/gl.h>
+    #include <GL/glu.h>
+#endif
+#include "game.h"
+#include "timing.h"
+#include "tiny_obj_loader.h"
+#include <stdint.h>
+#include <vector>
+
+struct Model {
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+    std::vector<unsigned int> indices;
+    std::vector<int> material_ids; // IDs dos materiais para cada vértice
+    std::vector<tinyobj::material_t> materials; // Lista de materiais
+};
+
+// Texturas
+extern GLuint tex_grama;
+extern GLuint tex_azulejo;
+extern GLuint tex_tijolo;
+
+extern Model playerModel;
+
+// Jogador desta tela: offline é sempre o 0; com --conectar é a vaga dada pelo
+// servidor, e o estado da partida chega pela rede em vez de ser simulado aqui
+extern int jogador_local;
+const Jogador* localPlayer();
+
+extern float cam_angle_y;
+extern float cam_angle_x;
+extern float cam_dist; // Distância até o alvo (ajustada ao tamanho do mapa por fitCamera())
+
+// Até este tamanho o mapa inteiro cabe na tela
+const int MAPA_VISTA_INTEIRA = 25;
+
+// Estado do GL (profundidade, luz, cor de fundo), texturas e modelo de
+// 'assets' (diretório); sai do programa se faltar algum recurso, como antes.
+// Com 'carregar' (acha as funções do GL pelo nome) e um contexto 3.3, monta
+// os shaders e já desenha com eles; num contexto core sem eles, também sai.
+void initRenderer(const char* assets, CarregarFuncaoGL carregar = 0);
+void setViewport(int largura, int altura); // viewport e projeção
+void fitCamera();                          // distância da câmera conforme o mapa
+
+// Caminho do desenho: setShaders() devolve o que ficou valendo (sem GL 3.3
+// fica o fixo; no perfil core, sempre os shaders)
+bool usingShaders();
+bool setShaders(bool sim);
+
+// Relógio das animações dos shaders (chamas), em segundos; quem desenha
+// decide o que é o tempo (a janela usa o relógio, o bench_render o quadro)
+void setSceneTime(double segundos);
+
+// Há algo animado na tela (chamas com shaders): vale desenhar sem parar
+bool animatedScene();
+
+// Um quadro da cena (sem os textos), com os tempos de cada fase em 'tempos'
+void renderScene(TemposQuadro& tempos);
+
+// Trabalho mandado ao driver por uma fase (função draw*) do quadro, contado
+// pelas chamadas de render.cpp. O GL imediato esconde quanto custa cada quadro;
+// com isto dá para ver se uma otimização do desenho reduziu mesmo as chamadas.
+// renderScene() também soma o quadro inteiro em contadores_tick (stats.h).
+struct ContadoresGL {
+    uint32_t desenhos;  // glBegin/glDraw* (gluSphere() conta os seus; instâncias contam uma vez)
+    uint32_t vertices;  // glVertex* e os das listas de glDrawArrays
+    uint32_t texturas;  // glBindTexture
+    uint32_t estados;   // glEnable/glDisable; com shaders, também glUseProgram/glBindVertexArray
+    uint32_t matrizes;  // glPushMatrix/glPopMatrix
+};
+
+// Do último quadro desenhado por renderScene(); fase = NUM_FASES é o total
+const ContadoresGL& glCounters(int fase);
+
+void updateCamera(); // matriz de vista da câmera (CPU)
+void drawMap();
+void drawPlayers();
+void drawEnemies();
+void drawBombs();
+void drawExplosions();
+void drawGroundTextured();
+void drawCubeTextured(GLuint tex);
+void drawModel(const Model& model);
+void drawModelWithColor(const Model& model, float r, float g, float b);
+bool loadModel(const char* filename, Model& model);
+GLuint loadTexture(const char* filename);
+
+#endif
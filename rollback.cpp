@@ -0,0 +1,317 @@
+/*
+ * Partida em rede por rollback (ver rollback.h)
+ *
+ * MSG_ENTRADAS_PAR: u16 de, u16 para, u32 quadros do destinatário já recebidos
+ * (o último confirmado + 1), u32 primeiro quadro, u16 n e as n entradas
+ * locais seguintes. Cada mensagem repete tudo que o destinatário ainda não
+ * confirmou, então a perda de um datagrama só atrasa as entradas. No fim vão
+ * um u32 quadro (0xFFFFFFFF = nenhum) e a soma do estado no começo dele (u32
+ * baixo, u32 alto), de um quadro que já não pode mudar, para os pares
+ * perceberem quando as partidas divergem.
+ */
+#include "rollback.h"
+#include "protocol.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+void stepFrame(const uint8_t* entradas, int quadro, int passo) {
+    for (size_t j = 0; j < jogadores.size(); j++) {
+        int movimento = entradas[j] & ENTRADA_MOVIMENTO;
+        if (movimento != ACAO_NENHUMA && movimento < ACAO_BOMBA) applyAction((int)j, movimento);
+        if (entradas[j] & ENTRADA_BOMBA) applyAction((int)j, ACAO_BOMBA);
+    }
+    if (quadro % passo == passo - 1 && !player_won && anyPlayerAlive()) stepGame();
+}
+
+SessaoRollback::SessaoRollback()
+    : n_jogadores(0), local(0), passo(1), atual(0), primeiro_errado(INT_MAX), quadro_dessincronizado(-1) {}
+
+void SessaoRollback::start(int n, int jogador_local, int passo_regras) {
+    n_jogadores = n;
+    local = jogador_local;
+    passo = passo_regras > 0 ? passo_regras : 1;
+    atual = 0;
+    primeiro_errado = INT_MAX;
+    entradas.assign((size_t)HISTORICO_ENTRADAS * n, 0);
+    confirmado.assign(n, -1);
+    confirmado_por.assign(n, -1);
+    quadro_foto.assign(JANELA_ROLLBACK, -1);
+    for (int k = 0; k < SOMAS_VERIFICACAO; k++) quadro_soma[k] = -1;
+    quadro_soma_par.assign(n, -1);
+    soma_par.assign(n, 0);
+    verificado_par.assign(n, -1);
+    quadro_dessincronizado = -1;
+    est = EstatisticasRollback();
+}
+
+int SessaoRollback::confirmedFrame() const {
+    int menor = atual - 1;
+    for (int j = 0; j < n_jogadores; j++) menor = min(menor, confirmado[j]);
+    return menor;
+}
+
+void SessaoRollback::simulate(int quadro) {
+    // Quadro com alguma entrada ainda prevista pode ter de ser refeito: guarda
+    // a foto do começo dele. Quadros com tudo confirmado nunca voltam.
+    bool previsto = false;
+    for (int j = 0; j < n_jogadores && !previsto; j++) previsto = confirmado[j] < quadro;
+    if (previsto) {
+        int k = quadro % JANELA_ROLLBACK;
+        snapshot(fotos[k]);
+        quadro_foto[k] = quadro;
+        est.fotos++;
+    } else if (quadro_foto[quadro % JANELA_ROLLBACK] == quadro) {
+        quadro_foto[quadro % JANELA_ROLLBACK] = -1; // re-simulado já confirmado: a foto antiga não vale mais
+    }
+    if (quadro % INTERVALO_VERIFICACAO == 0) {
+        int k = (quadro / INTERVALO_VERIFICACAO) % SOMAS_VERIFICACAO;
+        somas[k] = stateChecksum();
+        quadro_soma[k] = quadro;
+    }
+    stepFrame(&entradas[(size_t)(quadro % HISTORICO_ENTRADAS) * n_jogadores], quadro, passo);
+}
+
+// A soma guardada do começo de 'quadro' só é definitiva quando todas as
+// entradas anteriores estão confirmadas e nenhuma re-simulação antes dele está
+// pendente
+bool SessaoRollback::finalChecksum(int quadro, uint64_t& soma) const {
+    int k = (quadro / INTERVALO_VERIFICACAO) % SOMAS_VERIFICACAO;
+    if (quadro < 0 || quadro >= atual || quadro > confirmedFrame() + 1 || primeiro_errado < quadro ||
+        quadro_soma[k] != quadro)
+        return false;
+    soma = somas[k];
+    return true;
+}
+
+// Compara as somas recebidas dos pares com as nossas, quando já são definitivas
+void SessaoRollback::verify() {
+    for (int j = 0; j < n_jogadores; j++) {
+        int quadro = quadro_soma_par[j];
+        if (quadro <= verificado_par[j]) continue;
+        uint64_t soma;
+        if (!finalChecksum(quadro, soma)) {
+            // A nossa ainda pode mudar; se já saiu do anel, não dá mais para comparar
+            int k = (quadro / INTERVALO_VERIFICACAO) % SOMAS_VERIFICACAO;
+            if (quadro < atual && quadro_soma[k] != quadro) verificado_par[j] = quadro;
+            continue;
+        }
+        est.verificacoes++;
+        if (soma != soma_par[j]) {
+            est.dessincronias++;
+            if (quadro_dessincronizado < 0 || quadro < quadro_dessincronizado) quadro_dessincronizado = quadro;
+        }
+        verificado_par[j] = quadro;
+    }
+}
+
+int SessaoRollback::synchronize() {
+    if (primeiro_errado >= atual) {
+        primeiro_errado = INT_MAX;
+        verify();
+        return 0;
+    }
+    // canAdvance() garante que o quadro errado ainda está na janela das fotos
+    int k = primeiro_errado % JANELA_ROLLBACK;
+    if (quadro_foto[k] != primeiro_errado) {
+        fprintf(stderr, "Rollback: sem foto do quadro %d\n", primeiro_errado);
+        primeiro_errado = INT_MAX;
+        return 0;
+    }
+
+    double inicio = nowSeconds();
+    restore(fotos[k]);
+    for (int q = primeiro_errado; q < atual; q++) simulate(q);
+    double tempo = nowSeconds() - inicio;
+
+    int resimulados = atual - primeiro_errado;
+    primeiro_errado = INT_MAX;
+    est.rollbacks++;
+    est.quadros_resimulados += resimulados;
+    est.max_resimulados = max(est.max_resimulados, resimulados);
+    est.tempo_rollback_total += tempo;
+    est.tempo_rollback_max = max(est.tempo_rollback_max, tempo);
+    verify();
+    return resimulados;
+}
+
+bool SessaoRollback::canAdvance() {
+    for (int j = 0; j < n_jogadores; j++) {
+        if (j != local && atual - confirmado[j] >= JANELA_ROLLBACK) {
+            est.esperas++;
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessaoRollback::advance(uint8_t entrada_local) {
+    // A vaga do quadro no anel ainda tem as entradas de HISTORICO_ENTRADAS
+    // quadros atrás; as que não chegaram ficam previstas (nenhuma ação)
+    uint8_t* e = &entradas[(size_t)(atual % HISTORICO_ENTRADAS) * n_jogadores];
+    for (int j = 0; j < n_jogadores; j++)
+        if (confirmado[j] < atual) e[j] = 0;
+    e[local] = entrada_local;
+    confirmado[local] = atual;
+
+    simulate(atual);
+    atual++;
+    est.quadros++;
+}
+
+size_t SessaoRollback::writeInputs(uint8_t* buf, size_t cap, int para) const {
+    // Entradas mais velhas que isto já saíram do anel (e o par não pode estar
+    // tão atrás: ele espera por nós antes)
+    int primeiro = max(confirmado_por[para] + 1, atual - (HISTORICO_ENTRADAS - JANELA_ROLLBACK));
+    primeiro = max(primeiro, 0);
+    int n = atual - primeiro;
+
+    Escritor e(buf, cap);
+    writeHeader(e, MSG_ENTRADAS_PAR);
+    e.u16((uint16_t)local);
+    e.u16((uint16_t)para);
+    e.u32((uint32_t)(confirmado[para] + 1));
+    e.u32((uint32_t)primeiro);
+    e.u16((uint16_t)n);
+    for (int q = primeiro; q < atual; q++) e.u8(entradas[(size_t)(q % HISTORICO_ENTRADAS) * n_jogadores + local]);
+
+    // O quadro verificável mais novo: o último múltiplo do intervalo com todas
+    // as entradas anteriores confirmadas
+    int verificado = (confirmedFrame() + 1) / INTERVALO_VERIFICACAO * INTERVALO_VERIFICACAO;
+    uint64_t soma = 0;
+    if (!finalChecksum(verificado, soma)) verificado = -1;
+    e.u32((uint32_t)verificado);
+    e.u32((uint32_t)soma);
+    e.u32((uint32_t)(soma >> 32));
+    return e.estourou ? 0 : e.tam;
+}
+
+bool SessaoRollback::readInputs(const uint8_t* buf, size_t tam) {
+    Leitor l(buf, tam);
+    uint8_t tipo;
+    if (!readHeader(l, tipo) || tipo != MSG_ENTRADAS_PAR) return false;
+    int de = l.u16(), para = l.u16();
+    int recebidos = (int)l.u32();
+    int primeiro = (int)l.u32();
+    int n = l.u16();
+    const uint8_t* valores = l.skip(n);
+    int verificado = (int)l.u32();
+    uint64_t soma = l.u32();
+    soma |= (uint64_t)l.u32() << 32;
+    if (l.erro || de >= n_jogadores || de == local || para != local || primeiro < 0) return false;
+
+    if (recebidos - 1 > confirmado_por[de] && recebidos - 1 < atual) confirmado_por[de] = recebidos - 1;
+
+    // Só entradas contíguas às confirmadas e que cabem no anel (o par nunca
+    // está mais que JANELA_ROLLBACK quadros à nossa frente)
+    for (int i = 0; i < n; i++) {
+        int q = primeiro + i;
+        if (q <= confirmado[de]) continue;
+        if (q != confirmado[de] + 1 || q >= atual + JANELA_ROLLBACK) break;
+        uint8_t& e = entradas[(size_t)(q % HISTORICO_ENTRADAS) * n_jogadores + de];
+        if (q >= atual) e = valores[i];
+        else if (valores[i] != 0) {
+            // Já simulado com a previsão (nenhuma ação): errou
+            e = valores[i];
+            primeiro_errado = min(primeiro_errado, q);
+        }
+        confirmado[de] = q;
+    }
+
+    if (verificado >= 0 && verificado > quadro_soma_par[de]) {
+        quadro_soma_par[de] = verificado;
+        soma_par[de] = soma;
+        verify();
+    }
+    return true;
+}
+
+TransporteSimulado::TransporteSimulado(const ConfigTransporte& c, uint64_t semente) : cfg(c), gerador(semente) {}
+
+void TransporteSimulado::send(int, int para, const uint8_t* dados, size_t n, double agora) {
+    double sorteio = (double)(splitmix64(gerador) >> 11) / (double)(1ULL << 53);
+    if (sorteio < cfg.perda) return;
+    double variacao = (double)(splitmix64(gerador) >> 11) / (double)(1ULL << 53) * cfg.jitter;
+    Datagrama d;
+    d.para = para;
+    d.chegada = agora + cfg.latencia + variacao;
+    d.dados.assign(dados, dados + n);
+    fila.push_back(d);
+}
+
+int TransporteSimulado::recv(int para, uint8_t* buf, size_t cap, double agora) {
+    // O que chegou primeiro (com variação, não é necessariamente o primeiro enviado)
+    size_t escolhido = fila.size();
+    for (size_t i = 0; i < fila.size(); i++)
+        if (fila[i].para == para && fila[i].chegada <= agora &&
+            (escolhido == fila.size() || fila[i].chegada < fila[escolhido].chegada))
+            escolhido = i;
+    if (escolhido == fila.size()) return -1;
+
+    size_t n = min(cap, fila[escolhido].dados.size());
+    memcpy(buf, &fila[escolhido].dados[0], n);
+    fila[escolhido] = fila.back();
+    fila.pop_back();
+    return (int)n;
+}
+
+bool peersOpen(ConexaoPares& conexao, const char* lista, int local) {
+    conexao.pares.clear();
+    const char* p = lista;
+    while (*p) {
+        const char* fim = strchr(p, ',');
+        size_t n = fim ? (size_t)(fim - p) : strlen(p);
+        char endereco[64];
+        EnderecoUdp e;
+        if (n >= sizeof(endereco)) n = sizeof(endereco) - 1;
+        memcpy(endereco, p, n);
+        endereco[n] = 0;
+        if (!parseAddress(endereco, e)) {
+            fprintf(stderr, "Endereco invalido: %s (use IP:PORTA,IP:PORTA,...)\n", endereco);
+            return false;
+        }
+        conexao.pares.push_back(e);
+        p = fim ? fim + 1 : p + n;
+    }
+    if (conexao.pares.size() < 2 || local < 0 || local >= (int)conexao.pares.size()) {
+        fprintf(stderr, "A partida por rollback precisa de 2 ou mais pares e do indice deste entre eles\n");
+        return false;
+    }
+    if (!netInit() || (conexao.sock = udpOpen(conexao.pares[local].porta)) == SOCKET_INVALIDO) {
+        fprintf(stderr, "Nao foi possivel abrir a porta UDP %d\n", conexao.pares[local].porta);
+        return false;
+    }
+    return true;
+}
+
+void peersReceive(ConexaoPares& conexao, SessaoRollback& sessao) {
+    uint8_t buf[1500];
+    EnderecoUdp de;
+    int n;
+    while ((n = udpRecv(conexao.sock, de, buf, sizeof(buf))) >= 0) {
+        // Só aceita de quem a lista diz ser o remetente
+        Leitor l(buf, (size_t)n);
+        uint8_t tipo;
+        if (!readHeader(l, tipo)) continue;
+        int j = l.u16();
+        if (l.erro || j >= (int)conexao.pares.size() || !(conexao.pares[j] == de)) continue;
+        sessao.readInputs(buf, (size_t)n);
+    }
+}
+
+void peersSend(ConexaoPares& conexao, const SessaoRollback& sessao) {
+    uint8_t buf[1500];
+    for (size_t j = 0; j < conexao.pares.size(); j++) {
+        if ((int)j == sessao.localPlayer()) continue;
+        size_t tam = sessao.writeInputs(buf, sizeof(buf), (int)j);
+        if (tam > 0) udpSend(conexao.sock, conexao.pares[j], buf, tam);
+    }
+}
+
+void peersClose(ConexaoPares& conexao) {
+    if (conexao.sock == SOCKET_INVALIDO) return;
+    udpClose(conexao.sock);
+    conexao.sock = SOCKET_INVALIDO;
+}
@@ -0,0 +1,160 @@
+/*
+ * Partida em rede por rollback, ponto a ponto (sem servidor)
+ *
+ * Todos os pares começam do mesmo estado (mesma semente e opções de partida) e
+ * simulam a partida inteira localmente em quadros de tamanho fixo. Só as
+ * entradas viajam pela rede. A entrada local entra no quadro atual na hora; a
+ * dos outros jogadores ainda não chegou, então é prevista. Quando a entrada
+ * real chega e contradiz a previsão, a sessão volta à foto (snapshot()) do
+ * primeiro quadro errado e re-simula até o presente, tudo dentro do quadro
+ * atual. A previsão é "nenhuma ação": as teclas são eventos (glutIgnoreKeyRepeat),
+ * então repetir a última entrada, como se faz com controles analógicos, erraria
+ * quase sempre.
+ *
+ * A sessão não conhece o transporte: writeInputs()/readInputs() produzem e
+ * consomem as mensagens, que vão por UDP (ConexaoPares) ou pelo transporte
+ * simulado com atraso e variação (TransporteSimulado) do benchmark.
+ */
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "net.h"
+#include "game.h"
+#include <vector>
+
+// Entrada de um jogador num quadro: um movimento (Acao) e, junto, o pedido de bomba
+const uint8_t ENTRADA_MOVIMENTO = 0x07;
+const uint8_t ENTRADA_BOMBA = 0x80;
+
+const int QUADROS_ROLLBACK = 30;    // quadros por segundo (iguais em todos os pares)
+const int PASSO_ROLLBACK = 12;      // quadros por passo das regras: 0,4 s, como offline
+const int JANELA_ROLLBACK = 16;     // quadros que a simulação pode andar à frente das entradas confirmadas
+const int HISTORICO_ENTRADAS = 128; // quadros de entradas guardados (reenviados até serem confirmados)
+const int INTERVALO_VERIFICACAO = QUADROS_ROLLBACK; // quadros entre as somas do estado trocadas com os pares
+const int SOMAS_VERIFICACAO = 4;    // somas próprias guardadas para comparar com as que chegam
+
+// Um quadro da partida: as entradas de todos os jogadores (na ordem dos
+// índices) e, a cada 'passo' quadros, um passo das regras enquanto a partida
+// não acabou. Determinístico: pares com o mesmo estado e as mesmas entradas
+// chegam ao mesmo estado.
+void stepFrame(const uint8_t* entradas, int quadro, int passo);
+
+struct EstatisticasRollback {
+    uint64_t quadros;            // quadros avançados
+    uint64_t rollbacks;          // previsões erradas corrigidas
+    uint64_t quadros_resimulados;
+    int max_resimulados;         // maior re-simulação de uma vez
+    uint64_t esperas;            // vezes que a sessão não pôde avançar (entradas atrasadas demais)
+    uint64_t fotos;              // snapshot() feitos (quadros que ainda podiam voltar)
+    double tempo_rollback_total; // segundos em restore() + re-simulação
+    double tempo_rollback_max;
+    uint64_t verificacoes;       // somas de um par comparadas com a nossa
+    uint64_t dessincronias;      // e as que não bateram
+
+    EstatisticasRollback() : quadros(0), rollbacks(0), quadros_resimulados(0), max_resimulados(0), esperas(0),
+                             fotos(0), tempo_rollback_total(0), tempo_rollback_max(0), verificacoes(0),
+                             dessincronias(0) {}
+};
+
+class SessaoRollback {
+public:
+    SessaoRollback();
+
+    // Depois de initMap() com o estado inicial combinado entre os pares
+    void start(int n_jogadores, int local, int passo);
+
+    int currentFrame() const { return atual; }
+    int localPlayer() const { return local; }
+    // Último quadro com as entradas de todos os jogadores confirmadas (-1 = nenhum)
+    int confirmedFrame() const;
+    // Primeiro quadro em que a soma do estado (stateChecksum()) de algum par
+    // não bateu com a nossa: a partida dos dois divergiu (-1 = nenhum)
+    int desyncFrame() const { return quadro_dessincronizado; }
+
+    // Volta e re-simula se chegou alguma entrada que contradiz a previsão;
+    // retorna quantos quadros foram re-simulados
+    int synchronize();
+    // false se avançar deixaria a previsão mais de JANELA_ROLLBACK quadros à
+    // frente de algum jogador (conta como espera)
+    bool canAdvance();
+    // Simula o quadro atual com a entrada local e passa para o próximo
+    void advance(uint8_t entrada_local);
+
+    // Mensagem MSG_ENTRADAS_PAR para o jogador 'para': as entradas locais que
+    // ele ainda não confirmou e a confirmação das dele. Retorna o tamanho (0 se
+    // não couber).
+    size_t writeInputs(uint8_t* buf, size_t cap, int para) const;
+    // false se a mensagem não é de um par desta sessão
+    bool readInputs(const uint8_t* buf, size_t n);
+
+    EstatisticasRollback est;
+
+private:
+    int n_jogadores, local, passo;
+    int atual;                       // próximo quadro a simular
+    int primeiro_errado;             // menor quadro já simulado com previsão errada (INT_MAX = nenhum)
+    std::vector<uint8_t> entradas;   // [quadro % HISTORICO_ENTRADAS][jogador], 0 enquanto prevista
+    std::vector<int> confirmado;     // último quadro contíguo confirmado de cada jogador
+    std::vector<int> confirmado_por; // último quadro local que cada par confirmou ter recebido
+    GameState fotos[JANELA_ROLLBACK]; // estado no começo de cada quadro que ainda pode voltar
+    std::vector<int> quadro_foto;    // quadro guardado em cada foto (-1 = nenhum)
+    // Soma do estado no começo dos quadros múltiplos de INTERVALO_VERIFICACAO
+    uint64_t somas[SOMAS_VERIFICACAO];
+    int quadro_soma[SOMAS_VERIFICACAO];
+    std::vector<int> quadro_soma_par; // quadro da última soma recebida de cada par (-1 = nenhuma)
+    std::vector<uint64_t> soma_par;
+    std::vector<int> verificado_par;  // último quadro de cada par já comparado
+    int quadro_dessincronizado;
+
+    void simulate(int quadro);
+    bool finalChecksum(int quadro, uint64_t& soma) const;
+    void verify();
+};
+
+// Transporte de teste: entrega os datagramas entre pares do mesmo processo com
+// atraso, variação (jitter) e perda configuráveis, num relógio controlado pelo
+// chamador. A variação pode trocar a ordem dos datagramas, como numa rede real.
+struct ConfigTransporte {
+    double latencia; // segundos, só ida
+    double jitter;   // variação uniforme de 0 a este valor somada à latência
+    double perda;    // fração dos datagramas descartados
+
+    ConfigTransporte() : latencia(0), jitter(0), perda(0) {}
+};
+
+class TransporteSimulado {
+public:
+    TransporteSimulado(const ConfigTransporte& cfg, uint64_t semente);
+
+    void send(int de, int para, const uint8_t* dados, size_t n, double agora);
+    // Próximo datagrama para 'para' que já chegou até 'agora': tamanho, ou -1
+    int recv(int para, uint8_t* buf, size_t cap, double agora);
+
+private:
+    struct Datagrama {
+        int para;
+        double chegada;
+        std::vector<uint8_t> dados;
+    };
+    ConfigTransporte cfg;
+    uint64_t gerador;
+    std::vector<Datagrama> fila;
+};
+
+// Transporte UDP do jogo: um socket local e o endereço de cada par (o índice
+// é o do jogador)
+struct ConexaoPares {
+    SocketUdp sock;
+    std::vector<EnderecoUdp> pares;
+
+    ConexaoPares() : sock(SOCKET_INVALIDO) {}
+};
+
+// 'lista' é "IP:PORTA,IP:PORTA,..." com todos os jogadores, igual em todos os
+// pares; o socket local abre na porta do jogador 'local'
+bool peersOpen(ConexaoPares& conexao, const char* lista, int local);
+void peersReceive(ConexaoPares& conexao, SessaoRollback& sessao); // lê as entradas que chegaram
+void peersSend(ConexaoPares& conexao, const SessaoRollback& sessao); // manda as locais a todos os pares
+void peersClose(ConexaoPares& conexao);
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * Servidor autoritativo da partida
+ *
+ * Cada tick de rede: lê todos os datagramas, aplica a última ação de cada
+ * cliente (applyAction), avança as regras quando é a vez (as regras continuam
+ * no passo de 400 ms do jogo offline) e manda o estado a todos os clientes,
+ * codificado (delta.h) contra a última base que cada um confirmou. Clientes
+ * com a mesma base recebem os mesmos bytes, codificados uma vez só.
+ */
+#include "server.h"
+#include "protocol.h"
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// Uma vaga por jogador: o índice do cliente é o índice em jogadores
+struct Cliente {
+    bool conectado;
+    EnderecoUdp endereco;
+    uint32_t token;
+    uint32_t ultima_entrada; // seq da última MSG_ENTRADA aceita
+    uint32_t base;           // último estado que o cliente confirmou ter decodificado
+    int movimento;           // último movimento pedido desde o tick anterior
+    bool bomba;              // pedido de bomba (não se perde se vier junto com movimento)
+    double visto;
+    double ultimo_completo;  // quando recebeu o último estado completo de vários fragmentos
+
+    Cliente() : conectado(false), token(0), ultima_entrada(0), base(0), movimento(ACAO_NENHUMA), bomba(false),
+                visto(0), ultimo_completo(-1) {}
+};
+
+// Estado codificado contra uma base, reaproveitado por todos os clientes com ela
+struct EstadoCodificado {
+    uint32_t base;
+    std::vector<uint8_t> bytes;
+};
+
+static const double PASSO_REGRAS = 0.4;  // segundos por stepGame(), como o timer do jogo
+static const double ESPERA_REINICIO = 2.0;
+// Um estado completo grande (vários fragmentos) só é repetido depois deste
+// intervalo, dando tempo para a confirmação chegar
+static const double INTERVALO_COMPLETO = 0.25;
+
+static void ackState(Cliente& c, uint32_t seq, uint32_t seq_atual) {
+    // Só vale confirmação de um estado já enviado e mais novo que a base atual
+    if (seq != 0 && (int32_t)(seq_atual - seq) >= 0 && (c.base == 0 || (int32_t)(seq - c.base) > 0)) c.base = seq;
+}
+
+static void sendWelcome(SocketUdp sock, const Cliente& c, int j, int hz) {
+    uint8_t buf[32];
+    Escritor e(buf, sizeof(buf));
+    writeHeader(e, MSG_BEMVINDO);
+    e.u16((uint16_t)j);
+    e.u32(c.token);
+    e.u16((uint16_t)hz);
+    udpSend(sock, c.endereco, buf, e.tam);
+}
+
+static void sendFull(SocketUdp sock, const EnderecoUdp& para) {
+    uint8_t buf[16];
+    Escritor e(buf, sizeof(buf));
+    writeHeader(e, MSG_CHEIO);
+    udpSend(sock, para, buf, e.tam);
+}
+
+bool runServer(const ConfigServidor& cfg, const atomic<bool>& parar, EstatisticasServidor* estatisticas) {
+    EstatisticasServidor local;
+    EstatisticasServidor& est = estatisticas ? *estatisticas : local;
+
+    SocketUdp sock = netInit() ? udpOpen(cfg.porta) : SOCKET_INVALIDO;
+    if (sock == SOCKET_INVALIDO) {
+        fprintf(stderr, "Nao foi possivel abrir a porta UDP %d\n", cfg.porta);
+        return false;
+    }
+    // Centenas de clientes mandam entradas ao mesmo tempo: fila grande no sistema
+    udpSetBuffers(sock, 4 << 20);
+    est.porta = udpLocalPort(sock);
+
+    const int hz = cfg.hz > 0 ? cfg.hz : 20;
+    const double periodo = 1.0 / hz;
+    int passo = (int)(PASSO_REGRAS * hz + 0.5);
+    if (passo < 1) passo = 1;
+
+    jogadores.clear();
+    initMap();
+
+    vector<Cliente> clientes;
+    int conectados = 0;
+    uint64_t gerador = ((uint64_t)rand() << 32) ^ (uint64_t)rand() ^ (uint64_t)(nowSeconds() * 1e6);
+
+    HistoricoDelta historico;
+    vector<EstadoCodificado> codificados; // deste tick, um por base
+    size_t n_codificados = 0;
+
+    vector<uint8_t> buf(TAMANHO_MAX_DATAGRAMA);
+    uint32_t seq_estado = 0;
+    int ticks_ate_regras = passo;
+    double reinicio = -1; // quando recomeçar a partida que acabou
+
+    double proximo = nowSeconds();
+    while (!parar) {
+        double agora = nowSeconds();
+        if (agora < proximo) {
+            sleepSeconds(proximo - agora);
+            continue;
+        }
+        // Atrasado mais de um tick (máquina ocupada): não tenta compensar
+        proximo = agora - proximo > periodo ? agora + periodo : proximo + periodo;
+
+        // Entradas
+        EnderecoUdp de;
+        int n;
+        while ((n = udpRecv(sock, de, &buf[0], buf.size())) >= 0) {
+            Leitor l(&buf[0], (size_t)n);
+            uint8_t tipo;
+            if (!readHeader(l, tipo)) continue;
+
+            if (tipo == MSG_OLA) {
+                // OLA repetido (o BEMVINDO se perdeu): responde com a mesma vaga
+                int j = -1;
+                for (size_t c = 0; c < clientes.size() && j < 0; c++)
+                    if (clientes[c].conectado && clientes[c].endereco == de) j = (int)c;
+                if (j < 0) {
+                    if (conectados >= cfg.max_clientes) {
+                        sendFull(sock, de);
+                        continue;
+                    }
+                    j = addPlayer();
+                    if ((size_t)j >= clientes.size()) clientes.resize(j + 1);
+                    Cliente& c = clientes[j];
+                    c = Cliente();
+                    c.conectado = true;
+                    c.endereco = de;
+                    c.token = (uint32_t)splitmix64(gerador) | 1;
+                    c.visto = agora;
+                    if (++conectados > est.clientes_max) est.clientes_max = conectados;
+                }
+                sendWelcome(sock, clientes[j], j, hz);
+                continue;
+            }
+
+            int j = l.u16();
+            uint32_t token = l.u32();
+            if (l.erro || j >= (int)clientes.size() || !clientes[j].conectado || clientes[j].token != token) continue;
+            Cliente& c = clientes[j];
+            c.visto = agora;
+
+            if (tipo == MSG_ENTRADA) {
+                uint32_t seq = l.u32();
+                int acao = l.u8();
+                uint32_t ack = l.u32();
+                if (l.erro) continue;
+                ackState(c, ack, seq_estado);
+                // Descarta entradas repetidas ou atrasadas
+                if ((int32_t)(seq - c.ultima_entrada) <= 0) continue;
+                c.ultima_entrada = seq;
+                est.entradas_recebidas++;
+                if (acao == ACAO_BOMBA) c.bomba = true;
+                else if (acao > ACAO_NENHUMA && acao < NUM_ACOES) c.movimento = acao;
+            } else if (tipo == MSG_ACK) {
+                uint32_t ack = l.u32();
+                if (!l.erro) ackState(c, ack, seq_estado);
+            } else if (tipo == MSG_TCHAU) {
+                c.conectado = false;
+                removePlayer(j);
+                conectados--;
+            }
+        }
+
+        // Clientes calados há muito tempo saem da partida
+        for (size_t j = 0; j < clientes.size(); j++) {
+            if (clientes[j].conectado && agora - clientes[j].visto > cfg.timeout) {
+                clientes[j].conectado = false;
+                removePlayer((int)j);
+                conectados--;
+            }
+        }
+
+        // Ações, na ordem dos jogadores
+        for (size_t j = 0; j < clientes.size(); j++) {
+            Cliente& c = clientes[j];
+            if (!c.conectado) continue;
+            if (c.movimento != ACAO_NENHUMA) applyAction((int)j, c.movimento);
+            if (c.bomba) applyAction((int)j, ACAO_BOMBA);
+            c.movimento = ACAO_NENHUMA;
+            c.bomba = false;
+        }
+
+        // Regras (só com alguém jogando) e recomeço depois do fim da partida
+        if (reinicio >= 0 && agora >= reinicio) {
+            reinicio = -1;
+            initMap();
+        } else if (conectados > 0 && reinicio < 0 && --ticks_ate_regras <= 0) {
+            ticks_ate_regras = passo;
+            stepGame();
+            if (player_won || !anyPlayerAlive()) reinicio = agora + ESPERA_REINICIO;
+        }
+
+        // Estado: um quadro novo no histórico e, para cada cliente, o delta
+        // contra a base dele (codificado uma vez por base distinta)
+        if (conectados > 0) {
+            historico.record(++seq_estado);
+            n_codificados = 0;
+            for (size_t j = 0; j < clientes.size(); j++) {
+                Cliente& c = clientes[j];
+                if (!c.conectado) continue;
+                uint32_t base = historico.isBaseline(c.base) ? c.base : 0;
+
+                size_t k = 0;
+                while (k < n_codificados && codificados[k].base != base) k++;
+                if (k == n_codificados) {
+                    if (codificados.size() == n_codificados) codificados.push_back(EstadoCodificado());
+                    codificados[k].base = base;
+                    historico.encode(base, codificados[k].bytes);
+                    n_codificados++;
+                    if (base == 0) est.estados_completos++;
+                }
+                const vector<uint8_t>& bytes = codificados[k].bytes;
+
+                FragmentoEstado f;
+                f.seq = seq_estado;
+                f.ultima_entrada = c.ultima_entrada;
+                f.partes = (int)((bytes.size() + TAMANHO_FRAGMENTO - 1) / TAMANHO_FRAGMENTO);
+                if (f.partes > MAX_PARTES_ESTADO) continue; // o cliente descartaria
+                if (base == 0 && f.partes > 1) {
+                    if (c.ultimo_completo >= 0 && agora - c.ultimo_completo < INTERVALO_COMPLETO) continue;
+                    c.ultimo_completo = agora;
+                }
+                for (f.parte = 0; f.parte < f.partes; f.parte++) {
+                    f.dados = &bytes[(size_t)f.parte * TAMANHO_FRAGMENTO];
+                    f.tam = min(TAMANHO_FRAGMENTO, bytes.size() - (size_t)f.parte * TAMANHO_FRAGMENTO);
+                    size_t tam = writeFragment(&buf[0], buf.size(), f);
+                    udpSend(sock, c.endereco, &buf[0], tam);
+                    est.bytes_enviados += tam;
+                }
+                est.estados_enviados++;
+            }
+        }
+
+        double trabalho = nowSeconds() - agora;
+        est.ticks++;
+        est.tempo_tick_total += trabalho;
+        if (trabalho > est.tempo_tick_max) est.tempo_tick_max = trabalho;
+    }
+
+    udpClose(sock);
+    return true;
+}
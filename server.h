@@ -0,0 +1,40 @@
+/*
+ * Servidor autoritativo da partida (sem OpenGL): simula a partida num tick fixo,
+ * recebe as ações dos clientes por UDP e manda o estado para todos
+ */
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <stdint.h>
+
+struct ConfigServidor {
+    uint16_t porta;       // 0 = porta qualquer (ver EstatisticasServidor::porta)
+    int hz;               // ticks de rede por segundo (entradas e estado)
+    int max_clientes;
+    double timeout;       // segundos sem notícias até o cliente cair
+
+    ConfigServidor() : porta(27015), hz(20), max_clientes(256), timeout(3.0) {}
+};
+
+struct EstatisticasServidor {
+    std::atomic<uint16_t> porta; // porta em uso, assim que o socket abrir
+    uint64_t ticks;
+    uint64_t estados_enviados;
+    uint64_t estados_completos; // codificados sem base (cliente novo, base perdida, partida nova)
+    uint64_t bytes_enviados;
+    uint64_t entradas_recebidas;
+    int clientes_max;
+    double tempo_tick_total; // segundos de trabalho (sem contar a espera pelo próximo tick)
+    double tempo_tick_max;
+
+    EstatisticasServidor() : porta(0), ticks(0), estados_enviados(0), estados_completos(0), bytes_enviados(0),
+                             entradas_recebidas(0), clientes_max(0), tempo_tick_total(0), tempo_tick_max(0) {}
+};
+
+// Roda até *parar ficar true. Usa o estado global da partida (game.h): o mapa e
+// os inimigos já configurados (setMapSize, num_inimigos, ...) valem para todas
+// as partidas. 'estatisticas' pode ser nulo.
+bool runServer(const ConfigServidor& cfg, const std::atomic<bool>& parar, EstatisticasServidor* estatisticas);
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Servidor dedicado (sem janela): bomberman_servidor [opções]
+ */
+#include "server.h"
+#include "host.h"
+#include "protocol.h"
+#include "parallel.h"
+#include "stats.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <thread>
+using namespace std;
+
+static atomic<bool> parar(false);
+
+static void stopServer(int) { parar = true; }
+
+static int runHostMode(ConfigHost& cfg, int partidas, int threads, int hz, double segundos) {
+    cfg.partidas = partidas;
+    cfg.threads = threads;
+    cfg.hz = hz;
+    printf("%d partidas de %d bots, %d ticks/s, mapa %dx%d\n", partidas, cfg.jogadores, hz,
+           gameMap.largura, gameMap.altura);
+    fflush(stdout);
+
+    // O host roda nesta thread; o relógio de --segundos, numa à parte
+    thread relogio;
+    if (segundos > 0) relogio = thread([segundos] {
+        double fim = nowSeconds() + segundos;
+        while (!parar && nowSeconds() < fim) sleepSeconds(0.05);
+        parar = true;
+    });
+    RelatorioHost r;
+    bool ok = runHost(cfg, parar, r);
+    if (relogio.joinable()) relogio.join();
+    if (!ok) return 1;
+
+    uint64_t ticks = r.ticks(), atrasados = r.atrasados(), reinicios = 0;
+    double atraso_max = 0, tick_max = 0;
+    for (size_t i = 0; i < r.partidas.size(); i++) {
+        reinicios += r.partidas[i].reinicios;
+        atraso_max = max(atraso_max, r.partidas[i].atraso_max);
+        tick_max = max(tick_max, r.partidas[i].tempo_tick_max);
+    }
+    printf("%llu rodadas em %.1f s, %d threads, %llu roubos, %llu partidas recomecadas\n",
+           (unsigned long long)r.rodadas, r.duracao, r.threads, (unsigned long long)r.roubos,
+           (unsigned long long)reinicios);
+    printf("tick medio %.3f ms, maximo %.3f ms; rodada maxima %.3f ms de %.3f ms\n",
+           ticks ? r.trabalho / ticks * 1e3 : 0.0, tick_max * 1e3, r.rodada_max * 1e3, 1e3 / hz);
+    printf("%llu de %llu ticks atrasados (%.2f%%), atraso maximo %.3f ms\n", (unsigned long long)atrasados,
+           (unsigned long long)ticks, ticks ? 100.0 * atrasados / ticks : 0.0, atraso_max * 1e3);
+    printf("%.0f partidas por nucleo a %d ticks/s\n", r.matchesPerCore(hz), hz);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    srand((unsigned int)time(0));
+    semente_partida = (uint64_t)time(0);
+
+    // --porta N (padrão 27015), --tick HZ (padrão 20), --max-clientes N (padrão 256)
+    // e as mesmas opções de partida do jogo: --mapa, --inimigos, --blocos,
+    // --paredes, --semente, --threads
+    // --partidas N: em vez do servidor, hospeda N partidas de bots (host.h) em
+    // --threads threads, por --segundos S (padrão: até Ctrl+C), com --jogadores
+    // bots cada
+    // --estatisticas ARQ.csv|ARQ.json: contadores por tick da partida do
+    // servidor (stats.h), escritos na saída e a cada SIGUSR1
+    ConfigServidor cfg;
+    ConfigHost host;
+    int largura = MAP_SIZE, altura = MAP_SIZE;
+    int threads = 0, partidas = 0;
+    double segundos = 0;
+    const char* estatisticas = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--porta") == 0 && i + 1 < argc) {
+            cfg.porta = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tick") == 0 && i + 1 < argc) {
+            cfg.hz = max(1, min(1000, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--max-clientes") == 0 && i + 1 < argc) {
+            cfg.max_clientes = max(1, min(65535, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--mapa") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &largura, &altura) != 2) {
+                printf("Tamanho de mapa invalido: %s (use LARGURAxALTURA)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--inimigos") == 0 && i + 1 < argc) {
+            num_inimigos = atoi(argv[++i]);
+            if (num_inimigos < 1) {
+                printf("Quantidade de inimigos invalida: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--blocos") == 0 && i + 1 < argc) {
+            densidade_blocos = max(0, min(100, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--paredes") == 0 && i + 1 < argc) {
+            densidade_paredes = max(0, min(100, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            unsigned int semente = (unsigned int)strtoul(argv[++i], 0, 10);
+            srand(semente);
+            semente_partida = semente;
+        } else if (strcmp(argv[i], "--partidas") == 0 && i + 1 < argc) {
+            partidas = max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--jogadores") == 0 && i + 1 < argc) {
+            host.jogadores = max(1, min(64, atoi(argv[++i])));
+        } else if (strcmp(argv[i], "--segundos") == 0 && i + 1 < argc) {
+            segundos = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc) {
+            estatisticas = argv[++i];
+        }
+    }
+    setMapSize(largura, altura);
+
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+
+    if (partidas > 0) {
+        // As partidas passam por várias threads; o registro é de uma thread só
+        if (estatisticas) printf("--estatisticas vale so para a partida do servidor, ignorado com --partidas\n");
+        return runHostMode(host, partidas, threads, cfg.hz, segundos);
+    }
+    if (threads > 0) setWorkerCount(threads);
+    // Uma hora a 20 ticks/s
+    if (estatisticas) startStats(72000, estatisticas);
+
+    printf("Servidor na porta %d, %d ticks/s, mapa %dx%d\n", cfg.porta, cfg.hz, gameMap.largura, gameMap.altura);
+    fflush(stdout);
+    EstatisticasServidor est;
+    if (!runServer(cfg, parar, &est)) return 1;
+
+    printf("%llu ticks, %llu estados enviados (%.1f MB), tick medio %.3f ms, maximo %.3f ms, ate %d clientes\n",
+           (unsigned long long)est.ticks, (unsigned long long)est.estados_enviados, est.bytes_enviados / 1e6,
+           est.ticks ? est.tempo_tick_total / est.ticks * 1e3 : 0.0, est.tempo_tick_max * 1e3, est.clientes_max);
+    return 0;
+}
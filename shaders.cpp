@@ -0,0 +1,113 @@
+/*
+ * Funções do GL 3.3 (ver shaders.h)
+ */
+#include "shaders.h"
+#include <cstdio>
+#include <vector>
+using namespace std;
+
+FuncoesGL33 gl33;
+
+void glVersion(int& maior, int& menor) {
+    maior = menor = 0;
+    const char* versao = (const char*)glGetString(GL_VERSION);
+    if (versao) sscanf(versao, "%d.%d", &maior, &menor);
+}
+
+bool coreProfile() {
+    int maior, menor;
+    glVersion(maior, menor);
+    if (maior < 3 || (maior == 3 && menor < 2)) return false;
+    GLint perfil = 0;
+    glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &perfil);
+    return (perfil & GL_CONTEXT_CORE_PROFILE_BIT) != 0;
+}
+
+template <class F>
+static bool loadFunction(F& funcao, CarregarFuncaoGL carregar, const char* nome) {
+    funcao = (F)carregar(nome);
+    return funcao != 0;
+}
+
+bool loadGL33(CarregarFuncaoGL carregar) {
+    int maior, menor;
+    glVersion(maior, menor);
+    if (!carregar || maior < 3 || (maior == 3 && menor < 3)) return false;
+
+    bool ok = true;
+    ok &= loadFunction(gl33.createShader, carregar, "glCreateShader");
+    ok &= loadFunction(gl33.shaderSource, carregar, "glShaderSource");
+    ok &= loadFunction(gl33.compileShader, carregar, "glCompileShader");
+    ok &= loadFunction(gl33.getShaderiv, carregar, "glGetShaderiv");
+    ok &= loadFunction(gl33.getShaderInfoLog, carregar, "glGetShaderInfoLog");
+    ok &= loadFunction(gl33.deleteShader, carregar, "glDeleteShader");
+    ok &= loadFunction(gl33.createProgram, carregar, "glCreateProgram");
+    ok &= loadFunction(gl33.attachShader, carregar, "glAttachShader");
+    ok &= loadFunction(gl33.linkProgram, carregar, "glLinkProgram");
+    ok &= loadFunction(gl33.getProgramiv, carregar, "glGetProgramiv");
+    ok &= loadFunction(gl33.getProgramInfoLog, carregar, "glGetProgramInfoLog");
+    ok &= loadFunction(gl33.useProgram, carregar, "glUseProgram");
+    ok &= loadFunction(gl33.getUniformLocation, carregar, "glGetUniformLocation");
+    ok &= loadFunction(gl33.uniform1i, carregar, "glUniform1i");
+    ok &= loadFunction(gl33.getUniformBlockIndex, carregar, "glGetUniformBlockIndex");
+    ok &= loadFunction(gl33.uniformBlockBinding, carregar, "glUniformBlockBinding");
+    ok &= loadFunction(gl33.genBuffers, carregar, "glGenBuffers");
+    ok &= loadFunction(gl33.deleteBuffers, carregar, "glDeleteBuffers");
+    ok &= loadFunction(gl33.bindBuffer, carregar, "glBindBuffer");
+    ok &= loadFunction(gl33.bufferData, carregar, "glBufferData");
+    ok &= loadFunction(gl33.bufferSubData, carregar, "glBufferSubData");
+    ok &= loadFunction(gl33.bindBufferBase, carregar, "glBindBufferBase");
+    ok &= loadFunction(gl33.genVertexArrays, carregar, "glGenVertexArrays");
+    ok &= loadFunction(gl33.bindVertexArray, carregar, "glBindVertexArray");
+    ok &= loadFunction(gl33.enableVertexAttribArray, carregar, "glEnableVertexAttribArray");
+    ok &= loadFunction(gl33.vertexAttribPointer, carregar, "glVertexAttribPointer");
+    ok &= loadFunction(gl33.vertexAttribDivisor, carregar, "glVertexAttribDivisor");
+    ok &= loadFunction(gl33.drawArraysInstanced, carregar, "glDrawArraysInstanced");
+    return ok;
+}
+
+static GLuint compileShader(const char* nome, GLenum tipo, const char* texto) {
+    GLuint shader = gl33.createShader(tipo);
+    gl33.shaderSource(shader, 1, &texto, 0);
+    gl33.compileShader(shader);
+    GLint ok = 0, tamanho = 0;
+    gl33.getShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        gl33.getShaderiv(shader, GL_INFO_LOG_LENGTH, &tamanho);
+        vector<char> log(tamanho > 0 ? tamanho : 1, '\0');
+        gl33.getShaderInfoLog(shader, (GLsizei)log.size(), 0, &log[0]);
+        printf("Erro no shader de %s (%s):\n%s\n", tipo == GL_VERTEX_SHADER ? "vertice" : "fragmento", nome,
+               &log[0]);
+        gl33.deleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildProgram(const char* nome, const char* vertice, const char* fragmento) {
+    GLuint vs = compileShader(nome, GL_VERTEX_SHADER, vertice);
+    GLuint fs = compileShader(nome, GL_FRAGMENT_SHADER, fragmento);
+    if (!vs || !fs) {
+        if (vs) gl33.deleteShader(vs);
+        if (fs) gl33.deleteShader(fs);
+        return 0;
+    }
+    GLuint programa = gl33.createProgram();
+    gl33.attachShader(programa, vs);
+    gl33.attachShader(programa, fs);
+    gl33.linkProgram(programa);
+    // Ligados ao programa, os shaders só somem junto com ele
+    gl33.deleteShader(vs);
+    gl33.deleteShader(fs);
+
+    GLint ok = 0, tamanho = 0;
+    gl33.getProgramiv(programa, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        gl33.getProgramiv(programa, GL_INFO_LOG_LENGTH, &tamanho);
+        vector<char> log(tamanho > 0 ? tamanho : 1, '\0');
+        gl33.getProgramInfoLog(programa, (GLsizei)log.size(), 0, &log[0]);
+        printf("Erro ao ligar o programa %s:\n%s\n", nome, &log[0]);
+        return 0;
+    }
+    return programa;
+}
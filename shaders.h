@@ -0,0 +1,122 @@
+/*
+ * Funções do GL 3.3 usadas pelo desenho com shaders de render.cpp: shaders e
+ * programas, buffers, vertex arrays, uniform buffers e desenho por instâncias
+ *
+ * O gl.h do GL 1.x não as declara: loadGL33() acha cada uma pelo nome com a
+ * função da janela/contexto (a mesma do TemposQuadro) e só dá certo se o
+ * contexto for 3.3 ou mais novo. Sem elas, render.cpp desenha pelo GL fixo.
+ */
+#ifndef SHADERS_H
+#define SHADERS_H
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+#ifdef __APPLE__
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl.h>
+#else
+    #include <GL/gl.h>
+#endif
+#include "timing.h"
+#include <cstddef>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_ELEMENT_ARRAY_BUFFER
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_DYNAMIC_DRAW
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_INFO_LOG_LENGTH
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+#ifndef GL_CONTEXT_PROFILE_MASK
+#define GL_CONTEXT_PROFILE_MASK 0x9126
+#endif
+#ifndef GL_CONTEXT_CORE_PROFILE_BIT
+#define GL_CONTEXT_CORE_PROFILE_BIT 0x00000001
+#endif
+
+struct FuncoesGL33 {
+    // Shaders e programas
+    GLuint (APIENTRY* createShader)(GLenum tipo);
+    void (APIENTRY* shaderSource)(GLuint shader, GLsizei n, const char* const* textos, const GLint* tamanhos);
+    void (APIENTRY* compileShader)(GLuint shader);
+    void (APIENTRY* getShaderiv)(GLuint shader, GLenum nome, GLint* valor);
+    void (APIENTRY* getShaderInfoLog)(GLuint shader, GLsizei tamanho, GLsizei* escrito, char* log);
+    void (APIENTRY* deleteShader)(GLuint shader);
+    GLuint (APIENTRY* createProgram)();
+    void (APIENTRY* attachShader)(GLuint programa, GLuint shader);
+    void (APIENTRY* linkProgram)(GLuint programa);
+    void (APIENTRY* getProgramiv)(GLuint programa, GLenum nome, GLint* valor);
+    void (APIENTRY* getProgramInfoLog)(GLuint programa, GLsizei tamanho, GLsizei* escrito, char* log);
+    void (APIENTRY* useProgram)(GLuint programa);
+    GLint (APIENTRY* getUniformLocation)(GLuint programa, const char* nome);
+    void (APIENTRY* uniform1i)(GLint local, GLint valor);
+    GLuint (APIENTRY* getUniformBlockIndex)(GLuint programa, const char* nome);
+    void (APIENTRY* uniformBlockBinding)(GLuint programa, GLuint bloco, GLuint ponto);
+
+    // Buffers
+    void (APIENTRY* genBuffers)(GLsizei n, GLuint* buffers);
+    void (APIENTRY* deleteBuffers)(GLsizei n, const GLuint* buffers);
+    void (APIENTRY* bindBuffer)(GLenum alvo, GLuint buffer);
+    void (APIENTRY* bufferData)(GLenum alvo, ptrdiff_t bytes, const void* dados, GLenum uso);
+    void (APIENTRY* bufferSubData)(GLenum alvo, ptrdiff_t inicio, ptrdiff_t bytes, const void* dados);
+    void (APIENTRY* bindBufferBase)(GLenum alvo, GLuint ponto, GLuint buffer);
+
+    // Vertex arrays e instâncias
+    void (APIENTRY* genVertexArrays)(GLsizei n, GLuint* arrays);
+    void (APIENTRY* bindVertexArray)(GLuint array);
+    void (APIENTRY* enableVertexAttribArray)(GLuint atributo);
+    void (APIENTRY* vertexAttribPointer)(GLuint atributo, GLint n, GLenum tipo, GLboolean normalizar,
+                                         GLsizei passo, const void* inicio);
+    void (APIENTRY* vertexAttribDivisor)(GLuint atributo, GLuint divisor);
+    void (APIENTRY* drawArraysInstanced)(GLenum modo, GLint primeiro, GLsizei n, GLsizei instancias);
+};
+
+extern FuncoesGL33 gl33;
+
+// Versão do contexto atual (glGetString(GL_VERSION)); 0.0 se não houver
+void glVersion(int& maior, int& menor);
+
+// Contexto só com o perfil core (3.2 ou mais novo): sem GL fixo
+bool coreProfile();
+
+// Carrega gl33 com 'carregar'; false se o contexto for anterior ao 3.3 ou se
+// faltar alguma função
+bool loadGL33(CarregarFuncaoGL carregar);
+
+// Compila e liga um programa; 0 (com o log do compilador na saída) se falhar
+GLuint buildProgram(const char* nome, const char* vertice, const char* fragmento);
+
+#endif
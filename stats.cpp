@@ -0,0 +1,155 @@
+/*
+ * Registro dos contadores por tick (ver stats.h)
+ */
+#include "stats.h"
+#include "game.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace std;
+
+thread_local ContadoresTick contadores_tick;
+thread_local bool registrando_ticks = false;
+
+namespace {
+
+struct Historico {
+    vector<RegistroTick> registros;
+    size_t pos, n;
+    uint64_t inicio;
+    string caminho;
+};
+
+// Ponteiro (sem destrutor): continua válido nas funções de atexit()
+thread_local Historico* historico = 0;
+
+volatile sig_atomic_t escrita_pedida = 0;
+bool saida_registrada = false;
+
+void requestWrite(int) { escrita_pedida = 1; }
+
+void writeAtExit() {
+    if (historico && !historico->caminho.empty()) writeStats(historico->caminho.c_str());
+}
+
+bool endsWith(const char* s, const char* fim) {
+    size_t n = strlen(s), m = strlen(fim);
+    return n >= m && strcmp(s + n - m, fim) == 0;
+}
+
+}
+
+uint64_t statsNs() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool startStats(size_t capacidade, const char* caminho) {
+    stopStats();
+    if (capacidade == 0) return false;
+    historico = new Historico();
+    historico->registros.resize(capacidade);
+    historico->pos = historico->n = 0;
+    historico->inicio = statsNs();
+    if (caminho) {
+        historico->caminho = caminho;
+        if (!saida_registrada) {
+            atexit(writeAtExit);
+            saida_registrada = true;
+        }
+#ifdef SIGUSR1
+        signal(SIGUSR1, requestWrite);
+#endif
+    }
+    memset(&contadores_tick, 0, sizeof(contadores_tick));
+    registrando_ticks = true;
+    return true;
+}
+
+void stopStats() {
+    delete historico;
+    historico = 0;
+    registrando_ticks = false;
+}
+
+void recordTick() {
+    if (!registrando_ticks) return;
+    Historico& h = *historico;
+    RegistroTick& r = h.registros[h.pos];
+    r.instante = (statsNs() - h.inicio) * 1e-9;
+    r.partida = currentMatch();
+    r.tick = tick_atual;
+    r.inimigos = (uint32_t)inimigos.size();
+    r.bombas = (uint32_t)bombas.size();
+    r.c = contadores_tick;
+    memset(&contadores_tick, 0, sizeof(contadores_tick));
+    h.pos = h.pos + 1 == h.registros.size() ? 0 : h.pos + 1;
+    if (h.n < h.registros.size()) h.n++;
+
+    if (escrita_pedida && !h.caminho.empty()) {
+        escrita_pedida = 0;
+        writeStats(h.caminho.c_str());
+    }
+}
+
+size_t statsCount() {
+    return historico ? historico->n : 0;
+}
+
+const RegistroTick& statsRecord(size_t i) {
+    const Historico& h = *historico;
+    size_t inicio = h.n < h.registros.size() ? 0 : h.pos;
+    return h.registros[(inicio + i) % h.registros.size()];
+}
+
+bool writeStats(const char* caminho) {
+    FILE* f = fopen(caminho, "w");
+    if (!f) {
+        fprintf(stderr, "Nao foi possivel escrever %s\n", caminho);
+        return false;
+    }
+    bool json = endsWith(caminho, ".json");
+    size_t n = statsCount();
+    if (json) fprintf(f, "[\n");
+    else
+        fprintf(f, "instante,partida,tick,inimigos,bombas,chamadas_hasbomb,movimentos_tentados,movimentos_feitos,"
+                   "bombas_plantadas,bombas_detonadas,bombas_encadeadas,celulas_destruidas,ns_inimigos,ns_explosoes,"
+                   "quadros,desenhos_gl,vertices_gl,texturas_gl,estados_gl,matrizes_gl\n");
+    for (size_t i = 0; i < n; i++) {
+        const RegistroTick& r = statsRecord(i);
+        const ContadoresTick& c = r.c;
+        if (json)
+            fprintf(f,
+                    "{\"instante\":%.6f,\"partida\":%u,\"tick\":%d,\"inimigos\":%u,\"bombas\":%u,"
+                    "\"chamadas_hasbomb\":%u,\"movimentos_tentados\":%u,\"movimentos_feitos\":%u,"
+                    "\"bombas_plantadas\":%u,\"bombas_detonadas\":%u,\"bombas_encadeadas\":%u,"
+                    "\"celulas_destruidas\":%u,\"ns_inimigos\":%u,\"ns_explosoes\":%u,\"quadros\":%u,"
+                    "\"desenhos_gl\":%u,\"vertices_gl\":%u,\"texturas_gl\":%u,\"estados_gl\":%u,"
+                    "\"matrizes_gl\":%u}%s\n",
+                    r.instante, r.partida, r.tick, r.inimigos, r.bombas, c.chamadas_hasbomb, c.movimentos_tentados,
+                    c.movimentos_feitos, c.bombas_plantadas, c.bombas_detonadas, c.bombas_encadeadas,
+                    c.celulas_destruidas, c.ns_inimigos, c.ns_explosoes, c.quadros, c.desenhos_gl, c.vertices_gl,
+                    c.texturas_gl, c.estados_gl, c.matrizes_gl, i + 1 < n ? "," : "");
+        else
+            fprintf(f, "%.6f,%u,%d,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", r.instante, r.partida, r.tick, r.inimigos,
+                    r.bombas, c.chamadas_hasbomb, c.movimentos_tentados, c.movimentos_feitos, c.bombas_plantadas,
+                    c.bombas_detonadas, c.bombas_encadeadas, c.celulas_destruidas, c.ns_inimigos, c.ns_explosoes,
+                    c.quadros, c.desenhos_gl, c.vertices_gl, c.texturas_gl, c.estados_gl, c.matrizes_gl);
+    }
+    if (json) fprintf(f, "]\n");
+    fclose(f);
+    return true;
+}
+
+PausaEstatisticas::PausaEstatisticas() : salvos(contadores_tick), registrando(registrando_ticks) {
+    registrando_ticks = false;
+}
+
+PausaEstatisticas::~PausaEstatisticas() {
+    contadores_tick = salvos;
+    registrando_ticks = registrando;
+}
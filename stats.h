@@ -0,0 +1,72 @@
+/*
+ * Contadores da simulação por tick (sem OpenGL)
+ *
+ * As regras somam em contadores_tick o que acontece em cada tick: chamadas de
+ * hasBomb(), movimentos de inimigos tentados e feitos, bombas plantadas,
+ * detonadas e encadeadas, blocos destruídos e o tempo de moveEnemies() e das
+ * explosões (updateBombs()); com tela, também os quadros desenhados no tick e
+ * as chamadas ao GL deles. Com o registro ligado na thread (startStats()),
+ * stepGame() guarda cada tick num buffer circular, escrito em CSV ou JSON na
+ * saída do processo e a cada SIGUSR1, para cruzar travadas de quadro com o que
+ * acontecia na partida.
+ *
+ * Os contadores não entram no estado da partida (nem em snapshot() ou
+ * stateChecksum()) e não mudam as regras.
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstddef>
+#include <stdint.h>
+
+struct ContadoresTick {
+    uint32_t chamadas_hasbomb;
+    uint32_t movimentos_tentados, movimentos_feitos;
+    uint32_t bombas_plantadas, bombas_detonadas;
+    uint32_t bombas_encadeadas;  // detonadas por outra antes do próprio timer
+    uint32_t celulas_destruidas;
+    uint32_t ns_inimigos, ns_explosoes;
+    // Somas dos quadros desenhados durante o tick (renderScene(), só com tela):
+    // chamadas ao GL como em ContadoresGL (render.h)
+    uint32_t quadros;
+    uint32_t desenhos_gl, vertices_gl, texturas_gl, estados_gl, matrizes_gl;
+};
+
+struct RegistroTick {
+    double instante;   // segundos desde startStats()
+    uint32_t partida;  // currentMatch()
+    int tick;
+    uint32_t inimigos, bombas; // vivos / no mapa ao fim do tick
+    ContadoresTick c;
+};
+
+// Do tick em andamento, na thread atual (zerados por recordTick())
+extern thread_local ContadoresTick contadores_tick;
+// Registro ligado na thread atual: só então os tempos são medidos
+extern thread_local bool registrando_ticks;
+
+uint64_t statsNs(); // relógio monotônico dos tempos, em ns
+
+// Liga o registro na thread atual com os últimos 'capacidade' ticks. Com
+// 'caminho', o registro é escrito lá (.json = JSON, senão CSV) na saída do
+// processo e a cada SIGUSR1 (onde houver). false se a capacidade for 0.
+bool startStats(size_t capacidade, const char* caminho = 0);
+void stopStats();
+void recordTick();   // fim do tick: guarda os contadores e os zera (stepGame())
+size_t statsCount(); // ticks no registro da thread
+const RegistroTick& statsRecord(size_t i); // i = 0 o mais antigo
+bool writeStats(const char* caminho);
+
+// Enquanto existir, ticks simulados na thread não entram no registro nem
+// mexem nos contadores do tick real (buscas que simulam o futuro, por exemplo)
+class PausaEstatisticas {
+public:
+    PausaEstatisticas();
+    ~PausaEstatisticas();
+
+private:
+    ContadoresTick salvos;
+    bool registrando;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Tempos das fases do quadro (ver timing.h)
+ */
+#include "timing.h"
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+#ifdef __APPLE__
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl.h>
+#else
+    #include <GL/gl.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+const char* const NOMES_FASES[NUM_FASES] = { "mapa", "jogadores", "inimigos", "bombas", "explosoes" };
+
+// Funções das consultas, carregadas em init() (o gl.h do GL 1.x não as tem)
+typedef void (APIENTRY* FnGenQueries)(GLsizei, GLuint*);
+typedef void (APIENTRY* FnBeginQuery)(GLenum, GLuint);
+typedef void (APIENTRY* FnEndQuery)(GLenum);
+typedef void (APIENTRY* FnGetQueryObjectiv)(GLuint, GLenum, GLint*);
+typedef void (APIENTRY* FnGetQueryObjectui64v)(GLuint, GLenum, uint64_t*);
+
+static FnGenQueries gen_queries = 0;
+static FnBeginQuery begin_query = 0;
+static FnEndQuery end_query = 0;
+static FnGetQueryObjectiv get_query_iv = 0;
+static FnGetQueryObjectui64v get_query_ui64v = 0;
+
+// Peso de cada quadro novo nas médias mostradas
+static const double SUAVIZACAO = 0.1;
+
+static double nowSecondsTiming() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool hasExtension(const char* nome) {
+    const char* lista = (const char*)glGetString(GL_EXTENSIONS);
+    if (!lista) return false;
+    size_t n = strlen(nome);
+    for (const char* p = strstr(lista, nome); p; p = strstr(p + n, nome))
+        if ((p == lista || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) return true;
+    return false;
+}
+
+TemposQuadro::TemposQuadro()
+    : gpu(false), ligado(false), medindo(false), atual(0), inicio_quadro(0), inicio_fase(0),
+      n_historico(0), pos_historico(0), p50_ms(0), p99_ms(0) {
+    pendente[0] = pendente[1] = false;
+    for (int f = 0; f < NUM_FASES; f++) {
+        cpu_fase[f] = cpu_ms[f] = 0;
+        gpu_ms[f] = -1;
+    }
+}
+
+bool TemposQuadro::init(CarregarFuncaoGL procAddress) {
+    if (!procAddress) return false;
+    int maior = 0, menor = 0;
+    const char* versao = (const char*)glGetString(GL_VERSION);
+    if (versao) sscanf(versao, "%d.%d", &maior, &menor);
+    bool core = maior > 3 || (maior == 3 && menor >= 3);
+    bool arb = core || hasExtension("GL_ARB_timer_query");
+    if (!arb && !hasExtension("GL_EXT_timer_query")) return false;
+
+    gen_queries = (FnGenQueries)procAddress("glGenQueries");
+    begin_query = (FnBeginQuery)procAddress("glBeginQuery");
+    end_query = (FnEndQuery)procAddress("glEndQuery");
+    get_query_iv = (FnGetQueryObjectiv)procAddress("glGetQueryObjectiv");
+    get_query_ui64v = (FnGetQueryObjectui64v)procAddress(arb ? "glGetQueryObjectui64v" : "glGetQueryObjectui64vEXT");
+    if (!gen_queries || !begin_query || !end_query || !get_query_iv || !get_query_ui64v) return false;
+
+    gen_queries(2 * NUM_FASES, &consultas[0][0]);
+    gpu = true;
+    return true;
+}
+
+void TemposQuadro::setEnabled(bool sim) {
+    if (sim && !ligado) {
+        n_historico = pos_historico = 0;
+        p50_ms = p99_ms = 0;
+        for (int f = 0; f < NUM_FASES; f++) {
+            cpu_ms[f] = 0;
+            gpu_ms[f] = -1;
+        }
+    }
+    ligado = sim;
+}
+
+bool TemposQuadro::collect(int conjunto) {
+    // Todas prontas ou nenhuma lida: as médias não misturam quadros
+    for (int f = 0; f < NUM_FASES; f++) {
+        GLint pronta = 0;
+        get_query_iv(consultas[conjunto][f], GL_QUERY_RESULT_AVAILABLE, &pronta);
+        if (!pronta) return false;
+    }
+    for (int f = 0; f < NUM_FASES; f++) {
+        uint64_t ns = 0;
+        get_query_ui64v(consultas[conjunto][f], GL_QUERY_RESULT, &ns);
+        double ms = ns * 1e-6;
+        gpu_ms[f] = gpu_ms[f] < 0 ? ms : gpu_ms[f] + SUAVIZACAO * (ms - gpu_ms[f]);
+    }
+    pendente[conjunto] = false;
+    return true;
+}
+
+void TemposQuadro::beginFrame() {
+    if (!ligado) return;
+    inicio_quadro = nowSecondsTiming();
+    atual ^= 1;
+    medindo = gpu && (!pendente[atual] || collect(atual));
+    for (int f = 0; f < NUM_FASES; f++) cpu_fase[f] = 0;
+}
+
+void TemposQuadro::beginPhase(int fase) {
+    if (!ligado) return;
+    if (medindo) begin_query(GL_TIME_ELAPSED, consultas[atual][fase]);
+    inicio_fase = nowSecondsTiming();
+}
+
+void TemposQuadro::endPhase(int fase) {
+    if (!ligado) return;
+    cpu_fase[fase] += nowSecondsTiming() - inicio_fase;
+    if (medindo) end_query(GL_TIME_ELAPSED);
+}
+
+void TemposQuadro::endFrame() {
+    if (!ligado) return;
+    double quadro_ms = (nowSecondsTiming() - inicio_quadro) * 1e3;
+    for (int f = 0; f < NUM_FASES; f++) {
+        double ms = cpu_fase[f] * 1e3;
+        cpu_ms[f] = n_historico == 0 ? ms : cpu_ms[f] + SUAVIZACAO * (ms - cpu_ms[f]);
+    }
+    if (medindo) pendente[atual] = true;
+    if (gpu && pendente[atual ^ 1]) collect(atual ^ 1);
+
+    historico[pos_historico] = quadro_ms;
+    pos_historico = (pos_historico + 1) % HISTORICO_QUADROS;
+    if (n_historico < HISTORICO_QUADROS) n_historico++;
+
+    copy(historico, historico + n_historico, ordenados);
+    int i50 = n_historico / 2, i99 = min(n_historico - 1, n_historico * 99 / 100);
+    nth_element(ordenados, ordenados + i50, ordenados + n_historico);
+    p50_ms = ordenados[i50];
+    nth_element(ordenados, ordenados + i99, ordenados + n_historico);
+    p99_ms = ordenados[i99];
+}
+
+double TemposQuadro::historyMs(int i) const {
+    int inicio = n_historico < HISTORICO_QUADROS ? 0 : pos_historico;
+    return historico[(inicio + i) % HISTORICO_QUADROS];
+}
@@ -0,0 +1,77 @@
+/*
+ * Tempo de CPU e de GPU de cada fase do desenho de um quadro (overlay da tecla 'p')
+ *
+ * A GPU é medida com consultas de tempo (GL_TIME_ELAPSED, do GL 3.3 ou das
+ * extensões ARB/EXT_timer_query) quando o driver tem; sem elas, só a CPU. O
+ * resultado de uma consulta só fica pronto alguns quadros depois, então há dois
+ * conjuntos de consultas: o quadro mede num e lê o do quadro anterior só se já
+ * estiver pronto. Se o conjunto da vez ainda não foi lido, o quadro fica sem
+ * medida de GPU em vez de esperar por ela: a CPU nunca para pela GPU.
+ */
+#ifndef TIMING_H
+#define TIMING_H
+
+enum FaseQuadro {
+    FASE_MAPA,
+    FASE_JOGADORES,
+    FASE_INIMIGOS,
+    FASE_BOMBAS,
+    FASE_EXPLOSOES,
+    NUM_FASES
+};
+
+extern const char* const NOMES_FASES[NUM_FASES];
+
+// Quadros no gráfico e nos percentis (4 s a 60 quadros por segundo)
+const int HISTORICO_QUADROS = 240;
+
+// glutGetProcAddress(), eglGetProcAddress()...
+typedef void* (*CarregarFuncaoGL)(const char* nome);
+
+class TemposQuadro {
+public:
+    TemposQuadro();
+
+    // Depois de criar o contexto GL, com a função da janela/contexto que acha as
+    // funções do GL pelo nome; false se não houver consultas de tempo
+    bool init(CarregarFuncaoGL procAddress);
+    bool hasGpu() const { return gpu; }
+
+    // Desligado, as chamadas abaixo não fazem nada; ligar zera o histórico
+    void setEnabled(bool sim);
+    bool enabled() const { return ligado; }
+
+    void beginFrame();
+    void beginPhase(int fase);
+    void endPhase(int fase);
+    void endFrame();
+
+    // Médias suavizadas em ms; gpuMs() < 0 enquanto não houver medida
+    double cpuMs(int fase) const { return cpu_ms[fase]; }
+    double gpuMs(int fase) const { return gpu_ms[fase]; }
+
+    // Tempo de CPU dos últimos quadros inteiros (ms), i = 0 o mais antigo
+    int historySize() const { return n_historico; }
+    double historyMs(int i) const;
+    double p50Ms() const { return p50_ms; }
+    double p99Ms() const { return p99_ms; }
+
+private:
+    bool collect(int conjunto); // lê as consultas do conjunto, se prontas
+
+    bool gpu, ligado, medindo;
+    unsigned int consultas[2][NUM_FASES];
+    bool pendente[2];
+    int atual;
+
+    double inicio_quadro, inicio_fase;
+    double cpu_fase[NUM_FASES];
+    double cpu_ms[NUM_FASES], gpu_ms[NUM_FASES];
+
+    double historico[HISTORICO_QUADROS];
+    double ordenados[HISTORICO_QUADROS];
+    int n_historico, pos_historico;
+    double p50_ms, p99_ms;
+};
+
+#endif